@@ -0,0 +1,544 @@
+/* GStreamer
+ * Copyright (C) 2025 FIXME <fixme@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Suite 500,
+ * Boston, MA 02110-1335, USA.
+ */
+/* rga-bench runs rgavideoconvert over a matrix of formats, sizes, cores
+ * and input memory types and prints fps, latency percentiles and CPU time
+ * per frame as CSV or JSON:
+ *
+ *   rga-bench --in-formats=NV12 --out-formats=all --cores=rga3_core0
+ *
+ * The input comes from a few preallocated buffers, either dmabufs from a
+ * dma-heap or plain system memory that RGA reaches through a CPU mapping.
+ * The output always uses the dmabuf pool of the element. The latency is
+ * measured around the element, which runs synchronously. */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"  // NOLINT
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <gst/allocators/gstdmabuf.h>
+#include <gst/app/gstappsrc.h>
+#include <gst/gst.h>
+#include <gst/video/video.h>
+#include <linux/dma-heap.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+/* input buffers cycled through */
+#define BENCH_N_BUFFERS 4
+
+/* dma-heap tried when --dma-heap does not exist */
+#define BENCH_FALLBACK_HEAP "system"
+
+static gchar *opt_in_formats = "NV12,RGBA,BGR";
+static gchar *opt_out_formats = "NV12,RGBA,BGR";
+static gchar *opt_in_sizes = "1920x1080,3840x2160";
+static gchar *opt_out_sizes = "640x480,1280x720,1920x1080";
+static gchar *opt_cores = "all";
+static gchar *opt_memory = "dmabuf,virtual";
+static gchar *opt_dma_heap = "system-uncached";
+static gchar *opt_output = "csv";
+static gint opt_frames = 300;
+static gint opt_warmup = 30;
+static gint opt_batch_window = 0;
+
+static GOptionEntry entries[] = {
+    {"in-formats", 0, 0, G_OPTION_ARG_STRING, &opt_in_formats,
+     "Input formats, or all for the sink template", "LIST"},
+    {"out-formats", 0, 0, G_OPTION_ARG_STRING, &opt_out_formats,
+     "Output formats, or all for the src template", "LIST"},
+    {"in-sizes", 0, 0, G_OPTION_ARG_STRING, &opt_in_sizes, "Input sizes",
+     "WxH,..."},
+    {"out-sizes", 0, 0, G_OPTION_ARG_STRING, &opt_out_sizes, "Output sizes",
+     "WxH,..."},
+    {"cores", 0, 0, G_OPTION_ARG_STRING, &opt_cores,
+     "core-mask values, or all for every GstRgaCoreMask value", "LIST"},
+    {"memory", 0, 0, G_OPTION_ARG_STRING, &opt_memory,
+     "Input memory types: dmabuf, virtual", "LIST"},
+    {"dma-heap", 0, 0, G_OPTION_ARG_STRING, &opt_dma_heap,
+     "dma-heap for dmabuf input", "NAME"},
+    {"frames", 'n', 0, G_OPTION_ARG_INT, &opt_frames,
+     "Frames measured per case", "N"},
+    {"warmup", 0, 0, G_OPTION_ARG_INT, &opt_warmup,
+     "Frames converted before measuring", "N"},
+    {"batch-window", 0, 0, G_OPTION_ARG_INT, &opt_batch_window,
+     "batch-window of the element in microseconds", "US"},
+    {"output", 'o', 0, G_OPTION_ARG_STRING, &opt_output,
+     "Report format: csv or json", "FORMAT"},
+    {NULL}};
+
+typedef struct {
+  const gchar *in_format;
+  const gchar *out_format;
+  gint in_width, in_height;
+  gint out_width, out_height;
+  const gchar *core;
+  const gchar *memory;
+} BenchCase;
+
+typedef struct {
+  gchar *error;
+  guint frames;
+  gdouble fps;
+  GstClockTime mean, p50, p90, p99, max;
+  gdouble cpu_ms;
+  guint64 fallbacks;
+} BenchResult;
+
+/* shared with the streaming thread */
+typedef struct {
+  GMutex lock;
+  guint warmup;
+  guint seen;
+  GstClockTime entered;
+  GstClockTime start, end;
+  struct rusage start_usage, end_usage;
+  GArray *latencies;
+} BenchRun;
+
+static GstPadProbeReturn bench_sink_probe(GstPad *pad, GstPadProbeInfo *info,
+                                          gpointer user_data) {
+  BenchRun *run = user_data;
+
+  g_mutex_lock(&run->lock);
+  run->entered = gst_util_get_timestamp();
+  g_mutex_unlock(&run->lock);
+  return GST_PAD_PROBE_OK;
+}
+
+static GstPadProbeReturn bench_src_probe(GstPad *pad, GstPadProbeInfo *info,
+                                         gpointer user_data) {
+  BenchRun *run = user_data;
+  GstClockTime now = gst_util_get_timestamp();
+
+  g_mutex_lock(&run->lock);
+  if (++run->seen == run->warmup) {
+    run->start = now;
+    getrusage(RUSAGE_SELF, &run->start_usage);
+  } else if (run->seen > run->warmup) {
+    GstClockTime latency = now - run->entered;
+
+    g_array_append_val(run->latencies, latency);
+    run->end = now;
+    getrusage(RUSAGE_SELF, &run->end_usage);
+  }
+  g_mutex_unlock(&run->lock);
+  return GST_PAD_PROBE_OK;
+}
+
+static gint bench_compare(gconstpointer a, gconstpointer b) {
+  GstClockTime x = *(const GstClockTime *)a, y = *(const GstClockTime *)b;
+
+  return x < y ? -1 : x > y;
+}
+
+static gdouble bench_cpu_ms(const struct rusage *start,
+                            const struct rusage *end) {
+  gdouble s = (end->ru_utime.tv_sec - start->ru_utime.tv_sec) +
+              (end->ru_stime.tv_sec - start->ru_stime.tv_sec);
+  gdouble us = (end->ru_utime.tv_usec - start->ru_utime.tv_usec) +
+               (end->ru_stime.tv_usec - start->ru_stime.tv_usec);
+
+  return s * 1e3 + us / 1e3;
+}
+
+static void bench_summarize(BenchRun *run, BenchResult *result) {
+  GArray *l = run->latencies;
+
+  result->frames = l->len;
+  if (!l->len) return;
+
+  g_array_sort(l, bench_compare);
+  GstClockTime sum = 0;
+  for (guint i = 0; i < l->len; i++) sum += g_array_index(l, GstClockTime, i);
+
+  result->mean = sum / l->len;
+  result->p50 = g_array_index(l, GstClockTime, (l->len - 1) * 50 / 100);
+  result->p90 = g_array_index(l, GstClockTime, (l->len - 1) * 90 / 100);
+  result->p99 = g_array_index(l, GstClockTime, (l->len - 1) * 99 / 100);
+  result->max = g_array_index(l, GstClockTime, l->len - 1);
+  if (l->len > 1 && run->end > run->start)
+    result->fps = (l->len - 1) * (gdouble)GST_SECOND / (run->end - run->start);
+  result->cpu_ms = bench_cpu_ms(&run->start_usage, &run->end_usage) / l->len;
+}
+
+/* Opens /dev/dma_heap/@heap, -1 if it does not exist */
+static gint bench_open_heap(const gchar *heap) {
+  gchar *path = g_strconcat("/dev/dma_heap/", heap, NULL);
+  gint fd = open(path, O_RDWR | O_CLOEXEC);
+
+  if (fd < 0) g_printerr("cannot open %s: %s\n", path, g_strerror(errno));
+  g_free(path);
+  return fd;
+}
+
+/* A buffer of one dmabuf of @size bytes from the heap behind @heap_fd */
+static GstBuffer *bench_alloc_dmabuf(GstAllocator *allocator, gint heap_fd,
+                                     gsize size) {
+  struct dma_heap_allocation_data data = {
+      0,
+  };
+  data.len = size;
+  data.fd_flags = O_RDWR | O_CLOEXEC;
+
+  if (ioctl(heap_fd, DMA_HEAP_IOCTL_ALLOC, &data) < 0) return NULL;
+
+  GstMemory *mem = gst_dmabuf_allocator_alloc(allocator, data.fd, size);
+  if (!mem) {
+    close(data.fd);
+    return NULL;
+  }
+
+  GstBuffer *buffer = gst_buffer_new();
+  gst_buffer_append_memory(buffer, mem);
+  return buffer;
+}
+
+/* Allocates the input frames, filled with mid grey */
+static gboolean bench_alloc_inputs(const BenchCase *bc, GstVideoInfo *info,
+                                   GstBuffer **buffers) {
+  GstAllocator *allocator = NULL;
+  gint heap_fd = -1;
+  gboolean ret = TRUE;
+
+  if (!g_strcmp0(bc->memory, "dmabuf")) {
+    heap_fd = bench_open_heap(opt_dma_heap);
+    if (heap_fd < 0) heap_fd = bench_open_heap(BENCH_FALLBACK_HEAP);
+    if (heap_fd < 0) return FALSE;
+    allocator = gst_dmabuf_allocator_new();
+  } else if (g_strcmp0(bc->memory, "virtual")) {
+    return FALSE;
+  }
+
+  for (guint i = 0; i < BENCH_N_BUFFERS; i++) {
+    GstMapInfo map;
+
+    buffers[i] = allocator
+                     ? bench_alloc_dmabuf(allocator, heap_fd, info->size)
+                     : gst_buffer_new_allocate(NULL, info->size, NULL);
+    if (!buffers[i] || !gst_buffer_map(buffers[i], &map, GST_MAP_WRITE)) {
+      ret = FALSE;
+      break;
+    }
+    memset(map.data, 0x80, map.size);
+    gst_buffer_unmap(buffers[i], &map);
+  }
+
+  if (allocator) gst_object_unref(allocator);
+  if (heap_fd >= 0) close(heap_fd);
+  return ret;
+}
+
+/* Stops at EOS or on the first error */
+static gchar *bench_wait(GstElement *pipeline, GstClockTime timeout) {
+  GstBus *bus = gst_element_get_bus(pipeline);
+  GstMessage *msg = gst_bus_timed_pop_filtered(
+      bus, timeout, GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  gchar *error = NULL;
+
+  if (!msg) {
+    error = g_strdup("timeout");
+  } else if (GST_MESSAGE_TYPE(msg) == GST_MESSAGE_ERROR) {
+    GError *err = NULL;
+
+    gst_message_parse_error(msg, &err, NULL);
+    error = g_strdup(err->message);
+    g_error_free(err);
+  }
+  if (msg) gst_message_unref(msg);
+  gst_object_unref(bus);
+  return error;
+}
+
+static void bench_run_pipeline(const BenchCase *bc, GstBuffer **buffers,
+                               BenchResult *result) {
+  BenchRun run = {
+      0,
+  };
+  GError *err = NULL;
+
+  gchar *desc = g_strdup_printf(
+      "appsrc name=src block=true caps=video/x-raw,format=%s,width=%d,"
+      "height=%d,framerate=0/1 ! rgavideoconvert name=conv core-mask=%s "
+      "batch-window=%d ! video/x-raw,format=%s,width=%d,height=%d ! "
+      "fakesink sync=false async=false",
+      bc->in_format, bc->in_width, bc->in_height, bc->core, opt_batch_window,
+      bc->out_format, bc->out_width, bc->out_height);
+  GstElement *pipeline = gst_parse_launch(desc, &err);
+  g_free(desc);
+  if (!pipeline) {
+    result->error = g_strdup(err ? err->message : "cannot build pipeline");
+    g_clear_error(&err);
+    return;
+  }
+
+  GstElement *src = gst_bin_get_by_name(GST_BIN(pipeline), "src");
+  GstElement *conv = gst_bin_get_by_name(GST_BIN(pipeline), "conv");
+  GstPad *sinkpad = gst_element_get_static_pad(conv, "sink");
+  GstPad *srcpad = gst_element_get_static_pad(conv, "src");
+
+  g_mutex_init(&run.lock);
+  run.warmup = MAX(opt_warmup, 1);
+  run.latencies = g_array_new(FALSE, FALSE, sizeof(GstClockTime));
+  gst_pad_add_probe(sinkpad, GST_PAD_PROBE_TYPE_BUFFER, bench_sink_probe,
+                    &run, NULL);
+  gst_pad_add_probe(srcpad, GST_PAD_PROBE_TYPE_BUFFER, bench_src_probe, &run,
+                    NULL);
+
+  gst_element_set_state(pipeline, GST_STATE_PLAYING);
+  for (gint i = 0; i < (gint)run.warmup + opt_frames; i++) {
+    /* the frames are only read, so the same buffers are pushed again */
+    GstBuffer *buffer = gst_buffer_ref(buffers[i % BENCH_N_BUFFERS]);
+
+    if (gst_app_src_push_buffer(GST_APP_SRC(src), buffer) != GST_FLOW_OK)
+      break;
+  }
+  gst_app_src_end_of_stream(GST_APP_SRC(src));
+  result->error = bench_wait(pipeline, 60 * GST_SECOND);
+
+  GstStructure *stats = NULL;
+  g_object_get(conv, "stats", &stats, NULL);
+  if (stats) {
+    gst_structure_get_uint64(stats, "fallback-frames", &result->fallbacks);
+    gst_structure_free(stats);
+  }
+
+  gst_element_set_state(pipeline, GST_STATE_NULL);
+  bench_summarize(&run, result);
+
+  g_array_unref(run.latencies);
+  g_mutex_clear(&run.lock);
+  gst_object_unref(sinkpad);
+  gst_object_unref(srcpad);
+  gst_object_unref(conv);
+  gst_object_unref(src);
+  gst_object_unref(pipeline);
+}
+
+static void bench_run_case(const BenchCase *bc, BenchResult *result) {
+  GstBuffer *buffers[BENCH_N_BUFFERS] = {NULL};
+  GstVideoInfo info;
+
+  memset(result, 0, sizeof(*result));
+  GstVideoFormat format = gst_video_format_from_string(bc->in_format);
+  if (format == GST_VIDEO_FORMAT_UNKNOWN) {
+    result->error = g_strdup("unknown input format");
+    return;
+  }
+
+  gst_video_info_set_format(&info, format, bc->in_width, bc->in_height);
+  if (bench_alloc_inputs(bc, &info, buffers))
+    bench_run_pipeline(bc, buffers, result);
+  else
+    result->error = g_strdup("cannot allocate input buffers");
+
+  for (guint i = 0; i < BENCH_N_BUFFERS; i++)
+    if (buffers[i]) gst_buffer_unref(buffers[i]);
+}
+
+/* report */
+
+static void bench_print_header(void) {
+  if (!g_strcmp0(opt_output, "json")) {
+    g_print("[\n");
+    return;
+  }
+  g_print("in_format,in_width,in_height,out_format,out_width,out_height,core,"
+          "memory,frames,fps,latency_mean_us,latency_p50_us,latency_p90_us,"
+          "latency_p99_us,latency_max_us,cpu_ms_per_frame,fallback_frames,"
+          "error\n");
+}
+
+static void bench_print_result(const BenchCase *bc, const BenchResult *r,
+                               gboolean first) {
+  if (!g_strcmp0(opt_output, "json")) {
+    gchar *error = r->error ? g_strescape(r->error, NULL) : NULL;
+
+    g_print("%s  {\"in_format\": \"%s\", \"in_width\": %d, "
+            "\"in_height\": %d, \"out_format\": \"%s\", \"out_width\": %d, "
+            "\"out_height\": %d, \"core\": \"%s\", \"memory\": \"%s\", "
+            "\"frames\": %u, \"fps\": %.2f, \"latency_mean_us\": %.1f, "
+            "\"latency_p50_us\": %.1f, \"latency_p90_us\": %.1f, "
+            "\"latency_p99_us\": %.1f, \"latency_max_us\": %.1f, "
+            "\"cpu_ms_per_frame\": %.3f, \"fallback_frames\": %"
+            G_GUINT64_FORMAT ", \"error\": %s%s%s}",
+            first ? "" : ",\n", bc->in_format, bc->in_width, bc->in_height,
+            bc->out_format, bc->out_width, bc->out_height, bc->core,
+            bc->memory, r->frames, r->fps, r->mean / 1e3, r->p50 / 1e3,
+            r->p90 / 1e3, r->p99 / 1e3, r->max / 1e3, r->cpu_ms,
+            r->fallbacks, error ? "\"" : "", error ? error : "null",
+            error ? "\"" : "");
+    g_free(error);
+    return;
+  }
+
+  /* the error is the last column, keep it a single field */
+  gchar *error = g_strdup(r->error ? r->error : "");
+  g_strdelimit(error, ",\n", ' ');
+  g_print("%s,%d,%d,%s,%d,%d,%s,%s,%u,%.2f,%.1f,%.1f,%.1f,%.1f,%.1f,%.3f,"
+          "%" G_GUINT64_FORMAT ",%s\n",
+          bc->in_format, bc->in_width, bc->in_height, bc->out_format,
+          bc->out_width, bc->out_height, bc->core, bc->memory, r->frames,
+          r->fps, r->mean / 1e3, r->p50 / 1e3, r->p90 / 1e3, r->p99 / 1e3,
+          r->max / 1e3, r->cpu_ms, r->fallbacks, error);
+  g_free(error);
+}
+
+/* matrix */
+
+/* Formats listed in the caps of a pad template of rgavideoconvert */
+static gchar **bench_template_formats(GstElementFactory *factory,
+                                      GstPadDirection direction) {
+  GPtrArray *formats = g_ptr_array_new();
+
+  for (const GList *l = gst_element_factory_get_static_pad_templates(factory);
+       l; l = l->next) {
+    GstStaticPadTemplate *templ = l->data;
+
+    if (templ->direction != direction) continue;
+
+    GstCaps *caps = gst_static_caps_get(&templ->static_caps);
+    for (guint i = 0; i < gst_caps_get_size(caps); i++) {
+      GstCapsFeatures *features = gst_caps_get_features(caps, i);
+      const GValue *list =
+          gst_structure_get_value(gst_caps_get_structure(caps, i), "format");
+
+      /* the DMA_DRM structures repeat the same formats */
+      if (!gst_caps_features_is_equal(features,
+                                      GST_CAPS_FEATURES_MEMORY_SYSTEM_MEMORY) ||
+          !list || !GST_VALUE_HOLDS_LIST(list))
+        continue;
+      for (guint j = 0; j < gst_value_list_get_size(list); j++)
+        g_ptr_array_add(formats, g_value_dup_string(
+                                     gst_value_list_get_value(list, j)));
+    }
+    gst_caps_unref(caps);
+  }
+  g_ptr_array_add(formats, NULL);
+  return (gchar **)g_ptr_array_free(formats, FALSE);
+}
+
+/* Every distinct value of the core-mask flags, auto included. Aliases such
+ * as rga2 for rga2_core0 would measure the same cores twice. */
+static gchar **bench_all_cores(void) {
+  GstElement *conv = gst_element_factory_make("rgavideoconvert", NULL);
+  GParamSpec *pspec =
+      g_object_class_find_property(G_OBJECT_GET_CLASS(conv), "core-mask");
+  GFlagsClass *flags = G_PARAM_SPEC_FLAGS(pspec)->flags_class;
+  gchar **cores = g_new0(gchar *, flags->n_values + 1);
+  guint n = 0;
+
+  for (guint i = 0; i < flags->n_values; i++) {
+    gboolean seen = FALSE;
+
+    for (guint j = 0; j < i && !seen; j++)
+      seen = flags->values[j].value == flags->values[i].value;
+    if (!seen) cores[n++] = g_strdup(flags->values[i].value_nick);
+  }
+  gst_object_unref(conv);
+  return cores;
+}
+
+static gboolean bench_parse_size(const gchar *str, gint *width,
+                                 gint *height) {
+  return sscanf(str, "%dx%d", width, height) == 2 && *width > 0 &&
+         *height > 0;
+}
+
+int main(int argc, char *argv[]) {
+  GOptionContext *ctx = g_option_context_new("- benchmark rgavideoconvert");
+  GError *err = NULL;
+
+  g_option_context_add_main_entries(ctx, entries, NULL);
+  g_option_context_add_group(ctx, gst_init_get_option_group());
+  if (!g_option_context_parse(ctx, &argc, &argv, &err)) {
+    g_printerr("%s\n", err->message);
+    return 1;
+  }
+  g_option_context_free(ctx);
+
+  GstElementFactory *factory = gst_element_factory_find("rgavideoconvert");
+  if (!factory) {
+    g_printerr("rgavideoconvert not found, check GST_PLUGIN_PATH\n");
+    return 1;
+  }
+
+  gchar **in_formats = !g_strcmp0(opt_in_formats, "all")
+                           ? bench_template_formats(factory, GST_PAD_SINK)
+                           : g_strsplit(opt_in_formats, ",", -1);
+  gchar **out_formats = !g_strcmp0(opt_out_formats, "all")
+                            ? bench_template_formats(factory, GST_PAD_SRC)
+                            : g_strsplit(opt_out_formats, ",", -1);
+  gchar **cores = !g_strcmp0(opt_cores, "all")
+                      ? bench_all_cores()
+                      : g_strsplit(opt_cores, ",", -1);
+  gchar **in_sizes = g_strsplit(opt_in_sizes, ",", -1);
+  gchar **out_sizes = g_strsplit(opt_out_sizes, ",", -1);
+  gchar **memory = g_strsplit(opt_memory, ",", -1);
+  gboolean first = TRUE;
+  int ret = 0;
+
+  bench_print_header();
+  for (gchar **is = in_sizes; *is; is++) {
+    for (gchar **os = out_sizes; *os; os++) {
+      BenchCase bc;
+
+      if (!bench_parse_size(*is, &bc.in_width, &bc.in_height) ||
+          !bench_parse_size(*os, &bc.out_width, &bc.out_height)) {
+        g_printerr("invalid size %s or %s\n", *is, *os);
+        ret = 1;
+        goto out;
+      }
+      for (gchar **i = in_formats; *i; i++) {
+        for (gchar **o = out_formats; *o; o++) {
+          for (gchar **c = cores; *c; c++) {
+            for (gchar **m = memory; *m; m++) {
+              BenchResult result;
+
+              bc.in_format = *i;
+              bc.out_format = *o;
+              bc.core = *c;
+              bc.memory = *m;
+              bench_run_case(&bc, &result);
+              bench_print_result(&bc, &result, first);
+              g_free(result.error);
+              first = FALSE;
+            }
+          }
+        }
+      }
+    }
+  }
+
+out:
+  if (!g_strcmp0(opt_output, "json")) g_print("\n]\n");
+  g_strfreev(in_formats);
+  g_strfreev(out_formats);
+  g_strfreev(cores);
+  g_strfreev(in_sizes);
+  g_strfreev(out_sizes);
+  g_strfreev(memory);
+  gst_object_unref(factory);
+  return ret;
+}
@@ -0,0 +1,122 @@
+/* GStreamer
+ * Copyright (C) 2025 FIXME <fixme@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Suite 500,
+ * Boston, MA 02110-1335, USA.
+ */
+/*
+ * GstRgaAllocator is a GstDmaBufAllocator that allocates its memories from
+ * a Linux dma-heap (/dev/dma_heap/<name>), so every buffer handed out by it
+ * can be imported by RGA and downstream hardware by fd.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"  // NOLINT
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/dma-heap.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include "gstrgaallocator.h"  // NOLINT
+
+GST_DEBUG_CATEGORY_STATIC(gst_rga_allocator_debug_category);
+#define GST_CAT_DEFAULT gst_rga_allocator_debug_category
+
+#define DMA_HEAP_DIR "/dev/dma_heap/"
+
+G_DEFINE_TYPE_WITH_CODE(GstRgaAllocator, gst_rga_allocator,
+                        GST_TYPE_DMABUF_ALLOCATOR,
+                        GST_DEBUG_CATEGORY_INIT(
+                            gst_rga_allocator_debug_category, "rgaallocator",
+                            0, "dma-heap allocator for RGA"));
+
+static GstMemory *gst_rga_allocator_alloc(GstAllocator *allocator, gsize size,
+                                          GstAllocationParams *params) {
+  GstRgaAllocator *self = GST_RGA_ALLOCATOR(allocator);
+  gsize maxsize = size + params->prefix + params->padding;
+
+  struct dma_heap_allocation_data data = {
+      0,
+  };
+  data.len = maxsize;
+  data.fd_flags = O_RDWR | O_CLOEXEC;
+
+  if (ioctl(self->heap_fd, DMA_HEAP_IOCTL_ALLOC, &data) < 0) {
+    GST_ERROR_OBJECT(self, "failed to allocate %" G_GSIZE_FORMAT
+                           " bytes from %s: %s",
+                     maxsize, self->heap_name, g_strerror(errno));
+    return NULL;
+  }
+
+  GstMemory *mem = gst_fd_allocator_alloc(allocator, data.fd, maxsize,
+                                          GST_FD_MEMORY_FLAG_NONE);
+  if (!mem) {
+    close(data.fd);
+    return NULL;
+  }
+
+  if (params->prefix || params->padding)
+    gst_memory_resize(mem, params->prefix, size);
+
+  GST_LOG_OBJECT(self, "allocated %" G_GSIZE_FORMAT " bytes, fd %d", maxsize,
+                 data.fd);
+  return mem;
+}
+
+static void gst_rga_allocator_finalize(GObject *object) {
+  GstRgaAllocator *self = GST_RGA_ALLOCATOR(object);
+
+  if (self->heap_fd >= 0) close(self->heap_fd);
+  g_free(self->heap_name);
+
+  G_OBJECT_CLASS(gst_rga_allocator_parent_class)->finalize(object);
+}
+
+static void gst_rga_allocator_class_init(GstRgaAllocatorClass *klass) {
+  GObjectClass *gobject_class = G_OBJECT_CLASS(klass);
+  GstAllocatorClass *allocator_class = GST_ALLOCATOR_CLASS(klass);
+
+  gobject_class->finalize = gst_rga_allocator_finalize;
+  allocator_class->alloc = GST_DEBUG_FUNCPTR(gst_rga_allocator_alloc);
+}
+
+static void gst_rga_allocator_init(GstRgaAllocator *self) {
+  self->heap_fd = -1;
+}
+
+GstAllocator *gst_rga_allocator_new(const gchar *heap) {
+  g_return_val_if_fail(heap != NULL, NULL);
+  g_type_ensure(GST_TYPE_RGA_ALLOCATOR);
+
+  gchar *path = g_strconcat(DMA_HEAP_DIR, heap, NULL);
+  gint fd = open(path, O_RDWR | O_CLOEXEC);
+  if (fd < 0) {
+    GST_DEBUG("cannot open %s: %s", path, g_strerror(errno));
+    g_free(path);
+    return NULL;
+  }
+  g_free(path);
+
+  GstRgaAllocator *self = g_object_new(GST_TYPE_RGA_ALLOCATOR, NULL);
+  gst_object_ref_sink(self);
+  self->heap_name = g_strdup(heap);
+  self->heap_fd = fd;
+
+  return GST_ALLOCATOR(self);
+}
@@ -0,0 +1,60 @@
+/* GStreamer
+ * Copyright (C) 2025 FIXME <fixme@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Suite 500,
+ * Boston, MA 02110-1335, USA.
+ */
+
+#ifndef PLUGINS_GSTRGAALLOCATOR_H_
+#define PLUGINS_GSTRGAALLOCATOR_H_
+
+#include <gst/allocators/gstdmabuf.h>
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_RGA_ALLOCATOR (gst_rga_allocator_get_type())
+#define GST_RGA_ALLOCATOR(obj) \
+  (G_TYPE_CHECK_INSTANCE_CAST((obj), GST_TYPE_RGA_ALLOCATOR, GstRgaAllocator))
+#define GST_RGA_ALLOCATOR_CLASS(klass)                      \
+  (G_TYPE_CHECK_CLASS_CAST((klass), GST_TYPE_RGA_ALLOCATOR, \
+                           GstRgaAllocatorClass))
+#define GST_IS_RGA_ALLOCATOR(obj) \
+  (G_TYPE_CHECK_INSTANCE_TYPE((obj), GST_TYPE_RGA_ALLOCATOR))
+
+/* dma-heap used when the requested one is not available */
+#define GST_RGA_ALLOCATOR_FALLBACK_HEAP "system"
+
+typedef struct _GstRgaAllocator GstRgaAllocator;
+typedef struct _GstRgaAllocatorClass GstRgaAllocatorClass;
+
+struct _GstRgaAllocator {
+  GstDmaBufAllocator parent;
+  gchar *heap_name;
+  gint heap_fd;
+};
+
+struct _GstRgaAllocatorClass {
+  GstDmaBufAllocatorClass parent_class;
+};
+
+GType gst_rga_allocator_get_type(void);
+
+/* Opens /dev/dma_heap/<heap>, returns NULL if the heap does not exist */
+GstAllocator *gst_rga_allocator_new(const gchar *heap);
+
+G_END_DECLS
+
+#endif  // PLUGINS_GSTRGAALLOCATOR_H_
@@ -0,0 +1,193 @@
+/* GStreamer
+ * Copyright (C) 2025 FIXME <fixme@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Suite 500,
+ * Boston, MA 02110-1335, USA.
+ */
+/*
+ * With many streams every element submits its own small job per frame and
+ * the driver spends more time in ioctls than the cores spend converting.
+ * The batcher belongs to the GstRgaDevice and gathers the blits that
+ * elements submit within a short window into one im2d job. There is no
+ * thread of its own: the first blit of a batch waits for the window to
+ * pass and commits it, the others wait for the commit. The batch is
+ * committed asynchronously, so its release fence is shared with every
+ * blit of it and the async path of the elements keeps working.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"  // NOLINT
+#endif
+
+#include <unistd.h>
+
+#include "gstrgabatcher.h"  // NOLINT
+
+GST_DEBUG_CATEGORY_STATIC(gst_rga_batcher_debug_category);
+#define GST_CAT_DEFAULT gst_rga_batcher_debug_category
+
+typedef struct {
+  rga_buffer_t src;
+  rga_buffer_t dst;
+  im_rect src_rect;
+  im_rect dst_rect;
+  im_opt_t opt;
+  int usage;
+} GstRgaBatchTask;
+
+typedef struct {
+  GstRgaBatchTask tasks[GST_RGA_BATCH_MAX_TASKS];
+  guint n_tasks;
+  /* monotonic time the batch is committed at */
+  gint64 deadline;
+  /* set once committed, with the result */
+  gboolean committed;
+  IM_STATUS status;
+  gint fence;
+  /* submitters that did not pick up the result yet */
+  guint waiters;
+} GstRgaBatch;
+
+struct _GstRgaBatcher {
+  GMutex lock;
+  GCond cond;
+  /* the batch new blits join, NULL once it is full or its window passed */
+  GstRgaBatch *open;
+  guint64 n_batches;
+  guint64 n_tasks;
+};
+
+GstRgaBatcher *gst_rga_batcher_new(void) {
+  GstRgaBatcher *self = g_new0(GstRgaBatcher, 1);
+
+  GST_DEBUG_CATEGORY_INIT(gst_rga_batcher_debug_category, "rgabatcher", 0,
+                          "RGA cross-stream job batching");
+  g_mutex_init(&self->lock);
+  g_cond_init(&self->cond);
+  return self;
+}
+
+void gst_rga_batcher_free(GstRgaBatcher *self) {
+  if (!self) return;
+
+  /* every submitter holds a device reference until it is done */
+  g_warn_if_fail(self->open == NULL);
+  if (self->n_batches)
+    GST_INFO("committed %" G_GUINT64_FORMAT " blits in %" G_GUINT64_FORMAT
+             " batches",
+             self->n_tasks, self->n_batches);
+  g_cond_clear(&self->cond);
+  g_mutex_clear(&self->lock);
+  g_free(self);
+}
+
+/* Submits the closed @batch as one job, called without the lock */
+static void gst_rga_batcher_commit(GstRgaBatch *batch) {
+  rga_buffer_t pat = {
+      0,
+  };
+  im_rect pat_rect = {
+      0,
+  };
+
+  im_job_handle_t job = imbeginJob(0);
+  IM_STATUS status = job ? IM_STATUS_SUCCESS : IM_STATUS_FAILED;
+
+  for (guint i = 0; i < batch->n_tasks && status == IM_STATUS_SUCCESS; i++) {
+    GstRgaBatchTask *task = &batch->tasks[i];
+
+    status = improcessTask(job, task->src, task->dst, pat, task->src_rect,
+                           task->dst_rect, pat_rect, &task->opt, task->usage);
+  }
+
+  if (status == IM_STATUS_SUCCESS)
+    status = imendJob(job, IM_ASYNC, -1, &batch->fence);
+  else if (job)
+    imcancelJob(job);
+
+  batch->status = status;
+  GST_LOG("committed %u blits: %s", batch->n_tasks, imStrError_t(status));
+}
+
+IM_STATUS gst_rga_batcher_submit(GstRgaBatcher *self, GstClockTime window,
+                                 const rga_buffer_t *src,
+                                 const rga_buffer_t *dst,
+                                 const im_rect *src_rect,
+                                 const im_rect *dst_rect, const im_opt_t *opt,
+                                 int usage, gint *fence, guint *batch_size) {
+  g_mutex_lock(&self->lock);
+
+  GstRgaBatch *batch = self->open;
+  gboolean leader = batch == NULL;
+  if (leader) {
+    batch = g_new0(GstRgaBatch, 1);
+    batch->fence = -1;
+    batch->deadline = g_get_monotonic_time() + window / GST_USECOND;
+    self->open = batch;
+  }
+
+  GstRgaBatchTask *task = &batch->tasks[batch->n_tasks++];
+  task->src = *src;
+  task->dst = *dst;
+  task->src_rect = *src_rect;
+  task->dst_rect = *dst_rect;
+  task->opt = *opt;
+  task->usage = usage;
+  batch->waiters++;
+
+  /* a full batch goes out right away */
+  if (batch->n_tasks == GST_RGA_BATCH_MAX_TASKS) {
+    self->open = NULL;
+    g_cond_broadcast(&self->cond);
+  }
+
+  if (leader) {
+    while (self->open == batch &&
+           g_cond_wait_until(&self->cond, &self->lock, batch->deadline)) {
+    }
+    if (self->open == batch) self->open = NULL;
+    self->n_batches++;
+    self->n_tasks += batch->n_tasks;
+    g_mutex_unlock(&self->lock);
+
+    /* closed, nobody else touches the tasks */
+    gst_rga_batcher_commit(batch);
+
+    g_mutex_lock(&self->lock);
+    batch->committed = TRUE;
+    g_cond_broadcast(&self->cond);
+  } else {
+    while (!batch->committed) g_cond_wait(&self->cond, &self->lock);
+  }
+
+  IM_STATUS status = batch->status;
+  *fence = -1;
+  if (status == IM_STATUS_SUCCESS && batch->fence >= 0) {
+    *fence = dup(batch->fence);
+    if (*fence < 0) {
+      GST_WARNING("cannot share the release fence of a batch");
+      status = IM_STATUS_FAILED;
+    }
+  }
+  if (batch_size) *batch_size = batch->n_tasks;
+
+  if (--batch->waiters == 0) {
+    if (batch->fence >= 0) close(batch->fence);
+    g_free(batch);
+  }
+  g_mutex_unlock(&self->lock);
+
+  return status;
+}
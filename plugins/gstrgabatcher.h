@@ -0,0 +1,53 @@
+/* GStreamer
+ * Copyright (C) 2025 FIXME <fixme@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Suite 500,
+ * Boston, MA 02110-1335, USA.
+ */
+
+#ifndef PLUGINS_GSTRGABATCHER_H_
+#define PLUGINS_GSTRGABATCHER_H_
+
+#include <gst/gst.h>
+
+#include "rga/im2d.h"
+
+G_BEGIN_DECLS
+
+/* blits committed together at most, librga caps the tasks of a job */
+#define GST_RGA_BATCH_MAX_TASKS 16
+
+typedef struct _GstRgaBatcher GstRgaBatcher;
+
+/* Elements get the batcher from gst_rga_device_get_batcher() */
+GstRgaBatcher *gst_rga_batcher_new(void);
+void gst_rga_batcher_free(GstRgaBatcher *batcher);
+
+/* Adds a blit to the open batch and blocks until the batch is committed
+ * to the driver as one job. The first blit opens the batch and commits it
+ * @window later, or as soon as GST_RGA_BATCH_MAX_TASKS blits joined. On
+ * success *@fence is a release fence of the whole batch, to be closed by
+ * the caller, and *@batch_size the number of blits in it. When the commit
+ * fails, every blit of the batch gets the error. */
+IM_STATUS gst_rga_batcher_submit(GstRgaBatcher *batcher, GstClockTime window,
+                                 const rga_buffer_t *src,
+                                 const rga_buffer_t *dst,
+                                 const im_rect *src_rect,
+                                 const im_rect *dst_rect, const im_opt_t *opt,
+                                 int usage, gint *fence, guint *batch_size);
+
+G_END_DECLS
+
+#endif  // PLUGINS_GSTRGABATCHER_H_
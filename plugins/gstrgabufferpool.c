@@ -0,0 +1,194 @@
+/* GStreamer
+ * Copyright (C) 2025 FIXME <fixme@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Suite 500,
+ * Boston, MA 02110-1335, USA.
+ */
+
+/*
+ * GstRgaBufferPool is the GstVideoBufferPool of the RGA elements. It counts
+ * the buffers it allocated and handed out, so buffers that stayed in the
+ * pool for a whole idle timeout can be freed while streaming rather than
+ * only when the pool is deactivated.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"  // NOLINT
+#endif
+
+#include "gstrgabufferpool.h"  // NOLINT
+
+GST_DEBUG_CATEGORY_STATIC(gst_rga_buffer_pool_debug_category);
+#define GST_CAT_DEFAULT gst_rga_buffer_pool_debug_category
+
+G_DEFINE_TYPE_WITH_CODE(GstRgaBufferPool, gst_rga_buffer_pool,
+                        GST_TYPE_VIDEO_BUFFER_POOL,
+                        GST_DEBUG_CATEGORY_INIT(
+                            gst_rga_buffer_pool_debug_category,
+                            "rgabufferpool", 0,
+                            "video buffer pool of the RGA elements"));
+
+/* Starts a new period of the idle timeout when the current one is over,
+ * call with the lock */
+static void gst_rga_buffer_pool_update_peak(GstRgaBufferPool *self,
+                                            GstClockTime now) {
+  if (!GST_CLOCK_TIME_IS_VALID(self->period_start)) {
+    self->period_start = now;
+  } else if (now - self->period_start >= self->idle_timeout) {
+    self->last_peak = self->peak;
+    self->peak = self->outstanding;
+    self->period_start = now;
+  }
+}
+
+static gboolean gst_rga_buffer_pool_set_config(GstBufferPool *pool,
+                                               GstStructure *config) {
+  GstRgaBufferPool *self = GST_RGA_BUFFER_POOL(pool);
+  guint min = 0;
+
+  gst_buffer_pool_config_get_params(config, NULL, NULL, &min, NULL);
+  g_mutex_lock(&self->lock);
+  self->config_min = min;
+  g_mutex_unlock(&self->lock);
+
+  return GST_BUFFER_POOL_CLASS(gst_rga_buffer_pool_parent_class)
+      ->set_config(pool, config);
+}
+
+static GstFlowReturn gst_rga_buffer_pool_alloc_buffer(
+    GstBufferPool *pool, GstBuffer **buffer,
+    GstBufferPoolAcquireParams *params) {
+  GstRgaBufferPool *self = GST_RGA_BUFFER_POOL(pool);
+  GstFlowReturn ret =
+      GST_BUFFER_POOL_CLASS(gst_rga_buffer_pool_parent_class)
+          ->alloc_buffer(pool, buffer, params);
+
+  if (ret == GST_FLOW_OK) {
+    g_mutex_lock(&self->lock);
+    self->allocated++;
+    g_mutex_unlock(&self->lock);
+  }
+  return ret;
+}
+
+static void gst_rga_buffer_pool_free_buffer(GstBufferPool *pool,
+                                            GstBuffer *buffer) {
+  GstRgaBufferPool *self = GST_RGA_BUFFER_POOL(pool);
+
+  g_mutex_lock(&self->lock);
+  if (self->allocated > 0) self->allocated--;
+  g_mutex_unlock(&self->lock);
+
+  GST_BUFFER_POOL_CLASS(gst_rga_buffer_pool_parent_class)
+      ->free_buffer(pool, buffer);
+}
+
+static GstFlowReturn gst_rga_buffer_pool_acquire_buffer(
+    GstBufferPool *pool, GstBuffer **buffer,
+    GstBufferPoolAcquireParams *params) {
+  GstRgaBufferPool *self = GST_RGA_BUFFER_POOL(pool);
+  GstFlowReturn ret =
+      GST_BUFFER_POOL_CLASS(gst_rga_buffer_pool_parent_class)
+          ->acquire_buffer(pool, buffer, params);
+
+  if (ret == GST_FLOW_OK) {
+    g_mutex_lock(&self->lock);
+    self->outstanding++;
+    if (self->idle_timeout)
+      gst_rga_buffer_pool_update_peak(self, gst_util_get_timestamp());
+    self->peak = MAX(self->peak, self->outstanding);
+    g_mutex_unlock(&self->lock);
+  }
+  return ret;
+}
+
+static void gst_rga_buffer_pool_release_buffer(GstBufferPool *pool,
+                                               GstBuffer *buffer) {
+  GstRgaBufferPool *self = GST_RGA_BUFFER_POOL(pool);
+  gboolean trim = FALSE;
+
+  g_mutex_lock(&self->lock);
+  if (self->idle_timeout) {
+    gst_rga_buffer_pool_update_peak(self, gst_util_get_timestamp());
+
+    guint keep = MAX(MAX(self->config_min, self->min_buffers),
+                     MAX(self->peak, self->last_peak));
+    trim = self->allocated > keep;
+  }
+  if (self->outstanding > 0) self->outstanding--;
+  g_mutex_unlock(&self->lock);
+
+  /* the base class frees tagged buffers instead of queueing them */
+  if (trim) {
+    GST_LOG_OBJECT(self, "freeing idle buffer %p", buffer);
+    GST_BUFFER_FLAG_SET(buffer, GST_BUFFER_FLAG_TAG_MEMORY);
+  }
+
+  GST_BUFFER_POOL_CLASS(gst_rga_buffer_pool_parent_class)
+      ->release_buffer(pool, buffer);
+}
+
+static void gst_rga_buffer_pool_finalize(GObject *object) {
+  GstRgaBufferPool *self = GST_RGA_BUFFER_POOL(object);
+
+  g_mutex_clear(&self->lock);
+
+  G_OBJECT_CLASS(gst_rga_buffer_pool_parent_class)->finalize(object);
+}
+
+static void gst_rga_buffer_pool_class_init(GstRgaBufferPoolClass *klass) {
+  GObjectClass *gobject_class = G_OBJECT_CLASS(klass);
+  GstBufferPoolClass *pool_class = GST_BUFFER_POOL_CLASS(klass);
+
+  gobject_class->finalize = gst_rga_buffer_pool_finalize;
+  pool_class->set_config = GST_DEBUG_FUNCPTR(gst_rga_buffer_pool_set_config);
+  pool_class->alloc_buffer =
+      GST_DEBUG_FUNCPTR(gst_rga_buffer_pool_alloc_buffer);
+  pool_class->free_buffer = GST_DEBUG_FUNCPTR(gst_rga_buffer_pool_free_buffer);
+  pool_class->acquire_buffer =
+      GST_DEBUG_FUNCPTR(gst_rga_buffer_pool_acquire_buffer);
+  pool_class->release_buffer =
+      GST_DEBUG_FUNCPTR(gst_rga_buffer_pool_release_buffer);
+}
+
+static void gst_rga_buffer_pool_init(GstRgaBufferPool *self) {
+  g_mutex_init(&self->lock);
+  self->period_start = GST_CLOCK_TIME_NONE;
+}
+
+GstBufferPool *gst_rga_buffer_pool_new(void) {
+  GstRgaBufferPool *self = g_object_new(GST_TYPE_RGA_BUFFER_POOL, NULL);
+
+  gst_object_ref_sink(self);
+  return GST_BUFFER_POOL(self);
+}
+
+void gst_rga_buffer_pool_set_idle_timeout(GstRgaBufferPool *pool,
+                                          GstClockTime timeout) {
+  g_return_if_fail(GST_IS_RGA_BUFFER_POOL(pool));
+
+  g_mutex_lock(&pool->lock);
+  pool->idle_timeout = GST_CLOCK_TIME_IS_VALID(timeout) ? timeout : 0;
+  pool->period_start = GST_CLOCK_TIME_NONE;
+  g_mutex_unlock(&pool->lock);
+}
+
+void gst_rga_buffer_pool_set_min_buffers(GstRgaBufferPool *pool, guint min) {
+  g_return_if_fail(GST_IS_RGA_BUFFER_POOL(pool));
+
+  g_mutex_lock(&pool->lock);
+  pool->min_buffers = min;
+  g_mutex_unlock(&pool->lock);
+}
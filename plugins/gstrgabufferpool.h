@@ -0,0 +1,80 @@
+/* GStreamer
+ * Copyright (C) 2025 FIXME <fixme@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Suite 500,
+ * Boston, MA 02110-1335, USA.
+ */
+
+#ifndef PLUGINS_GSTRGABUFFERPOOL_H_
+#define PLUGINS_GSTRGABUFFERPOOL_H_
+
+#include <gst/gst.h>
+#include <gst/video/gstvideopool.h>
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_RGA_BUFFER_POOL (gst_rga_buffer_pool_get_type())
+#define GST_RGA_BUFFER_POOL(obj)                               \
+  (G_TYPE_CHECK_INSTANCE_CAST((obj), GST_TYPE_RGA_BUFFER_POOL, \
+                              GstRgaBufferPool))
+#define GST_IS_RGA_BUFFER_POOL(obj) \
+  (G_TYPE_CHECK_INSTANCE_TYPE((obj), GST_TYPE_RGA_BUFFER_POOL))
+
+typedef struct _GstRgaBufferPool GstRgaBufferPool;
+typedef struct _GstRgaBufferPoolClass GstRgaBufferPoolClass;
+
+struct _GstRgaBufferPool {
+  GstVideoBufferPool parent;
+
+  /* protected by lock */
+  GMutex lock;
+  GstClockTime idle_timeout;
+  /* kept when trimming: the min-buffers of the config, or the floor set
+   * apart from it when more */
+  guint config_min;
+  guint min_buffers;
+  /* buffers allocated by the pool, and acquired from it */
+  guint allocated;
+  guint outstanding;
+  /* most buffers acquired at once in the current and the last period of
+   * idle_timeout */
+  guint peak;
+  guint last_peak;
+  GstClockTime period_start;
+};
+
+struct _GstRgaBufferPoolClass {
+  GstVideoBufferPoolClass parent_class;
+};
+
+GType gst_rga_buffer_pool_get_type(void);
+
+/* A video buffer pool that can give memory back while it is active */
+GstBufferPool *gst_rga_buffer_pool_new(void);
+
+/* Frees released buffers that were not needed for @timeout: the pool keeps
+ * its minimum, see gst_rga_buffer_pool_set_min_buffers(), or the most
+ * buffers acquired at once over the last @timeout when that is more. 0
+ * keeps every buffer. */
+void gst_rga_buffer_pool_set_idle_timeout(GstRgaBufferPool *pool,
+                                          GstClockTime timeout);
+
+/* Keeps at least @min buffers when trimming, for pools configured with a
+ * lower min-buffers so that they allocate on demand */
+void gst_rga_buffer_pool_set_min_buffers(GstRgaBufferPool *pool, guint min);
+
+G_END_DECLS
+
+#endif  // PLUGINS_GSTRGABUFFERPOOL_H_
@@ -0,0 +1,616 @@
+/* GStreamer
+ * Copyright (C) 2025 FIXME <fixme@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Suite 500,
+ * Boston, MA 02110-1335, USA.
+ */
+/**
+ * SECTION:element-gstrgacompositor
+ *
+ * The rgacompositor element blits each sink pad into its rectangle of the
+ * output with Rockchip RGA, scaling and converting the format on the way.
+ * Pads are drawn in zorder over a background color, with per-pad alpha
+ * blending. All blits of an output frame go to RGA as one job.
+ *
+ * <refsect2>
+ * <title>Example launch line</title>
+ * |[
+ * gst-launch-1.0 rgacompositor name=mix sink_1::xpos=960 ! kmssink
+ * v4l2src device=/dev/video0 ! mix.sink_0
+ * v4l2src device=/dev/video1 ! mix.sink_1
+ * ]|
+ * </refsect2>
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"  // NOLINT
+#endif
+
+#include <gst/gst.h>
+#include <gst/video/gstvideoaggregator.h>
+#include <gst/video/video.h>
+#include <string.h>
+
+#include "gstrgaallocator.h"   // NOLINT
+#include "gstrgacompositor.h"  // NOLINT
+#include "gstrgautils.h"       // NOLINT
+
+GST_DEBUG_CATEGORY_STATIC(gst_rga_compositor_debug_category);
+#define GST_CAT_DEFAULT gst_rga_compositor_debug_category
+
+/* pad templates */
+
+/* The aggregator parses the caps of its pads with gst_video_info_from_caps()
+ * which does not know DMA_DRM caps, so only plain caps are offered. dmabuf
+ * backed buffers are still imported by fd. */
+#define VIDEO_SRC_CAPS                                                         \
+  "video/x-raw, "                                                              \
+  "format = (string) " GST_RGA_SRC_FORMATS                                     \
+  ", "                                                                         \
+  "width = (int) [ 1, 4096 ] ,"                                                \
+  "height = (int) [ 1, 4096 ] ,"                                               \
+  "framerate = (fraction) [ 0, max ]"
+
+#define VIDEO_SINK_CAPS                                                        \
+  "video/x-raw, "                                                              \
+  "format = (string) " GST_RGA_SINK_FORMATS                                    \
+  ", "                                                                         \
+  "width = (int) [ 1, 8192 ] ,"                                                \
+  "height = (int) [ 1, 8192 ] ,"                                               \
+  "framerate = (fraction) [ 0, max ]"
+
+static GstStaticPadTemplate src_template = GST_STATIC_PAD_TEMPLATE(
+    "src", GST_PAD_SRC, GST_PAD_ALWAYS, GST_STATIC_CAPS(VIDEO_SRC_CAPS));
+
+static GstStaticPadTemplate sink_template =
+    GST_STATIC_PAD_TEMPLATE("sink_%u", GST_PAD_SINK, GST_PAD_REQUEST,
+                            GST_STATIC_CAPS(VIDEO_SINK_CAPS));
+
+/* pad properties */
+
+typedef enum {
+  GST_RGA_COMPOSITOR_PAD_PROP_0,
+  GST_RGA_COMPOSITOR_PAD_PROP_XPOS,
+  GST_RGA_COMPOSITOR_PAD_PROP_YPOS,
+  GST_RGA_COMPOSITOR_PAD_PROP_WIDTH,
+  GST_RGA_COMPOSITOR_PAD_PROP_HEIGHT,
+  GST_RGA_COMPOSITOR_PAD_PROP_ALPHA,
+  GST_RGA_COMPOSITOR_PAD_PROP_LAST
+} GstRgaCompositorPadProp;
+
+static GParamSpec *rga_pad_props[GST_RGA_COMPOSITOR_PAD_PROP_LAST];
+
+#define DEFAULT_PAD_XPOS 0
+#define DEFAULT_PAD_YPOS 0
+#define DEFAULT_PAD_WIDTH 0
+#define DEFAULT_PAD_HEIGHT 0
+#define DEFAULT_PAD_ALPHA 1.0
+
+G_DEFINE_TYPE(GstRgaCompositorPad, gst_rga_compositor_pad,
+              GST_TYPE_VIDEO_AGGREGATOR_PAD);
+
+static void gst_rga_compositor_pad_set_property(GObject *object,
+                                                guint prop_id,
+                                                const GValue *value,
+                                                GParamSpec *pspec) {
+  GstRgaCompositorPad *pad = GST_RGA_COMPOSITOR_PAD(object);
+
+  GST_OBJECT_LOCK(pad);
+  switch (prop_id) {
+    case GST_RGA_COMPOSITOR_PAD_PROP_XPOS:
+      pad->xpos = g_value_get_int(value);
+      break;
+    case GST_RGA_COMPOSITOR_PAD_PROP_YPOS:
+      pad->ypos = g_value_get_int(value);
+      break;
+    case GST_RGA_COMPOSITOR_PAD_PROP_WIDTH:
+      pad->width = g_value_get_int(value);
+      break;
+    case GST_RGA_COMPOSITOR_PAD_PROP_HEIGHT:
+      pad->height = g_value_get_int(value);
+      break;
+    case GST_RGA_COMPOSITOR_PAD_PROP_ALPHA:
+      pad->alpha = g_value_get_double(value);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+      break;
+  }
+  GST_OBJECT_UNLOCK(pad);
+}
+
+static void gst_rga_compositor_pad_get_property(GObject *object,
+                                                guint prop_id, GValue *value,
+                                                GParamSpec *pspec) {
+  GstRgaCompositorPad *pad = GST_RGA_COMPOSITOR_PAD(object);
+
+  GST_OBJECT_LOCK(pad);
+  switch (prop_id) {
+    case GST_RGA_COMPOSITOR_PAD_PROP_XPOS:
+      g_value_set_int(value, pad->xpos);
+      break;
+    case GST_RGA_COMPOSITOR_PAD_PROP_YPOS:
+      g_value_set_int(value, pad->ypos);
+      break;
+    case GST_RGA_COMPOSITOR_PAD_PROP_WIDTH:
+      g_value_set_int(value, pad->width);
+      break;
+    case GST_RGA_COMPOSITOR_PAD_PROP_HEIGHT:
+      g_value_set_int(value, pad->height);
+      break;
+    case GST_RGA_COMPOSITOR_PAD_PROP_ALPHA:
+      g_value_set_double(value, pad->alpha);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+      break;
+  }
+  GST_OBJECT_UNLOCK(pad);
+}
+
+/* RGA reads the buffers by fd, so describe them without the CPU mapping
+ * done by the base class */
+static gboolean gst_rga_compositor_pad_prepare_frame(
+    GstVideoAggregatorPad *vpad, GstVideoAggregator *vagg, GstBuffer *buffer,
+    GstVideoFrame *prepared_frame) {
+  return gst_rga_video_frame_init(GST_OBJECT(vpad), prepared_frame,
+                                  &vpad->info, buffer, DRM_FORMAT_MOD_LINEAR);
+}
+
+static void gst_rga_compositor_pad_clean_frame(GstVideoAggregatorPad *vpad,
+                                               GstVideoAggregator *vagg,
+                                               GstVideoFrame *prepared_frame) {
+  /* never mapped */
+  memset(prepared_frame, 0, sizeof(*prepared_frame));
+}
+
+static void gst_rga_compositor_pad_class_init(
+    GstRgaCompositorPadClass *klass) {
+  GObjectClass *gobject_class = G_OBJECT_CLASS(klass);
+  GstVideoAggregatorPadClass *vpad_class =
+      GST_VIDEO_AGGREGATOR_PAD_CLASS(klass);
+
+  rga_pad_props[GST_RGA_COMPOSITOR_PAD_PROP_XPOS] = g_param_spec_int(
+      "xpos", "X position", "X position of the picture", G_MININT, G_MAXINT,
+      DEFAULT_PAD_XPOS,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_CONTROLLABLE);
+  rga_pad_props[GST_RGA_COMPOSITOR_PAD_PROP_YPOS] = g_param_spec_int(
+      "ypos", "Y position", "Y position of the picture", G_MININT, G_MAXINT,
+      DEFAULT_PAD_YPOS,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_CONTROLLABLE);
+  rga_pad_props[GST_RGA_COMPOSITOR_PAD_PROP_WIDTH] = g_param_spec_int(
+      "width", "Width", "Width of the picture, 0 for the input width", 0,
+      G_MAXINT, DEFAULT_PAD_WIDTH,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_CONTROLLABLE);
+  rga_pad_props[GST_RGA_COMPOSITOR_PAD_PROP_HEIGHT] = g_param_spec_int(
+      "height", "Height", "Height of the picture, 0 for the input height", 0,
+      G_MAXINT, DEFAULT_PAD_HEIGHT,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_CONTROLLABLE);
+  rga_pad_props[GST_RGA_COMPOSITOR_PAD_PROP_ALPHA] = g_param_spec_double(
+      "alpha", "Alpha", "Alpha of the picture", 0.0, 1.0, DEFAULT_PAD_ALPHA,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_CONTROLLABLE);
+
+  gobject_class->set_property = gst_rga_compositor_pad_set_property;
+  gobject_class->get_property = gst_rga_compositor_pad_get_property;
+  g_object_class_install_properties(
+      gobject_class, GST_RGA_COMPOSITOR_PAD_PROP_LAST, rga_pad_props);
+
+  vpad_class->prepare_frame =
+      GST_DEBUG_FUNCPTR(gst_rga_compositor_pad_prepare_frame);
+  vpad_class->clean_frame =
+      GST_DEBUG_FUNCPTR(gst_rga_compositor_pad_clean_frame);
+}
+
+static void gst_rga_compositor_pad_init(GstRgaCompositorPad *pad) {
+  pad->xpos = DEFAULT_PAD_XPOS;
+  pad->ypos = DEFAULT_PAD_YPOS;
+  pad->width = DEFAULT_PAD_WIDTH;
+  pad->height = DEFAULT_PAD_HEIGHT;
+  pad->alpha = DEFAULT_PAD_ALPHA;
+}
+
+/* The output rectangle of @pad, in the output frame coordinates */
+static gdouble gst_rga_compositor_pad_get_rect(GstRgaCompositorPad *pad,
+                                              im_rect *rect) {
+  GstVideoInfo *info = &GST_VIDEO_AGGREGATOR_PAD(pad)->info;
+
+  GST_OBJECT_LOCK(pad);
+  rect->x = pad->xpos;
+  rect->y = pad->ypos;
+  rect->width = pad->width ? pad->width : GST_VIDEO_INFO_WIDTH(info);
+  rect->height = pad->height ? pad->height : GST_VIDEO_INFO_HEIGHT(info);
+  gdouble alpha = pad->alpha;
+  GST_OBJECT_UNLOCK(pad);
+  return alpha;
+}
+
+/* element properties */
+
+typedef enum {
+  GST_RGA_COMPOSITOR_PROP_0,
+  GST_RGA_COMPOSITOR_PROP_CORE_MASK,
+  GST_RGA_COMPOSITOR_PROP_DMA_HEAP,
+  GST_RGA_COMPOSITOR_PROP_BACKGROUND,
+  GST_RGA_COMPOSITOR_PROP_LAST
+} GstRgaCompositorProp;
+
+static GParamSpec *rga_props[GST_RGA_COMPOSITOR_PROP_LAST];
+
+#define DEFAULT_DMA_HEAP "system-uncached"
+#define DEFAULT_BACKGROUND 0xff000000
+
+G_DEFINE_TYPE_WITH_CODE(
+    GstRgaCompositor, gst_rga_compositor, GST_TYPE_VIDEO_AGGREGATOR,
+    GST_DEBUG_CATEGORY_INIT(gst_rga_compositor_debug_category,
+                            "rgacompositor", 0, "RGA video compositor"));
+
+static void gst_rga_compositor_set_property(GObject *object, guint prop_id,
+                                            const GValue *value,
+                                            GParamSpec *pspec) {
+  GstRgaCompositor *self = GST_RGA_COMPOSITOR(object);
+
+  GST_OBJECT_LOCK(self);
+  switch (prop_id) {
+    case GST_RGA_COMPOSITOR_PROP_CORE_MASK:
+      self->core_mask = g_value_get_flags(value);
+      break;
+    case GST_RGA_COMPOSITOR_PROP_DMA_HEAP:
+      g_free(self->dma_heap);
+      self->dma_heap = g_value_dup_string(value);
+      break;
+    case GST_RGA_COMPOSITOR_PROP_BACKGROUND:
+      self->background = g_value_get_uint(value);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+      break;
+  }
+  GST_OBJECT_UNLOCK(self);
+}
+
+static void gst_rga_compositor_get_property(GObject *object, guint prop_id,
+                                            GValue *value, GParamSpec *pspec) {
+  GstRgaCompositor *self = GST_RGA_COMPOSITOR(object);
+
+  GST_OBJECT_LOCK(self);
+  switch (prop_id) {
+    case GST_RGA_COMPOSITOR_PROP_CORE_MASK:
+      g_value_set_flags(value, self->core_mask);
+      break;
+    case GST_RGA_COMPOSITOR_PROP_DMA_HEAP:
+      g_value_set_string(value, self->dma_heap);
+      break;
+    case GST_RGA_COMPOSITOR_PROP_BACKGROUND:
+      g_value_set_uint(value, self->background);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+      break;
+  }
+  GST_OBJECT_UNLOCK(self);
+}
+
+static void gst_rga_compositor_finalize(GObject *object) {
+  GstRgaCompositor *self = GST_RGA_COMPOSITOR(object);
+
+  g_free(self->dma_heap);
+
+  G_OBJECT_CLASS(gst_rga_compositor_parent_class)->finalize(object);
+}
+
+/* Like compositor: an output large enough for every pad at the highest
+ * input framerate */
+static GstCaps *gst_rga_compositor_fixate_src_caps(GstAggregator *agg,
+                                                   GstCaps *caps) {
+  gint best_width = -1, best_height = -1;
+  gint best_fps_n = -1, best_fps_d = -1;
+  gdouble best_fps = 0.;
+
+  caps = gst_caps_make_writable(caps);
+  GstStructure *s = gst_caps_get_structure(caps, 0);
+
+  GST_OBJECT_LOCK(agg);
+  for (GList *l = GST_ELEMENT(agg)->sinkpads; l; l = l->next) {
+    GstVideoAggregatorPad *vpad = l->data;
+    gint fps_n = GST_VIDEO_INFO_FPS_N(&vpad->info);
+    gint fps_d = GST_VIDEO_INFO_FPS_D(&vpad->info);
+    gdouble cur_fps = 0.;
+    im_rect rect;
+
+    if (!vpad->info.finfo ||
+        GST_VIDEO_INFO_FORMAT(&vpad->info) == GST_VIDEO_FORMAT_UNKNOWN)
+      continue;
+
+    gst_rga_compositor_pad_get_rect(GST_RGA_COMPOSITOR_PAD(vpad), &rect);
+    best_width = MAX(best_width, rect.x + rect.width);
+    best_height = MAX(best_height, rect.y + rect.height);
+
+    if (fps_d > 0) gst_util_fraction_to_double(fps_n, fps_d, &cur_fps);
+    if (cur_fps > best_fps) {
+      best_fps = cur_fps;
+      best_fps_n = fps_n;
+      best_fps_d = fps_d;
+    }
+  }
+  GST_OBJECT_UNLOCK(agg);
+
+  if (best_fps_n <= 0 || best_fps_d <= 0) {
+    best_fps_n = 25;
+    best_fps_d = 1;
+  }
+
+  if (best_width > 0)
+    gst_structure_fixate_field_nearest_int(s, "width", best_width);
+  if (best_height > 0)
+    gst_structure_fixate_field_nearest_int(s, "height", best_height);
+  gst_structure_fixate_field_nearest_fraction(s, "framerate", best_fps_n,
+                                              best_fps_d);
+  return gst_caps_fixate(caps);
+}
+
+static gboolean gst_rga_compositor_decide_allocation(GstAggregator *agg,
+                                                     GstQuery *query) {
+  GstRgaCompositor *self = GST_RGA_COMPOSITOR(agg);
+
+  GST_OBJECT_LOCK(self);
+  gchar *heap = g_strdup(self->dma_heap);
+  GST_OBJECT_UNLOCK(self);
+  GstAllocator *allocator = gst_rga_create_allocator(GST_OBJECT(agg), heap);
+  g_free(heap);
+
+  if (!allocator) {
+    GST_WARNING_OBJECT(self,
+                       "no dma-heap available, output buffers will be "
+                       "mapped by the CPU");
+    return GST_AGGREGATOR_CLASS(gst_rga_compositor_parent_class)
+        ->decide_allocation(agg, query);
+  }
+
+  gboolean ret =
+      gst_rga_decide_allocation(GST_OBJECT(agg), query, allocator, NULL);
+  gst_object_unref(allocator);
+  return ret;
+}
+
+static gboolean gst_rga_compositor_start(GstAggregator *agg) {
+  GstRgaCompositor *self = GST_RGA_COMPOSITOR(agg);
+
+  if (!GST_AGGREGATOR_CLASS(gst_rga_compositor_parent_class)->start(agg))
+    return FALSE;
+
+  self->device = gst_rga_device_ref();
+  self->scheduler = gst_rga_device_get_scheduler(self->device);
+  return TRUE;
+}
+
+static gboolean gst_rga_compositor_stop(GstAggregator *agg) {
+  GstRgaCompositor *self = GST_RGA_COMPOSITOR(agg);
+
+  if (self->device) {
+    self->scheduler = NULL;
+    gst_rga_device_unref(self->device);
+    self->device = NULL;
+  }
+  return GST_AGGREGATOR_CLASS(gst_rga_compositor_parent_class)->stop(agg);
+}
+
+/* aggregate */
+
+typedef struct {
+  rga_buffer_t src_info;
+  im_rect src_rect;
+  im_rect dst_rect;
+  GstBuffer *buffer;
+  GstMapInfo map;
+  int usage;
+} GstRgaBlit;
+
+static void gst_rga_blit_clear(GstRgaBlit *blit) {
+  if (blit->map.memory) gst_buffer_unmap(blit->buffer, &blit->map);
+}
+
+/* Collects the visible pads in zorder, the sinkpads are kept sorted by the
+ * base class */
+static GArray *gst_rga_compositor_collect(GstRgaCompositor *self,
+                                          GstVideoInfo *out_info,
+                                          gboolean *dma32) {
+  GArray *blits = g_array_new(FALSE, TRUE, sizeof(GstRgaBlit));
+  g_array_set_clear_func(blits, (GDestroyNotify)gst_rga_blit_clear);
+
+  GST_OBJECT_LOCK(self);
+  for (GList *l = GST_ELEMENT(self)->sinkpads; l; l = l->next) {
+    GstVideoAggregatorPad *vpad = l->data;
+    GstVideoFrame *frame = gst_video_aggregator_pad_get_prepared_frame(vpad);
+    GstRgaBlit blit = {
+        0,
+    };
+    im_rect rect, image;
+
+    if (!frame || !frame->buffer) continue;
+
+    gdouble alpha =
+        gst_rga_compositor_pad_get_rect(GST_RGA_COMPOSITOR_PAD(vpad), &rect);
+    if (alpha <= 0. || rect.width <= 0 || rect.height <= 0) continue;
+    if (!gst_rga_clip_rect(&rect, GST_VIDEO_FRAME_WIDTH(frame),
+                           GST_VIDEO_FRAME_HEIGHT(frame),
+                           GST_VIDEO_INFO_WIDTH(out_info),
+                           GST_VIDEO_INFO_HEIGHT(out_info), &blit.src_rect,
+                           &blit.dst_rect))
+      continue;
+
+    blit.buffer = frame->buffer;
+    if (!gst_rga_info_from_video_frame(GST_OBJECT(vpad), &blit.src_info,
+                                       &image, frame, DRM_FORMAT_MOD_LINEAR,
+                                       &blit.map, GST_MAP_READ, NULL, NULL)) {
+      gst_rga_blit_clear(&blit);
+      continue;
+    }
+    /* the source rectangle is relative to the image origin */
+    blit.src_rect.x += image.x;
+    blit.src_rect.y += image.y;
+
+    /* pad video is not premultiplied, RGA does it before blending, also
+     * for the pad alpha */
+    if (alpha < 1. || GST_VIDEO_INFO_HAS_ALPHA(&vpad->info)) {
+      blit.src_info.global_alpha = (int)(alpha * 255 + 0.5);
+      blit.usage = IM_ALPHA_BLEND_SRC_OVER | IM_ALPHA_BLEND_PRE_MUL;
+    }
+
+    *dma32 = *dma32 && gst_rga_buffer_is_dma32(frame->buffer);
+    g_array_append_val(blits, blit);
+  }
+  GST_OBJECT_UNLOCK(self);
+
+  return blits;
+}
+
+static GstFlowReturn gst_rga_compositor_aggregate_frames(
+    GstVideoAggregator *vagg, GstBuffer *outbuf) {
+  GstRgaCompositor *self = GST_RGA_COMPOSITOR(vagg);
+  GstVideoFrame outframe;
+  GstMapInfo out_map = {
+      0,
+  };
+  rga_buffer_t dst_info = {
+      0,
+  };
+  rga_buffer_t none = {
+      0,
+  };
+  im_rect dst_rect;
+  im_rect none_rect = {
+      0,
+  };
+  im_opt_t opt = {
+      0,
+  };
+
+  if (!gst_rga_video_frame_init(GST_OBJECT(vagg), &outframe, &vagg->info,
+                                outbuf, DRM_FORMAT_MOD_LINEAR) ||
+      !gst_rga_info_from_video_frame(GST_OBJECT(vagg), &dst_info, &dst_rect,
+                                     &outframe, DRM_FORMAT_MOD_LINEAR,
+                                     &out_map, GST_MAP_WRITE, NULL, NULL)) {
+    GST_ELEMENT_ERROR(self, STREAM, FORMAT, (NULL),
+                      ("invalid output buffer"));
+    return GST_FLOW_ERROR;
+  }
+
+  gboolean dma32 = gst_rga_buffer_is_dma32(outbuf);
+  GArray *blits = gst_rga_compositor_collect(self, &vagg->info, &dma32);
+
+  GST_OBJECT_LOCK(self);
+  guint32 core_mask = self->core_mask;
+  guint32 background = self->background;
+  GST_OBJECT_UNLOCK(self);
+
+  /* RGA2 only reaches the low 4 GB, keep other buffers on RGA3 */
+  gboolean allow_rga2 =
+      !gst_rga_scheduler_has_high_memory(self->scheduler) || dma32;
+  opt.core = gst_rga_scheduler_acquire(self->scheduler, core_mask, allow_rga2);
+  opt.color = gst_rga_color_from_argb(background);
+
+  /* one job for the whole frame saves an ioctl round trip per pad */
+  im_job_handle_t job = imbeginJob(0);
+  IM_STATUS status = job ? IM_STATUS_SUCCESS : IM_STATUS_FAILED;
+
+  if (status == IM_STATUS_SUCCESS)
+    status = improcessTask(job, none, dst_info, none, none_rect, dst_rect,
+                           none_rect, &opt, IM_COLOR_FILL);
+
+  for (guint i = 0; i < blits->len && status == IM_STATUS_SUCCESS; i++) {
+    GstRgaBlit *blit = &g_array_index(blits, GstRgaBlit, i);
+    im_rect rect = blit->dst_rect;
+
+    rect.x += dst_rect.x;
+    rect.y += dst_rect.y;
+    status = improcessTask(job, blit->src_info, dst_info, none,
+                           blit->src_rect, rect, none_rect, &opt, blit->usage);
+  }
+
+  if (status == IM_STATUS_SUCCESS)
+    status = imendJob(job, IM_SYNC, -1, NULL);
+  else if (job)
+    imcancelJob(job);
+  gst_rga_scheduler_release(self->scheduler, opt.core);
+
+  g_array_unref(blits);
+  if (out_map.memory) gst_buffer_unmap(outbuf, &out_map);
+
+  if (status != IM_STATUS_SUCCESS) {
+    GST_ELEMENT_ERROR(self, LIBRARY, FAILED, (NULL),
+                      ("failed to compose: %s", imStrError_t(status)));
+    return GST_FLOW_ERROR;
+  }
+  return GST_FLOW_OK;
+}
+
+/* class initialization */
+
+static void gst_rga_compositor_class_init(GstRgaCompositorClass *klass) {
+  GObjectClass *gobject_class = G_OBJECT_CLASS(klass);
+  GstElementClass *element_class = GST_ELEMENT_CLASS(klass);
+  GstAggregatorClass *agg_class = GST_AGGREGATOR_CLASS(klass);
+  GstVideoAggregatorClass *vagg_class = GST_VIDEO_AGGREGATOR_CLASS(klass);
+
+  gst_element_class_add_static_pad_template_with_gtype(
+      element_class, &src_template, GST_TYPE_AGGREGATOR_PAD);
+  gst_element_class_add_static_pad_template_with_gtype(
+      element_class, &sink_template, GST_TYPE_RGA_COMPOSITOR_PAD);
+
+  gst_element_class_set_static_metadata(
+      element_class, "RgaCompositor Plugin", "Filter/Editor/Video/Compositor",
+      "Composites video streams via Rockchip RGA",
+      "http://github.com/corenel/gstreamer-rga");
+
+  /* element properties */
+  rga_props[GST_RGA_COMPOSITOR_PROP_CORE_MASK] = g_param_spec_flags(
+      "core-mask", "Core mask", "Select which RGA core(s) to use (bit-mask)",
+      gst_rga_core_mask_get_type(), IM_SCHEDULER_DEFAULT,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
+  rga_props[GST_RGA_COMPOSITOR_PROP_DMA_HEAP] = g_param_spec_string(
+      "dma-heap", "DMA heap",
+      "dma-heap (under /dev/dma_heap) to allocate output buffers from, falls "
+      "back to \"" GST_RGA_ALLOCATOR_FALLBACK_HEAP "\" if missing",
+      DEFAULT_DMA_HEAP,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_MUTABLE_READY);
+
+  rga_props[GST_RGA_COMPOSITOR_PROP_BACKGROUND] = g_param_spec_uint(
+      "background", "Background",
+      "Color of the area no pad covers (0xAARRGGBB)", 0, G_MAXUINT32,
+      DEFAULT_BACKGROUND,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_MUTABLE_PLAYING);
+
+  gobject_class->set_property = gst_rga_compositor_set_property;
+  gobject_class->get_property = gst_rga_compositor_get_property;
+  gobject_class->finalize = gst_rga_compositor_finalize;
+  g_object_class_install_properties(gobject_class,
+                                    GST_RGA_COMPOSITOR_PROP_LAST, rga_props);
+
+  agg_class->fixate_src_caps =
+      GST_DEBUG_FUNCPTR(gst_rga_compositor_fixate_src_caps);
+  agg_class->decide_allocation =
+      GST_DEBUG_FUNCPTR(gst_rga_compositor_decide_allocation);
+  agg_class->start = GST_DEBUG_FUNCPTR(gst_rga_compositor_start);
+  agg_class->stop = GST_DEBUG_FUNCPTR(gst_rga_compositor_stop);
+  vagg_class->aggregate_frames =
+      GST_DEBUG_FUNCPTR(gst_rga_compositor_aggregate_frames);
+}
+
+static void gst_rga_compositor_init(GstRgaCompositor *self) {
+  self->core_mask = IM_SCHEDULER_DEFAULT;
+  self->background = DEFAULT_BACKGROUND;
+  self->dma_heap = g_strdup(DEFAULT_DMA_HEAP);
+}
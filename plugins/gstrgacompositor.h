@@ -0,0 +1,85 @@
+/* GStreamer
+ * Copyright (C) 2025 FIXME <fixme@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Suite 500,
+ * Boston, MA 02110-1335, USA.
+ */
+
+#ifndef PLUGINS_GSTRGACOMPOSITOR_H_
+#define PLUGINS_GSTRGACOMPOSITOR_H_
+
+#include <gst/video/gstvideoaggregator.h>
+#include <gst/video/video.h>
+
+#include "gstrgadevice.h"  // NOLINT
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_RGA_COMPOSITOR_PAD (gst_rga_compositor_pad_get_type())
+#define GST_RGA_COMPOSITOR_PAD(obj)                               \
+  (G_TYPE_CHECK_INSTANCE_CAST((obj), GST_TYPE_RGA_COMPOSITOR_PAD, \
+                              GstRgaCompositorPad))
+#define GST_IS_RGA_COMPOSITOR_PAD(obj) \
+  (G_TYPE_CHECK_INSTANCE_TYPE((obj), GST_TYPE_RGA_COMPOSITOR_PAD))
+
+#define GST_TYPE_RGA_COMPOSITOR (gst_rga_compositor_get_type())
+#define GST_RGA_COMPOSITOR(obj)                               \
+  (G_TYPE_CHECK_INSTANCE_CAST((obj), GST_TYPE_RGA_COMPOSITOR, \
+                              GstRgaCompositor))
+#define GST_IS_RGA_COMPOSITOR(obj) \
+  (G_TYPE_CHECK_INSTANCE_TYPE((obj), GST_TYPE_RGA_COMPOSITOR))
+
+typedef struct _GstRgaCompositorPad GstRgaCompositorPad;
+typedef struct _GstRgaCompositorPadClass GstRgaCompositorPadClass;
+typedef struct _GstRgaCompositor GstRgaCompositor;
+typedef struct _GstRgaCompositorClass GstRgaCompositorClass;
+
+struct _GstRgaCompositorPad {
+  GstVideoAggregatorPad parent;
+  /* protected by the object lock */
+  gint xpos;
+  gint ypos;
+  /* 0 keeps the input size */
+  gint width;
+  gint height;
+  gdouble alpha;
+};
+
+struct _GstRgaCompositorPadClass {
+  GstVideoAggregatorPadClass parent_class;
+};
+
+struct _GstRgaCompositor {
+  GstVideoAggregator parent;
+  /* protected by the object lock */
+  guint32 core_mask;
+  guint32 background;
+  gchar *dma_heap;
+
+  GstRgaDevice *device;
+  /* owned by device */
+  GstRgaScheduler *scheduler;
+};
+
+struct _GstRgaCompositorClass {
+  GstVideoAggregatorClass parent_class;
+};
+
+GType gst_rga_compositor_pad_get_type(void);
+GType gst_rga_compositor_get_type(void);
+
+G_END_DECLS
+
+#endif  // PLUGINS_GSTRGACOMPOSITOR_H_
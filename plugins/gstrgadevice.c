@@ -0,0 +1,161 @@
+/* GStreamer
+ * Copyright (C) 2025 FIXME <fixme@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Suite 500,
+ * Boston, MA 02110-1335, USA.
+ */
+/*
+ * librga keeps refcounted globals behind c_RkRgaInit() and c_RkRgaDeInit(),
+ * which are not safe to call from several streaming threads at once. The
+ * device wraps them in one context shared by every element, together with
+ * the core scheduler, the job batcher and the buffer handles imported from
+ * dmabufs, and only tears it down when the last element stopped and the
+ * last handle was released.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"  // NOLINT
+#endif
+
+#include <gst/allocators/gstdmabuf.h>
+
+#include "gstrgadevice.h"  // NOLINT
+#include "rga/RgaApi.h"
+
+GST_DEBUG_CATEGORY_STATIC(gst_rga_device_debug_category);
+#define GST_CAT_DEFAULT gst_rga_device_debug_category
+
+struct _GstRgaDevice {
+  /* protected by the device lock */
+  gint refcount;
+  guint n_handles;
+
+  GstRgaScheduler *scheduler;
+  GstRgaBatcher *batcher;
+};
+
+G_LOCK_DEFINE_STATIC(device);
+static GstRgaDevice *device_instance;
+
+GstRgaDevice *gst_rga_device_ref(void) {
+  GstRgaDevice *self;
+
+  G_LOCK(device);
+  if (!device_instance) {
+    GST_DEBUG_CATEGORY_INIT(gst_rga_device_debug_category, "rgadevice", 0,
+                            "RGA device context");
+    device_instance = g_new0(GstRgaDevice, 1);
+    c_RkRgaInit();
+    device_instance->scheduler = gst_rga_scheduler_new();
+    device_instance->batcher = gst_rga_batcher_new();
+    GST_INFO("RGA device opened");
+  }
+  self = device_instance;
+  self->refcount++;
+  G_UNLOCK(device);
+
+  return self;
+}
+
+void gst_rga_device_unref(GstRgaDevice *self) {
+  g_return_if_fail(self != NULL);
+
+  G_LOCK(device);
+  if (--self->refcount == 0) {
+    g_warn_if_fail(self->n_handles == 0);
+    gst_rga_batcher_free(self->batcher);
+    gst_rga_scheduler_free(self->scheduler);
+    c_RkRgaDeInit();
+    g_free(self);
+    device_instance = NULL;
+    GST_INFO("RGA device closed");
+  }
+  G_UNLOCK(device);
+}
+
+GstRgaScheduler *gst_rga_device_get_scheduler(GstRgaDevice *self) {
+  return self->scheduler;
+}
+
+GstRgaBatcher *gst_rga_device_get_batcher(GstRgaDevice *self) {
+  return self->batcher;
+}
+
+/* buffer handle cache */
+
+typedef struct {
+  GstRgaDevice *device;
+  rga_buffer_handle_t handle;
+} GstRgaHandle;
+
+G_DEFINE_QUARK(GstRgaBufferHandle, gst_rga_handle)
+
+static void gst_rga_handle_release(gpointer data) {
+  GstRgaHandle *handle = data;
+
+  releasebuffer_handle(handle->handle);
+  G_LOCK(device);
+  handle->device->n_handles--;
+  G_UNLOCK(device);
+  gst_rga_device_unref(handle->device);
+  g_free(handle);
+}
+
+rga_buffer_handle_t gst_rga_memory_get_handle(GstMemory *mem) {
+  GstRgaHandle *cached =
+      gst_mini_object_get_qdata(GST_MINI_OBJECT(mem), gst_rga_handle_quark());
+  if (cached) return cached->handle;
+
+  gsize maxsize;
+  gst_memory_get_sizes(mem, NULL, &maxsize);
+
+  /* dmabuf imports only need the byte size: describe it as one 8-bit row */
+  im_handle_param_t param = {
+      0,
+  };
+  param.width = maxsize;
+  param.height = 1;
+  param.format = RK_FORMAT_YCbCr_400;
+
+  GstRgaDevice *device = gst_rga_device_ref();
+  rga_buffer_handle_t handle =
+      importbuffer_fd(gst_dmabuf_memory_get_fd(mem), &param);
+  if (!handle) {
+    gst_rga_device_unref(device);
+    return 0;
+  }
+
+  /* another element may have imported the memory meanwhile, replacing its
+   * handle would release it under a job that still uses it */
+  G_LOCK(device);
+  cached =
+      gst_mini_object_get_qdata(GST_MINI_OBJECT(mem), gst_rga_handle_quark());
+  if (!cached) {
+    GstRgaHandle *data = g_new(GstRgaHandle, 1);
+    data->device = device;
+    data->handle = handle;
+    device->n_handles++;
+    gst_mini_object_set_qdata(GST_MINI_OBJECT(mem), gst_rga_handle_quark(),
+                              data, gst_rga_handle_release);
+  }
+  G_UNLOCK(device);
+
+  if (cached) {
+    releasebuffer_handle(handle);
+    gst_rga_device_unref(device);
+    return cached->handle;
+  }
+  return handle;
+}
@@ -0,0 +1,49 @@
+/* GStreamer
+ * Copyright (C) 2025 FIXME <fixme@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Suite 500,
+ * Boston, MA 02110-1335, USA.
+ */
+#ifndef PLUGINS_GSTRGADEVICE_H_
+#define PLUGINS_GSTRGADEVICE_H_
+
+#include <gst/gst.h>
+
+#include "gstrgabatcher.h"    // NOLINT
+#include "gstrgascheduler.h"  // NOLINT
+#include "rga/im2d.h"
+
+G_BEGIN_DECLS
+
+typedef struct _GstRgaDevice GstRgaDevice;
+
+/* Returns the process-wide RGA context, initializing librga and the core
+ * scheduler on first use. Elements take a reference from NULL to READY or
+ * in start, so restarting one branch leaves the others undisturbed. */
+GstRgaDevice *gst_rga_device_ref(void);
+void gst_rga_device_unref(GstRgaDevice *device);
+
+GstRgaScheduler *gst_rga_device_get_scheduler(GstRgaDevice *device);
+GstRgaBatcher *gst_rga_device_get_batcher(GstRgaDevice *device);
+
+/* Returns the RGA handle of a dmabuf memory, importing it on first use.
+ * The handle lives as long as the memory itself, so buffers recycled by
+ * an upstream pool are only imported (and IOMMU-mapped) once. Each handle
+ * keeps the device alive until it is released. */
+rga_buffer_handle_t gst_rga_memory_get_handle(GstMemory *mem);
+
+G_END_DECLS
+
+#endif  // PLUGINS_GSTRGADEVICE_H_
@@ -0,0 +1,764 @@
+/* GStreamer
+ * Copyright (C) 2025 FIXME <fixme@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Suite 500,
+ * Boston, MA 02110-1335, USA.
+ */
+/**
+ * SECTION:element-gstrgamultiscale
+ *
+ * The rgamultiscale element converts every input frame to several outputs
+ * at once, one per request src pad. Each pad negotiates its own format and
+ * size with downstream. The input is imported once and all conversions of
+ * a frame go to Rockchip RGA as one job, which replaces a tee with one
+ * queue and rgavideoconvert per branch.
+ *
+ * <refsect2>
+ * <title>Example launch line</title>
+ * |[
+ * gst-launch-1.0 filesrc location=in.mp4 ! decodebin ! rgamultiscale name=s
+ * s.src_0 ! video/x-raw,format=BGR,width=640,height=480 ! fakesink
+ * s.src_1 ! video/x-raw,format=NV12,width=1280,height=720 ! fakesink
+ * ]|
+ * </refsect2>
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"  // NOLINT
+#endif
+
+#include <gst/gst.h>
+#include <gst/video/gstvideopool.h>
+#include <gst/video/video.h>
+
+#include "gstrgaallocator.h"   // NOLINT
+#include "gstrgamultiscale.h"  // NOLINT
+#include "gstrgautils.h"       // NOLINT
+
+GST_DEBUG_CATEGORY_STATIC(gst_rga_multi_scale_debug_category);
+#define GST_CAT_DEFAULT gst_rga_multi_scale_debug_category
+
+/* pad templates */
+
+#define VIDEO_SRC_CAPS                                                         \
+  "video/x-raw, "                                                              \
+  "format = (string) " GST_RGA_SRC_FORMATS                                     \
+  ", "                                                                         \
+  "width = (int) [ 1, 4096 ] ,"                                                \
+  "height = (int) [ 1, 4096 ] ,"                                               \
+  "framerate = (fraction) [ 0, max ]"
+
+#define VIDEO_SINK_CAPS                                                        \
+  "video/x-raw, "                                                              \
+  "format = (string) " GST_RGA_SINK_FORMATS                                    \
+  ", "                                                                         \
+  "width = (int) [ 1, 8192 ] ,"                                                \
+  "height = (int) [ 1, 8192 ] ,"                                               \
+  "framerate = (fraction) [ 0, max ]"
+
+/* element properties */
+
+typedef enum {
+  GST_RGA_MULTI_SCALE_PROP_0,
+  GST_RGA_MULTI_SCALE_PROP_CORE_MASK,
+  GST_RGA_MULTI_SCALE_PROP_DMA_HEAP,
+  GST_RGA_MULTI_SCALE_PROP_LAST
+} GstRgaMultiScaleProp;
+
+static GParamSpec *rga_props[GST_RGA_MULTI_SCALE_PROP_LAST];
+
+#define DEFAULT_DMA_HEAP "system-uncached"
+
+/* src pads */
+
+G_DEFINE_TYPE(GstRgaMultiScalePad, gst_rga_multi_scale_pad, GST_TYPE_PAD);
+
+static void gst_rga_multi_scale_pad_clear_pool(GstRgaMultiScalePad *pad) {
+  if (!pad->pool) return;
+
+  gst_buffer_pool_set_active(pad->pool, FALSE);
+  gst_clear_object(&pad->pool);
+}
+
+static void gst_rga_multi_scale_pad_dispose(GObject *object) {
+  gst_rga_multi_scale_pad_clear_pool(GST_RGA_MULTI_SCALE_PAD(object));
+
+  G_OBJECT_CLASS(gst_rga_multi_scale_pad_parent_class)->dispose(object);
+}
+
+static void gst_rga_multi_scale_pad_class_init(
+    GstRgaMultiScalePadClass *klass) {
+  G_OBJECT_CLASS(klass)->dispose = gst_rga_multi_scale_pad_dispose;
+}
+
+static void gst_rga_multi_scale_pad_init(GstRgaMultiScalePad *pad) {
+  gst_video_info_init(&pad->info);
+}
+
+/* class initialization */
+
+G_DEFINE_TYPE_WITH_CODE(
+    GstRgaMultiScale, gst_rga_multi_scale, GST_TYPE_ELEMENT,
+    GST_DEBUG_CATEGORY_INIT(gst_rga_multi_scale_debug_category,
+                            "rgamultiscale", 0,
+                            "one input to several RGA outputs"));
+
+static void gst_rga_multi_scale_set_property(GObject *object, guint prop_id,
+                                             const GValue *value,
+                                             GParamSpec *pspec) {
+  GstRgaMultiScale *self = GST_RGA_MULTI_SCALE(object);
+
+  GST_OBJECT_LOCK(self);
+  switch (prop_id) {
+    case GST_RGA_MULTI_SCALE_PROP_CORE_MASK:
+      self->core_mask = g_value_get_flags(value);
+      break;
+    case GST_RGA_MULTI_SCALE_PROP_DMA_HEAP:
+      g_free(self->dma_heap);
+      self->dma_heap = g_value_dup_string(value);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+      break;
+  }
+  GST_OBJECT_UNLOCK(self);
+}
+
+static void gst_rga_multi_scale_get_property(GObject *object, guint prop_id,
+                                             GValue *value, GParamSpec *pspec) {
+  GstRgaMultiScale *self = GST_RGA_MULTI_SCALE(object);
+
+  GST_OBJECT_LOCK(self);
+  switch (prop_id) {
+    case GST_RGA_MULTI_SCALE_PROP_CORE_MASK:
+      g_value_set_flags(value, self->core_mask);
+      break;
+    case GST_RGA_MULTI_SCALE_PROP_DMA_HEAP:
+      g_value_set_string(value, self->dma_heap);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+      break;
+  }
+  GST_OBJECT_UNLOCK(self);
+}
+
+static void gst_rga_multi_scale_finalize(GObject *object) {
+  GstRgaMultiScale *self = GST_RGA_MULTI_SCALE(object);
+
+  gst_flow_combiner_free(self->combiner);
+  g_free(self->dma_heap);
+
+  G_OBJECT_CLASS(gst_rga_multi_scale_parent_class)->finalize(object);
+}
+
+/* negotiation */
+
+/* Prefers the input size, format and framerate, like rgavideoconvert
+ * passing through */
+static GstCaps *gst_rga_multi_scale_fixate(GstRgaMultiScale *self,
+                                           GstCaps *caps) {
+  GstVideoInfo *in_info = &self->in_info;
+
+  caps = gst_caps_make_writable(gst_caps_truncate(caps));
+  GstStructure *s = gst_caps_get_structure(caps, 0);
+
+  gst_structure_fixate_field_nearest_int(s, "width",
+                                         GST_VIDEO_INFO_WIDTH(in_info));
+  gst_structure_fixate_field_nearest_int(s, "height",
+                                         GST_VIDEO_INFO_HEIGHT(in_info));
+  gst_structure_fixate_field_string(
+      s, "format", gst_video_format_to_string(GST_VIDEO_INFO_FORMAT(in_info)));
+  gst_structure_fixate_field_nearest_fraction(s, "framerate",
+                                              GST_VIDEO_INFO_FPS_N(in_info),
+                                              GST_VIDEO_INFO_FPS_D(in_info));
+  if (gst_structure_has_field(s, "pixel-aspect-ratio"))
+    gst_structure_fixate_field_nearest_fraction(s, "pixel-aspect-ratio", 1,
+                                                1);
+  return gst_caps_fixate(caps);
+}
+
+/* Asks downstream of @pad for a pool, dmabuf backed when a dma-heap is
+ * available */
+static gboolean gst_rga_multi_scale_decide_allocation(
+    GstRgaMultiScale *self, GstRgaMultiScalePad *pad, GstCaps *caps) {
+  GstQuery *query = gst_query_new_allocation(caps, TRUE);
+  GstBufferPool *pool = NULL;
+  guint size = 0, min = 0, max = 0;
+
+  gst_rga_multi_scale_pad_clear_pool(pad);
+  if (!gst_pad_peer_query(GST_PAD(pad), query))
+    GST_DEBUG_OBJECT(pad, "allocation query failed");
+
+  GST_OBJECT_LOCK(self);
+  gchar *heap = g_strdup(self->dma_heap);
+  GST_OBJECT_UNLOCK(self);
+  GstAllocator *allocator = gst_rga_create_allocator(GST_OBJECT(self), heap);
+  g_free(heap);
+
+  if (allocator) {
+    if (!gst_rga_decide_allocation(GST_OBJECT(pad), query, allocator, NULL))
+      GST_WARNING_OBJECT(pad, "cannot create a dmabuf pool");
+    gst_object_unref(allocator);
+  } else {
+    GST_WARNING_OBJECT(pad,
+                       "no dma-heap available, output buffers will be "
+                       "mapped by the CPU");
+  }
+
+  if (gst_query_get_n_allocation_pools(query) > 0)
+    gst_query_parse_nth_allocation_pool(query, 0, &pool, &size, &min, &max);
+
+  if (!pool) {
+    GstCaps *plain = gst_rga_caps_to_plain(caps, NULL);
+    GstVideoInfo info;
+    GstStructure *config;
+
+    if (!plain || !gst_video_info_from_caps(&info, plain)) {
+      if (plain) gst_caps_unref(plain);
+      gst_query_unref(query);
+      return FALSE;
+    }
+    pool = gst_video_buffer_pool_new();
+    config = gst_buffer_pool_get_config(pool);
+    gst_buffer_pool_config_set_params(config, plain, info.size, 0, 0);
+    gst_buffer_pool_set_config(pool, config);
+    gst_caps_unref(plain);
+  }
+  gst_query_unref(query);
+
+  if (!gst_buffer_pool_set_active(pool, TRUE)) {
+    GST_WARNING_OBJECT(pad, "failed to activate the output pool");
+    gst_object_unref(pool);
+    return FALSE;
+  }
+  pad->pool = pool;
+  return TRUE;
+}
+
+static gboolean gst_rga_multi_scale_copy_stream_start(GstPad *pad,
+                                                      GstEvent **event,
+                                                      gpointer user_data) {
+  if (GST_EVENT_TYPE(*event) == GST_EVENT_STREAM_START)
+    gst_pad_store_sticky_event(GST_PAD(user_data), *event);
+  return TRUE;
+}
+
+/* Copies the sticky events that must follow the caps, such as the segment.
+ * Each src pad negotiates its own caps. */
+static gboolean gst_rga_multi_scale_copy_sticky(GstPad *pad, GstEvent **event,
+                                                gpointer user_data) {
+  if (GST_EVENT_TYPE(*event) > GST_EVENT_CAPS)
+    gst_pad_store_sticky_event(GST_PAD(user_data), *event);
+  return TRUE;
+}
+
+/* Picks caps for @pad from what downstream accepts and sets up its pool */
+static gboolean gst_rga_multi_scale_negotiate_pad(GstRgaMultiScale *self,
+                                                  GstRgaMultiScalePad *pad) {
+  GstCaps *templ = gst_pad_get_pad_template_caps(GST_PAD(pad));
+  GstCaps *peer = gst_pad_peer_query_caps(GST_PAD(pad), templ);
+
+  gst_caps_unref(templ);
+  pad->negotiated = FALSE;
+  if (gst_caps_is_empty(peer)) {
+    gst_caps_unref(peer);
+    return FALSE;
+  }
+
+  GstCaps *caps = gst_rga_multi_scale_fixate(self, peer);
+  GstCaps *plain = gst_rga_caps_to_plain(caps, &pad->modifier);
+  gboolean ret = plain && gst_video_info_from_caps(&pad->info, plain) &&
+                 gst_gst_format_to_rga_format(GST_VIDEO_INFO_FORMAT(
+                     &pad->info)) != RK_FORMAT_UNKNOWN;
+  if (plain) gst_caps_unref(plain);
+
+  GST_DEBUG_OBJECT(pad, "negotiated %" GST_PTR_FORMAT, caps);
+  if (ret) ret = gst_pad_push_event(GST_PAD(pad), gst_event_new_caps(caps));
+  if (ret)
+    gst_pad_sticky_events_foreach(self->sinkpad,
+                                  gst_rga_multi_scale_copy_sticky, pad);
+  if (ret) ret = gst_rga_multi_scale_decide_allocation(self, pad, caps);
+  gst_caps_unref(caps);
+
+  pad->negotiated = ret;
+  return ret;
+}
+
+/* src pad handling */
+
+/* Answers a caps query with the template of @pad, RGA converts from any
+ * input to any output */
+static gboolean gst_rga_multi_scale_query_caps(GstPad *pad, GstQuery *query) {
+  GstCaps *filter, *caps = gst_pad_get_pad_template_caps(pad);
+
+  gst_query_parse_caps(query, &filter);
+  if (filter) {
+    GstCaps *tmp =
+        gst_caps_intersect_full(filter, caps, GST_CAPS_INTERSECT_FIRST);
+    gst_caps_unref(caps);
+    caps = tmp;
+  }
+  gst_query_set_caps_result(query, caps);
+  gst_caps_unref(caps);
+  return TRUE;
+}
+
+static gboolean gst_rga_multi_scale_src_query(GstPad *pad, GstObject *parent,
+                                              GstQuery *query) {
+  if (GST_QUERY_TYPE(query) == GST_QUERY_CAPS)
+    return gst_rga_multi_scale_query_caps(pad, query);
+  return gst_pad_query_default(pad, parent, query);
+}
+
+static GstPad *gst_rga_multi_scale_request_new_pad(GstElement *element,
+                                                   GstPadTemplate *templ,
+                                                   const gchar *name,
+                                                   const GstCaps *caps) {
+  GstRgaMultiScale *self = GST_RGA_MULTI_SCALE(element);
+
+  GST_OBJECT_LOCK(self);
+  gchar *pad_name = name ? g_strdup(name)
+                         : g_strdup_printf("src_%u", self->next_pad++);
+  GST_OBJECT_UNLOCK(self);
+
+  GstPad *pad = g_object_new(GST_TYPE_RGA_MULTI_SCALE_PAD, "name", pad_name,
+                             "direction", GST_PAD_SRC, "template", templ,
+                             NULL);
+  g_free(pad_name);
+
+  gst_pad_set_query_function(pad,
+                             GST_DEBUG_FUNCPTR(gst_rga_multi_scale_src_query));
+
+  /* a pad added while streaming picks up the stream-start now, and the
+   * segment once its caps are pushed */
+  gst_pad_sticky_events_foreach(self->sinkpad,
+                                gst_rga_multi_scale_copy_stream_start, pad);
+  gst_pad_set_active(pad, TRUE);
+
+  GST_OBJECT_LOCK(self);
+  gst_flow_combiner_add_pad(self->combiner, pad);
+  GST_OBJECT_UNLOCK(self);
+
+  if (!gst_element_add_pad(element, pad)) {
+    GST_OBJECT_LOCK(self);
+    gst_flow_combiner_remove_pad(self->combiner, pad);
+    GST_OBJECT_UNLOCK(self);
+    gst_object_unref(pad);
+    return NULL;
+  }
+  return pad;
+}
+
+static void gst_rga_multi_scale_release_pad(GstElement *element,
+                                            GstPad *pad) {
+  GstRgaMultiScale *self = GST_RGA_MULTI_SCALE(element);
+
+  GST_OBJECT_LOCK(self);
+  gst_flow_combiner_remove_pad(self->combiner, pad);
+  GST_OBJECT_UNLOCK(self);
+
+  gst_pad_set_active(pad, FALSE);
+  gst_element_remove_pad(element, pad);
+}
+
+/* sink pad handling */
+
+static gboolean gst_rga_multi_scale_set_caps(GstRgaMultiScale *self,
+                                             GstCaps *caps) {
+  GstCaps *plain = gst_rga_caps_to_plain(caps, &self->in_modifier);
+
+  self->negotiated = plain && gst_video_info_from_caps(&self->in_info, plain);
+  if (plain) gst_caps_unref(plain);
+  if (!self->negotiated) {
+    GST_WARNING_OBJECT(self, "unsupported caps %" GST_PTR_FORMAT, caps);
+    return FALSE;
+  }
+
+  /* negotiate the linked outputs now so their caps precede the segment */
+  GST_OBJECT_LOCK(self);
+  GList *pads = g_list_copy_deep(GST_ELEMENT(self)->srcpads,
+                                 (GCopyFunc)gst_object_ref, NULL);
+  GST_OBJECT_UNLOCK(self);
+
+  for (GList *l = pads; l; l = l->next) {
+    GstRgaMultiScalePad *pad = GST_RGA_MULTI_SCALE_PAD(l->data);
+
+    pad->negotiated = FALSE;
+    if (gst_pad_is_linked(GST_PAD(pad)) &&
+        !gst_rga_multi_scale_negotiate_pad(self, pad))
+      gst_pad_mark_reconfigure(GST_PAD(pad));
+  }
+  g_list_free_full(pads, gst_object_unref);
+  return TRUE;
+}
+
+static gboolean gst_rga_multi_scale_sink_event(GstPad *pad, GstObject *parent,
+                                               GstEvent *event) {
+  GstRgaMultiScale *self = GST_RGA_MULTI_SCALE(parent);
+
+  switch (GST_EVENT_TYPE(event)) {
+    case GST_EVENT_CAPS: {
+      GstCaps *caps;
+
+      gst_event_parse_caps(event, &caps);
+      gboolean ret = gst_rga_multi_scale_set_caps(self, caps);
+      gst_event_unref(event);
+      return ret;
+    }
+    case GST_EVENT_FLUSH_STOP:
+      GST_OBJECT_LOCK(self);
+      gst_flow_combiner_reset(self->combiner);
+      GST_OBJECT_UNLOCK(self);
+      break;
+    default:
+      break;
+  }
+  return gst_pad_event_default(pad, parent, event);
+}
+
+static gboolean gst_rga_multi_scale_sink_query(GstPad *pad, GstObject *parent,
+                                               GstQuery *query) {
+  GstRgaMultiScale *self = GST_RGA_MULTI_SCALE(parent);
+
+  switch (GST_QUERY_TYPE(query)) {
+    case GST_QUERY_CAPS:
+      return gst_rga_multi_scale_query_caps(pad, query);
+    case GST_QUERY_ALLOCATION: {
+      GST_OBJECT_LOCK(self);
+      gchar *heap = g_strdup(self->dma_heap);
+      GST_OBJECT_UNLOCK(self);
+      GstAllocator *allocator =
+          gst_rga_create_allocator(GST_OBJECT(self), heap);
+      g_free(heap);
+
+      gst_rga_propose_allocation(GST_OBJECT(self), query, allocator);
+      if (allocator) gst_object_unref(allocator);
+      gst_query_add_allocation_meta(query, GST_VIDEO_META_API_TYPE, NULL);
+      return TRUE;
+    }
+    default:
+      return gst_pad_query_default(pad, parent, query);
+  }
+}
+
+/* One output of the current frame */
+typedef struct {
+  GstRgaMultiScalePad *pad;
+  GstBuffer *buffer;
+  GstVideoFrame frame;
+  GstMapInfo map;
+  rga_buffer_t info;
+  im_rect rect;
+  GstFlowReturn ret;
+} GstRgaOutput;
+
+static void gst_rga_output_clear(GstRgaOutput *out) {
+  if (out->map.memory) gst_buffer_unmap(out->buffer, &out->map);
+  if (out->buffer) gst_buffer_unref(out->buffer);
+  gst_object_unref(out->pad);
+}
+
+/* Negotiates the pads that need it and takes an output buffer for every
+ * linked pad */
+static GArray *gst_rga_multi_scale_prepare_outputs(GstRgaMultiScale *self,
+                                                   GstBuffer *inbuf) {
+  GArray *outputs = g_array_new(FALSE, TRUE, sizeof(GstRgaOutput));
+  g_array_set_clear_func(outputs, (GDestroyNotify)gst_rga_output_clear);
+
+  GST_OBJECT_LOCK(self);
+  for (GList *l = GST_ELEMENT(self)->srcpads; l; l = l->next) {
+    GstRgaOutput out = {
+        0,
+    };
+
+    out.pad = gst_object_ref(l->data);
+    g_array_append_val(outputs, out);
+  }
+  GST_OBJECT_UNLOCK(self);
+
+  for (guint i = 0; i < outputs->len; i++) {
+    GstRgaOutput *out = &g_array_index(outputs, GstRgaOutput, i);
+    GstPad *pad = GST_PAD(out->pad);
+
+    out->ret = GST_FLOW_NOT_LINKED;
+    if (!gst_pad_is_linked(pad)) continue;
+
+    if ((gst_pad_check_reconfigure(pad) || !out->pad->negotiated) &&
+        !gst_rga_multi_scale_negotiate_pad(self, out->pad)) {
+      gst_pad_mark_reconfigure(pad);
+      out->ret = gst_pad_is_flushing(pad) ? GST_FLOW_FLUSHING
+                                          : GST_FLOW_NOT_NEGOTIATED;
+      continue;
+    }
+
+    out->ret =
+        gst_buffer_pool_acquire_buffer(out->pad->pool, &out->buffer, NULL);
+    if (out->ret != GST_FLOW_OK) continue;
+
+    if (!gst_rga_video_frame_init(GST_OBJECT(pad), &out->frame,
+                                  &out->pad->info, out->buffer,
+                                  out->pad->modifier) ||
+        !gst_rga_info_from_video_frame(
+            GST_OBJECT(pad), &out->info, &out->rect, &out->frame,
+            out->pad->modifier, &out->map, GST_MAP_WRITE, NULL, NULL)) {
+      out->ret = GST_FLOW_ERROR;
+      continue;
+    }
+    gst_buffer_copy_into(out->buffer, inbuf,
+                         GST_BUFFER_COPY_FLAGS | GST_BUFFER_COPY_TIMESTAMPS,
+                         0, -1);
+  }
+  return outputs;
+}
+
+/* Converts @inbuf into all @outputs that have a buffer, in one job */
+static gboolean gst_rga_multi_scale_process(GstRgaMultiScale *self,
+                                            GstBuffer *inbuf,
+                                            GArray *outputs) {
+  GstVideoFrame inframe;
+  GstMapInfo in_map = {
+      0,
+  };
+  rga_buffer_t src_info = {
+      0,
+  };
+  rga_buffer_t none = {
+      0,
+  };
+  im_rect src_rect;
+  im_rect none_rect = {
+      0,
+  };
+  im_opt_t opt = {
+      0,
+  };
+
+  if (!gst_rga_video_frame_init(GST_OBJECT(self), &inframe, &self->in_info,
+                                inbuf, self->in_modifier) ||
+      !gst_rga_info_from_video_frame(GST_OBJECT(self), &src_info, &src_rect,
+                                     &inframe, self->in_modifier, &in_map,
+                                     GST_MAP_READ, NULL, NULL))
+    return FALSE;
+
+  GST_OBJECT_LOCK(self);
+  guint32 core_mask = self->core_mask;
+  GST_OBJECT_UNLOCK(self);
+
+  gboolean afbc = src_info.rd_mode == IM_FBC_MODE;
+  gboolean dma32 = gst_rga_buffer_is_dma32(inbuf);
+  guint n_blits = 0;
+  for (guint i = 0; i < outputs->len; i++) {
+    GstRgaOutput *out = &g_array_index(outputs, GstRgaOutput, i);
+
+    if (out->ret != GST_FLOW_OK) continue;
+    afbc |= out->info.rd_mode == IM_FBC_MODE;
+    dma32 = dma32 && gst_rga_buffer_is_dma32(out->buffer);
+    n_blits++;
+  }
+
+  /* only RGA3 handles AFBC */
+  if (afbc) {
+    const guint32 rga3 = IM_SCHEDULER_RGA3_CORE0 | IM_SCHEDULER_RGA3_CORE1;
+
+    core_mask = (core_mask ? core_mask : rga3) & rga3;
+    if (!core_mask) {
+      GST_WARNING_OBJECT(self, "AFBC needs RGA3 but core-mask excludes it");
+      if (in_map.memory) gst_buffer_unmap(inbuf, &in_map);
+      return FALSE;
+    }
+  }
+
+  IM_STATUS status = IM_STATUS_SUCCESS;
+  if (n_blits > 0) {
+    /* RGA2 only reaches the low 4 GB, keep other buffers on RGA3 */
+    gboolean allow_rga2 =
+        !gst_rga_scheduler_has_high_memory(self->scheduler) || dma32;
+    opt.core =
+        gst_rga_scheduler_acquire(self->scheduler, core_mask, allow_rga2);
+
+    /* the input is imported once and read by every task of the job */
+    im_job_handle_t job = imbeginJob(0);
+    if (!job) status = IM_STATUS_FAILED;
+
+    for (guint i = 0; i < outputs->len && status == IM_STATUS_SUCCESS; i++) {
+      GstRgaOutput *out = &g_array_index(outputs, GstRgaOutput, i);
+
+      if (out->ret != GST_FLOW_OK) continue;
+      status = improcessTask(job, src_info, out->info, none, src_rect,
+                             out->rect, none_rect, &opt, 0);
+    }
+
+    if (status == IM_STATUS_SUCCESS)
+      status = imendJob(job, IM_SYNC, -1, NULL);
+    else if (job)
+      imcancelJob(job);
+    gst_rga_scheduler_release(self->scheduler, opt.core);
+  }
+
+  if (in_map.memory) gst_buffer_unmap(inbuf, &in_map);
+  if (status != IM_STATUS_SUCCESS) {
+    GST_WARNING_OBJECT(self, "failed to convert: %s", imStrError_t(status));
+    return FALSE;
+  }
+  return TRUE;
+}
+
+static GstFlowReturn gst_rga_multi_scale_chain(GstPad *pad, GstObject *parent,
+                                               GstBuffer *inbuf) {
+  GstRgaMultiScale *self = GST_RGA_MULTI_SCALE(parent);
+  GstFlowReturn ret = GST_FLOW_OK;
+
+  if (!self->negotiated) {
+    GST_ELEMENT_ERROR(self, CORE, NEGOTIATION, (NULL), ("no input caps"));
+    gst_buffer_unref(inbuf);
+    return GST_FLOW_NOT_NEGOTIATED;
+  }
+
+  GArray *outputs = gst_rga_multi_scale_prepare_outputs(self, inbuf);
+  gboolean done = gst_rga_multi_scale_process(self, inbuf, outputs);
+  gst_buffer_unref(inbuf);
+
+  if (!done) {
+    GST_ELEMENT_ERROR(self, LIBRARY, FAILED, (NULL),
+                      ("failed to convert the frame"));
+    g_array_unref(outputs);
+    return GST_FLOW_ERROR;
+  }
+
+  for (guint i = 0; i < outputs->len; i++) {
+    GstRgaOutput *out = &g_array_index(outputs, GstRgaOutput, i);
+
+    if (out->ret == GST_FLOW_OK) {
+      GstBuffer *outbuf = out->buffer;
+
+      if (out->map.memory) gst_buffer_unmap(outbuf, &out->map);
+      out->map.memory = NULL;
+      out->buffer = NULL;
+      out->ret = gst_pad_push(GST_PAD(out->pad), outbuf);
+    }
+
+    GST_OBJECT_LOCK(self);
+    ret = gst_flow_combiner_update_pad_flow(self->combiner,
+                                            GST_PAD(out->pad), out->ret);
+    GST_OBJECT_UNLOCK(self);
+  }
+
+  /* no src pad at all */
+  if (outputs->len == 0) ret = GST_FLOW_NOT_LINKED;
+  g_array_unref(outputs);
+  return ret;
+}
+
+static GstStateChangeReturn gst_rga_multi_scale_change_state(
+    GstElement *element, GstStateChange transition) {
+  GstRgaMultiScale *self = GST_RGA_MULTI_SCALE(element);
+  GstStateChangeReturn ret;
+
+  if (transition == GST_STATE_CHANGE_NULL_TO_READY) {
+    self->device = gst_rga_device_ref();
+    self->scheduler = gst_rga_device_get_scheduler(self->device);
+  } else if (transition == GST_STATE_CHANGE_READY_TO_PAUSED) {
+    GST_OBJECT_LOCK(self);
+    gst_flow_combiner_reset(self->combiner);
+    GST_OBJECT_UNLOCK(self);
+  }
+
+  ret = GST_ELEMENT_CLASS(gst_rga_multi_scale_parent_class)
+            ->change_state(element, transition);
+  if (ret == GST_STATE_CHANGE_FAILURE) return ret;
+
+  if (transition == GST_STATE_CHANGE_PAUSED_TO_READY) {
+    self->negotiated = FALSE;
+    GST_OBJECT_LOCK(self);
+    for (GList *l = element->srcpads; l; l = l->next) {
+      GstRgaMultiScalePad *pad = GST_RGA_MULTI_SCALE_PAD(l->data);
+
+      pad->negotiated = FALSE;
+      gst_rga_multi_scale_pad_clear_pool(pad);
+    }
+    GST_OBJECT_UNLOCK(self);
+  } else if (transition == GST_STATE_CHANGE_READY_TO_NULL) {
+    self->scheduler = NULL;
+    gst_rga_device_unref(self->device);
+    self->device = NULL;
+  }
+  return ret;
+}
+
+static void gst_rga_multi_scale_class_init(GstRgaMultiScaleClass *klass) {
+  GObjectClass *gobject_class = G_OBJECT_CLASS(klass);
+  GstElementClass *element_class = GST_ELEMENT_CLASS(klass);
+
+  gst_element_class_add_pad_template(
+      element_class,
+      gst_pad_template_new_with_gtype("src_%u", GST_PAD_SRC, GST_PAD_REQUEST,
+                                      gst_rga_template_caps(VIDEO_SRC_CAPS),
+                                      GST_TYPE_RGA_MULTI_SCALE_PAD));
+  gst_element_class_add_pad_template(
+      element_class,
+      gst_pad_template_new("sink", GST_PAD_SINK, GST_PAD_ALWAYS,
+                           gst_rga_template_caps(VIDEO_SINK_CAPS)));
+
+  gst_element_class_set_static_metadata(
+      element_class, "RgaMultiScale Plugin", "Filter/Converter/Video",
+      "Converts one video stream to several formats and sizes in one "
+      "Rockchip RGA job",
+      "http://github.com/corenel/gstreamer-rga");
+
+  /* element properties */
+  rga_props[GST_RGA_MULTI_SCALE_PROP_CORE_MASK] = g_param_spec_flags(
+      "core-mask", "Core mask", "Select which RGA core(s) to use (bit-mask)",
+      gst_rga_core_mask_get_type(), IM_SCHEDULER_DEFAULT,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
+  rga_props[GST_RGA_MULTI_SCALE_PROP_DMA_HEAP] = g_param_spec_string(
+      "dma-heap", "DMA heap",
+      "dma-heap (under /dev/dma_heap) to allocate output buffers from, falls "
+      "back to \"" GST_RGA_ALLOCATOR_FALLBACK_HEAP "\" if missing",
+      DEFAULT_DMA_HEAP,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_MUTABLE_READY);
+
+  gobject_class->set_property = gst_rga_multi_scale_set_property;
+  gobject_class->get_property = gst_rga_multi_scale_get_property;
+  gobject_class->finalize = gst_rga_multi_scale_finalize;
+  g_object_class_install_properties(gobject_class,
+                                    GST_RGA_MULTI_SCALE_PROP_LAST, rga_props);
+
+  element_class->request_new_pad =
+      GST_DEBUG_FUNCPTR(gst_rga_multi_scale_request_new_pad);
+  element_class->release_pad =
+      GST_DEBUG_FUNCPTR(gst_rga_multi_scale_release_pad);
+  element_class->change_state =
+      GST_DEBUG_FUNCPTR(gst_rga_multi_scale_change_state);
+}
+
+static void gst_rga_multi_scale_init(GstRgaMultiScale *self) {
+  self->sinkpad = gst_pad_new_from_template(
+      gst_element_class_get_pad_template(GST_ELEMENT_GET_CLASS(self), "sink"),
+      "sink");
+  gst_pad_set_chain_function(self->sinkpad,
+                             GST_DEBUG_FUNCPTR(gst_rga_multi_scale_chain));
+  gst_pad_set_event_function(
+      self->sinkpad, GST_DEBUG_FUNCPTR(gst_rga_multi_scale_sink_event));
+  gst_pad_set_query_function(
+      self->sinkpad, GST_DEBUG_FUNCPTR(gst_rga_multi_scale_sink_query));
+  gst_element_add_pad(GST_ELEMENT(self), self->sinkpad);
+
+  self->core_mask = IM_SCHEDULER_DEFAULT;
+  self->dma_heap = g_strdup(DEFAULT_DMA_HEAP);
+  self->combiner = gst_flow_combiner_new();
+  gst_video_info_init(&self->in_info);
+}
@@ -0,0 +1,91 @@
+/* GStreamer
+ * Copyright (C) 2025 FIXME <fixme@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Suite 500,
+ * Boston, MA 02110-1335, USA.
+ */
+
+#ifndef PLUGINS_GSTRGAMULTISCALE_H_
+#define PLUGINS_GSTRGAMULTISCALE_H_
+
+#include <gst/base/gstflowcombiner.h>
+#include <gst/gst.h>
+#include <gst/video/video.h>
+
+#include "gstrgadevice.h"  // NOLINT
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_RGA_MULTI_SCALE_PAD (gst_rga_multi_scale_pad_get_type())
+#define GST_RGA_MULTI_SCALE_PAD(obj)                               \
+  (G_TYPE_CHECK_INSTANCE_CAST((obj), GST_TYPE_RGA_MULTI_SCALE_PAD, \
+                              GstRgaMultiScalePad))
+
+#define GST_TYPE_RGA_MULTI_SCALE (gst_rga_multi_scale_get_type())
+#define GST_RGA_MULTI_SCALE(obj)                               \
+  (G_TYPE_CHECK_INSTANCE_CAST((obj), GST_TYPE_RGA_MULTI_SCALE, \
+                              GstRgaMultiScale))
+#define GST_IS_RGA_MULTI_SCALE(obj) \
+  (G_TYPE_CHECK_INSTANCE_TYPE((obj), GST_TYPE_RGA_MULTI_SCALE))
+
+typedef struct _GstRgaMultiScalePad GstRgaMultiScalePad;
+typedef struct _GstRgaMultiScalePadClass GstRgaMultiScalePadClass;
+typedef struct _GstRgaMultiScale GstRgaMultiScale;
+typedef struct _GstRgaMultiScaleClass GstRgaMultiScaleClass;
+
+/* A src pad with its own caps and output pool, only touched from the
+ * streaming thread */
+struct _GstRgaMultiScalePad {
+  GstPad parent;
+  gboolean negotiated;
+  GstVideoInfo info;
+  guint64 modifier;
+  GstBufferPool *pool;
+};
+
+struct _GstRgaMultiScalePadClass {
+  GstPadClass parent_class;
+};
+
+struct _GstRgaMultiScale {
+  GstElement parent;
+  GstPad *sinkpad;
+
+  /* protected by the object lock */
+  guint32 core_mask;
+  gchar *dma_heap;
+  guint next_pad;
+
+  GstRgaDevice *device;
+  /* owned by device */
+  GstRgaScheduler *scheduler;
+
+  /* streaming thread */
+  gboolean negotiated;
+  GstVideoInfo in_info;
+  guint64 in_modifier;
+  GstFlowCombiner *combiner;
+};
+
+struct _GstRgaMultiScaleClass {
+  GstElementClass parent_class;
+};
+
+GType gst_rga_multi_scale_pad_get_type(void);
+GType gst_rga_multi_scale_get_type(void);
+
+G_END_DECLS
+
+#endif  // PLUGINS_GSTRGAMULTISCALE_H_
@@ -0,0 +1,654 @@
+/* GStreamer
+ * Copyright (C) 2025 FIXME <fixme@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Suite 500,
+ * Boston, MA 02110-1335, USA.
+ */
+/**
+ * SECTION:element-gstrgaoverlay
+ *
+ * The rgaoverlay element draws the GstVideoOverlayCompositionMeta of each
+ * frame with Rockchip RGA. It accepts the meta in its caps and allocation
+ * query, so textoverlay, timeoverlay and the subtitle renderers attach
+ * their rectangles instead of blending them on the CPU. Every rectangle is
+ * copied once into a dmabuf imported by RGA and reused for as long as
+ * upstream sends the same rectangle. All rectangles of a frame are alpha
+ * blended onto it in place as one job, then the meta is removed. A
+ * composition RGA cannot import or blend is drawn on the CPU instead, since
+ * downstream does not see the meta.
+ *
+ * <refsect2>
+ * <title>Example launch line</title>
+ * |[
+ * gst-launch-1.0 v4l2src ! video/x-raw,format=NV12 ! timeoverlay !
+ * rgaoverlay ! kmssink
+ * ]|
+ * </refsect2>
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"  // NOLINT
+#endif
+
+#include <gst/gst.h>
+#include <gst/video/gstvideofilter.h>
+#include <gst/video/video.h>
+
+#include "gstrgaallocator.h"  // NOLINT
+#include "gstrgaoverlay.h"    // NOLINT
+#include "gstrgautils.h"      // NOLINT
+
+GST_DEBUG_CATEGORY_STATIC(gst_rga_overlay_debug_category);
+#define GST_CAT_DEFAULT gst_rga_overlay_debug_category
+
+/* prototypes */
+
+static gboolean gst_rga_overlay_start(GstBaseTransform *trans);
+static gboolean gst_rga_overlay_stop(GstBaseTransform *trans);
+static GstCaps *gst_rga_overlay_transform_caps(GstBaseTransform *trans,
+                                               GstPadDirection direction,
+                                               GstCaps *caps, GstCaps *filter);
+static gboolean gst_rga_overlay_propose_allocation(GstBaseTransform *trans,
+                                                   GstQuery *decide_query,
+                                                   GstQuery *query);
+static gboolean gst_rga_overlay_set_info(GstVideoFilter *filter,
+                                         GstCaps *incaps,
+                                         GstVideoInfo *in_info,
+                                         GstCaps *outcaps,
+                                         GstVideoInfo *out_info);
+static GstFlowReturn gst_rga_overlay_prepare_output_buffer(
+    GstBaseTransform *trans, GstBuffer *input, GstBuffer **outbuf);
+static GstFlowReturn gst_rga_overlay_transform_ip(GstBaseTransform *trans,
+                                                  GstBuffer *buf);
+
+/* pad templates */
+
+/* RGA writes the blended rectangles into the frame, which is addressed by
+ * rectangle and so must be linear. dmabuf backed buffers are still
+ * imported by fd. */
+#define VIDEO_CAPS_FIELDS                                                      \
+  "format = (string) " GST_RGA_SRC_FORMATS                                     \
+  ", "                                                                         \
+  "width = (int) [ 1, 4096 ] ,"                                                \
+  "height = (int) [ 1, 4096 ] ,"                                               \
+  "framerate = (fraction) [ 0, max ]"
+
+#define VIDEO_SRC_CAPS "video/x-raw, " VIDEO_CAPS_FIELDS
+
+#define VIDEO_SINK_CAPS                                                        \
+  "video/x-raw(" GST_CAPS_FEATURE_MEMORY_SYSTEM_MEMORY                         \
+  ", " GST_CAPS_FEATURE_META_GST_VIDEO_OVERLAY_COMPOSITION                     \
+  "), " VIDEO_CAPS_FIELDS "; " VIDEO_SRC_CAPS
+
+static GstStaticPadTemplate src_template = GST_STATIC_PAD_TEMPLATE(
+    "src", GST_PAD_SRC, GST_PAD_ALWAYS, GST_STATIC_CAPS(VIDEO_SRC_CAPS));
+
+static GstStaticPadTemplate sink_template = GST_STATIC_PAD_TEMPLATE(
+    "sink", GST_PAD_SINK, GST_PAD_ALWAYS, GST_STATIC_CAPS(VIDEO_SINK_CAPS));
+
+/* element properties */
+
+typedef enum {
+  GST_RGA_OVERLAY_PROP_0,
+  GST_RGA_OVERLAY_PROP_CORE_MASK,
+  GST_RGA_OVERLAY_PROP_DMA_HEAP,
+  GST_RGA_OVERLAY_PROP_LAST
+} GstRgaOverlayProp;
+
+static GParamSpec *rga_overlay_props[GST_RGA_OVERLAY_PROP_LAST];
+
+#define DEFAULT_DMA_HEAP "system-uncached"
+
+/* class initialization */
+
+G_DEFINE_TYPE_WITH_CODE(
+    GstRgaOverlay, gst_rga_overlay, GST_TYPE_VIDEO_FILTER,
+    GST_DEBUG_CATEGORY_INIT(gst_rga_overlay_debug_category, "rgaoverlay", 0,
+                            "overlay composition blending"));
+
+static void gst_rga_overlay_set_property(GObject *object, guint prop_id,
+                                         const GValue *value,
+                                         GParamSpec *pspec);
+
+static void gst_rga_overlay_get_property(GObject *object, guint prop_id,
+                                         GValue *value, GParamSpec *pspec);
+
+static void gst_rga_overlay_finalize(GObject *object);
+
+static void gst_rga_overlay_class_init(GstRgaOverlayClass *klass) {
+  GObjectClass *gobject_class = G_OBJECT_CLASS(klass);
+  GstElementClass *element_class = GST_ELEMENT_CLASS(klass);
+  GstBaseTransformClass *base_transform_class = GST_BASE_TRANSFORM_CLASS(klass);
+  GstVideoFilterClass *video_filter_class = GST_VIDEO_FILTER_CLASS(klass);
+
+  gst_element_class_add_static_pad_template(element_class, &src_template);
+  gst_element_class_add_static_pad_template(element_class, &sink_template);
+
+  gst_element_class_set_static_metadata(
+      element_class, "RgaOverlay Plugin", "Filter/Effect/Video",
+      "Blends overlay compositions onto video via Rockchip RGA",
+      "http://github.com/corenel/gstreamer-rga");
+
+  /* element properties */
+  rga_overlay_props[GST_RGA_OVERLAY_PROP_CORE_MASK] = g_param_spec_flags(
+      "core-mask", "Core mask", "Select which RGA core(s) to use (bit-mask)",
+      gst_rga_core_mask_get_type(), IM_SCHEDULER_DEFAULT,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
+  rga_overlay_props[GST_RGA_OVERLAY_PROP_DMA_HEAP] = g_param_spec_string(
+      "dma-heap", "DMA heap",
+      "dma-heap (under /dev/dma_heap) to copy the overlay rectangles to, "
+      "falls back to \"" GST_RGA_ALLOCATOR_FALLBACK_HEAP "\" if missing",
+      DEFAULT_DMA_HEAP,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_MUTABLE_READY);
+
+  gobject_class->set_property = gst_rga_overlay_set_property;
+  gobject_class->get_property = gst_rga_overlay_get_property;
+  gobject_class->finalize = gst_rga_overlay_finalize;
+  g_object_class_install_properties(gobject_class, GST_RGA_OVERLAY_PROP_LAST,
+                                    rga_overlay_props);
+
+  /* a frame may carry a composition even when the caps match */
+  base_transform_class->passthrough_on_same_caps = FALSE;
+
+  base_transform_class->transform_caps =
+      GST_DEBUG_FUNCPTR(gst_rga_overlay_transform_caps);
+  base_transform_class->propose_allocation =
+      GST_DEBUG_FUNCPTR(gst_rga_overlay_propose_allocation);
+  base_transform_class->prepare_output_buffer =
+      GST_DEBUG_FUNCPTR(gst_rga_overlay_prepare_output_buffer);
+
+  base_transform_class->start = GST_DEBUG_FUNCPTR(gst_rga_overlay_start);
+  base_transform_class->stop = GST_DEBUG_FUNCPTR(gst_rga_overlay_stop);
+  video_filter_class->set_info = GST_DEBUG_FUNCPTR(gst_rga_overlay_set_info);
+  /* RGA writes the buffer by fd, skip the CPU mapping of
+   * transform_frame_ip */
+  base_transform_class->transform_ip =
+      GST_DEBUG_FUNCPTR(gst_rga_overlay_transform_ip);
+}
+
+static void gst_rga_overlay_init(GstRgaOverlay *overlay) {
+  overlay->core_mask = IM_SCHEDULER_DEFAULT;
+  overlay->dma_heap = g_strdup(DEFAULT_DMA_HEAP);
+
+  gst_base_transform_set_in_place(GST_BASE_TRANSFORM(overlay), TRUE);
+}
+
+static void gst_rga_overlay_finalize(GObject *object) {
+  GstRgaOverlay *overlay = GST_RGA_OVERLAY(object);
+
+  g_free(overlay->dma_heap);
+
+  G_OBJECT_CLASS(gst_rga_overlay_parent_class)->finalize(object);
+}
+
+static void gst_rga_overlay_set_property(GObject *object, guint prop_id,
+                                         const GValue *value,
+                                         GParamSpec *pspec) {
+  GstRgaOverlay *overlay = GST_RGA_OVERLAY(object);
+
+  GST_OBJECT_LOCK(overlay);
+  switch (prop_id) {
+    case GST_RGA_OVERLAY_PROP_CORE_MASK:
+      overlay->core_mask = g_value_get_flags(value);
+      break;
+    case GST_RGA_OVERLAY_PROP_DMA_HEAP:
+      g_free(overlay->dma_heap);
+      overlay->dma_heap = g_value_dup_string(value);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+      break;
+  }
+  GST_OBJECT_UNLOCK(overlay);
+}
+
+static void gst_rga_overlay_get_property(GObject *object, guint prop_id,
+                                         GValue *value, GParamSpec *pspec) {
+  GstRgaOverlay *overlay = GST_RGA_OVERLAY(object);
+
+  GST_OBJECT_LOCK(overlay);
+  switch (prop_id) {
+    case GST_RGA_OVERLAY_PROP_CORE_MASK:
+      g_value_set_flags(value, overlay->core_mask);
+      break;
+    case GST_RGA_OVERLAY_PROP_DMA_HEAP:
+      g_value_set_string(value, overlay->dma_heap);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+      break;
+  }
+  GST_OBJECT_UNLOCK(overlay);
+}
+
+/* The sink pad takes the caps of the src pad with and without the overlay
+ * composition feature, the src pad never has it */
+static GstCaps *gst_rga_overlay_transform_caps(GstBaseTransform *trans,
+                                               GstPadDirection direction,
+                                               GstCaps *caps,
+                                               GstCaps *filter) {
+  GstCaps *ret = gst_caps_new_empty();
+
+  for (guint i = 0; i < gst_caps_get_size(caps); i++) {
+    GstStructure *structure = gst_caps_get_structure(caps, i);
+    GstCapsFeatures *features = gst_caps_get_features(caps, i);
+
+    if (gst_caps_features_is_any(features)) {
+      ret = gst_caps_merge_structure_full(ret, gst_structure_copy(structure),
+                                          gst_caps_features_copy(features));
+      continue;
+    }
+
+    GstCapsFeatures *plain = gst_caps_features_copy(features);
+    gst_caps_features_remove(
+        plain, GST_CAPS_FEATURE_META_GST_VIDEO_OVERLAY_COMPOSITION);
+
+    if (direction == GST_PAD_SRC) {
+      GstCapsFeatures *overlay = gst_caps_features_copy(plain);
+
+      gst_caps_features_add(
+          overlay, GST_CAPS_FEATURE_META_GST_VIDEO_OVERLAY_COMPOSITION);
+      ret = gst_caps_merge_structure_full(ret, gst_structure_copy(structure),
+                                          overlay);
+    }
+    ret = gst_caps_merge_structure_full(ret, gst_structure_copy(structure),
+                                        plain);
+  }
+
+  if (filter) {
+    GstCaps *intersection =
+        gst_caps_intersect_full(filter, ret, GST_CAPS_INTERSECT_FIRST);
+    gst_caps_unref(ret);
+    ret = intersection;
+  }
+
+  GST_DEBUG_OBJECT(trans, "transformed %" GST_PTR_FORMAT " to %" GST_PTR_FORMAT,
+                   caps, ret);
+  return ret;
+}
+
+/* allocation */
+
+static gboolean gst_rga_overlay_propose_allocation(GstBaseTransform *trans,
+                                                   GstQuery *decide_query,
+                                                   GstQuery *query) {
+  GstRgaOverlay *overlay = GST_RGA_OVERLAY(trans);
+  GstCaps *caps;
+
+  gst_query_parse_allocation(query, &caps, NULL);
+  if (!caps) return FALSE;
+
+  /* the frames go on in place, so keep what downstream supports */
+  if (decide_query)
+    GST_BASE_TRANSFORM_CLASS(gst_rga_overlay_parent_class)
+        ->propose_allocation(trans, decide_query, query);
+
+  gst_rga_propose_allocation(GST_OBJECT(trans), query, overlay->allocator);
+
+  gst_query_add_allocation_meta(query, GST_VIDEO_META_API_TYPE, NULL);
+  gst_query_add_allocation_meta(
+      query, GST_VIDEO_OVERLAY_COMPOSITION_META_API_TYPE, NULL);
+  return TRUE;
+}
+
+/* overlay images */
+
+/* A rectangle of a composition copied where RGA reads it, by handle when
+ * the copy is a dmabuf */
+typedef struct {
+  GstBuffer *buffer;
+  GstMapInfo map;
+  rga_buffer_t info;
+  im_rect rect;
+  /* the last frame that showed it */
+  guint64 frame;
+} GstRgaOverlayImage;
+
+static void gst_rga_overlay_image_free(GstRgaOverlayImage *image) {
+  if (image->map.memory) gst_buffer_unmap(image->buffer, &image->map);
+  gst_buffer_unref(image->buffer);
+  g_free(image);
+}
+
+/* Copies the unscaled ARGB pixels of @rectangle into a buffer from the
+ * allocator, padded to the RGA stride alignment. They are premultiplied,
+ * as IM_ALPHA_BLEND_SRC_OVER expects. */
+static GstRgaOverlayImage *gst_rga_overlay_image_new(
+    GstRgaOverlay *overlay, GstVideoOverlayRectangle *rectangle) {
+  GstBuffer *pixels = gst_video_overlay_rectangle_get_pixels_unscaled_argb(
+      rectangle, GST_VIDEO_OVERLAY_FORMAT_FLAG_PREMULTIPLIED);
+  GstVideoMeta *meta = pixels ? gst_buffer_get_video_meta(pixels) : NULL;
+  GstVideoInfo pixels_info, info;
+  GstVideoAlignment align;
+  GstVideoFrame src, dst, frame;
+  gboolean copied = FALSE;
+
+  if (!meta) return NULL;
+
+  gst_video_info_set_format(&pixels_info, meta->format, meta->width,
+                            meta->height);
+  info = pixels_info;
+  gst_video_alignment_reset(&align);
+  align.padding_right =
+      GST_ROUND_UP_N(meta->width, GST_RGA_WIDTH_ALIGN) - meta->width;
+  if (!gst_video_info_align(&info, &align)) return NULL;
+
+  /* without a dma-heap the copy is in system memory, mapped for RGA */
+  GstMemory *memory = gst_allocator_alloc(overlay->allocator,
+                                          GST_VIDEO_INFO_SIZE(&info), NULL);
+  if (!memory) return NULL;
+  GstBuffer *buffer = gst_buffer_new();
+  gst_buffer_append_memory(buffer, memory);
+
+  if (gst_video_frame_map(&src, &pixels_info, pixels, GST_MAP_READ)) {
+    if (gst_video_frame_map(&dst, &info, buffer, GST_MAP_WRITE)) {
+      copied = gst_video_frame_copy(&dst, &src);
+      gst_video_frame_unmap(&dst);
+    }
+    gst_video_frame_unmap(&src);
+  }
+
+  GstRgaOverlayImage *image = g_new0(GstRgaOverlayImage, 1);
+  image->buffer = buffer;
+  if (!copied ||
+      !gst_rga_video_frame_init(GST_OBJECT(overlay), &frame, &info, buffer,
+                                DRM_FORMAT_MOD_LINEAR) ||
+      !gst_rga_info_from_video_frame(GST_OBJECT(overlay), &image->info,
+                                     &image->rect, &frame,
+                                     DRM_FORMAT_MOD_LINEAR, &image->map,
+                                     GST_MAP_READ, NULL, NULL)) {
+    gst_rga_overlay_image_free(image);
+    return NULL;
+  }
+  return image;
+}
+
+/* The RGA image of @rectangle, imported the first time it is seen.
+ * Rectangles keep their seqnum until their pixels change. */
+static GstRgaOverlayImage *gst_rga_overlay_lookup(
+    GstRgaOverlay *overlay, GstVideoOverlayRectangle *rectangle) {
+  guint seqnum = gst_video_overlay_rectangle_get_seqnum(rectangle);
+  GstRgaOverlayImage *image =
+      g_hash_table_lookup(overlay->images, GUINT_TO_POINTER(seqnum));
+
+  if (!image) {
+    image = gst_rga_overlay_image_new(overlay, rectangle);
+    if (!image) {
+      GST_WARNING_OBJECT(overlay, "cannot import overlay rectangle %u",
+                         seqnum);
+      return NULL;
+    }
+    GST_LOG_OBJECT(overlay, "imported overlay rectangle %u, %dx%d", seqnum,
+                   image->rect.width, image->rect.height);
+    g_hash_table_insert(overlay->images, GUINT_TO_POINTER(seqnum), image);
+  }
+  image->frame = overlay->frames;
+  return image;
+}
+
+static gboolean gst_rga_overlay_image_is_stale(gpointer key, gpointer value,
+                                               gpointer user_data) {
+  GstRgaOverlayImage *image = value;
+
+  return image->frame != *(guint64 *)user_data;
+}
+
+static gboolean gst_rga_overlay_start(GstBaseTransform *trans) {
+  GstRgaOverlay *overlay = GST_RGA_OVERLAY(trans);
+
+  overlay->device = gst_rga_device_ref();
+  overlay->scheduler = gst_rga_device_get_scheduler(overlay->device);
+  overlay->allocator =
+      gst_rga_create_allocator(GST_OBJECT(trans), overlay->dma_heap);
+  if (!overlay->allocator)
+    GST_WARNING_OBJECT(overlay,
+                       "no dma-heap available, overlay rectangles will be "
+                       "mapped by the CPU");
+  overlay->images = g_hash_table_new_full(
+      NULL, NULL, NULL, (GDestroyNotify)gst_rga_overlay_image_free);
+  overlay->frames = 0;
+  return TRUE;
+}
+
+static gboolean gst_rga_overlay_stop(GstBaseTransform *trans) {
+  GstRgaOverlay *overlay = GST_RGA_OVERLAY(trans);
+
+  g_clear_pointer(&overlay->images, g_hash_table_unref);
+  gst_clear_object(&overlay->allocator);
+  overlay->scheduler = NULL;
+  gst_rga_device_unref(overlay->device);
+  overlay->device = NULL;
+  return TRUE;
+}
+
+static gboolean gst_rga_overlay_set_info(GstVideoFilter *filter,
+                                         GstCaps *incaps,
+                                         GstVideoInfo *in_info,
+                                         GstCaps *outcaps,
+                                         GstVideoInfo *out_info) {
+  return gst_gst_format_to_rga_format(GST_VIDEO_INFO_FORMAT(in_info)) !=
+         RK_FORMAT_UNKNOWN;
+}
+
+/* transform */
+
+/* The base class only makes a shallow copy of a shared input. RGA writes
+ * the memory by fd, which would draw the overlay into the frame of every
+ * other branch of a tee, so a frame with a composition and shared memory is
+ * copied deeply. */
+static GstFlowReturn gst_rga_overlay_prepare_output_buffer(
+    GstBaseTransform *trans, GstBuffer *input, GstBuffer **outbuf) {
+  GstFlowReturn ret =
+      GST_BASE_TRANSFORM_CLASS(gst_rga_overlay_parent_class)
+          ->prepare_output_buffer(trans, input, outbuf);
+
+  if (ret != GST_FLOW_OK ||
+      !gst_buffer_get_video_overlay_composition_meta(*outbuf) ||
+      gst_buffer_is_all_memory_writable(*outbuf))
+    return ret;
+
+  GstBuffer *copy = gst_buffer_copy_deep(input);
+  if (!copy) return GST_FLOW_ERROR;
+
+  GST_LOG_OBJECT(trans, "copying shared frame before drawing into it");
+  if (*outbuf != input) gst_buffer_unref(*outbuf);
+  *outbuf = copy;
+  return GST_FLOW_OK;
+}
+
+/* One rectangle of the composition, clipped to the frame */
+typedef struct {
+  GstRgaOverlayImage *image;
+  im_rect src_rect;
+  im_rect dst_rect;
+  int alpha;
+} GstRgaOverlayBlit;
+
+/* Looks up the image of every visible rectangle of @composition. @dma32
+ * is cleared when one of them is out of reach of RGA2, @imported when one
+ * of them could not be imported. */
+static GArray *gst_rga_overlay_collect(GstRgaOverlay *overlay,
+                                       GstVideoOverlayComposition *composition,
+                                       const im_rect *frame, gboolean *dma32,
+                                       gboolean *imported) {
+  guint n = gst_video_overlay_composition_n_rectangles(composition);
+  GArray *blits = g_array_sized_new(FALSE, FALSE, sizeof(GstRgaOverlayBlit), n);
+
+  for (guint i = 0; i < n; i++) {
+    GstVideoOverlayRectangle *rectangle =
+        gst_video_overlay_composition_get_rectangle(composition, i);
+    GstRgaOverlayImage *image = gst_rga_overlay_lookup(overlay, rectangle);
+    GstRgaOverlayBlit blit;
+    gint x, y;
+    guint width, height;
+
+    if (!image) {
+      *imported = FALSE;
+      continue;
+    }
+
+    gst_video_overlay_rectangle_get_render_rectangle(rectangle, &x, &y,
+                                                     &width, &height);
+    im_rect render = {x, y, (int)width, (int)height};
+    if (!gst_rga_clip_rect(&render, image->rect.width, image->rect.height,
+                           frame->width, frame->height, &blit.src_rect,
+                           &blit.dst_rect))
+      continue;
+
+    /* the rectangles of the images start at their origin in the dmabuf */
+    blit.src_rect.x += image->rect.x;
+    blit.src_rect.y += image->rect.y;
+    blit.dst_rect.x += frame->x;
+    blit.dst_rect.y += frame->y;
+    blit.image = image;
+    blit.alpha =
+        (int)(gst_video_overlay_rectangle_get_global_alpha(rectangle) * 255 +
+              0.5);
+
+    *dma32 = *dma32 && gst_rga_buffer_is_dma32(image->buffer);
+    g_array_append_val(blits, blit);
+  }
+  return blits;
+}
+
+/* Draws @composition on the CPU, for what RGA could not blend */
+static gboolean gst_rga_overlay_blend_software(
+    GstRgaOverlay *overlay, GstBuffer *buf,
+    GstVideoOverlayComposition *composition) {
+  GstVideoFilter *filter = GST_VIDEO_FILTER(overlay);
+  GstVideoFrame frame;
+
+  if (!gst_video_frame_map(&frame, &filter->in_info, buf, GST_MAP_READWRITE))
+    return FALSE;
+
+  gboolean ret = gst_video_overlay_composition_blend(composition, &frame);
+  gst_video_frame_unmap(&frame);
+  return ret;
+}
+
+static GstFlowReturn gst_rga_overlay_transform_ip(GstBaseTransform *trans,
+                                                  GstBuffer *buf) {
+  GstRgaOverlay *overlay = GST_RGA_OVERLAY(trans);
+  GstVideoFilter *filter = GST_VIDEO_FILTER(trans);
+  GstVideoOverlayCompositionMeta *meta;
+  GstVideoFrame frame;
+  GstMapInfo map = {
+      0,
+  };
+  rga_buffer_t dst_info = {
+      0,
+  };
+  rga_buffer_t none = {
+      0,
+  };
+  im_rect dst_frame;
+  im_rect none_rect = {
+      0,
+  };
+  im_opt_t opt = {
+      0,
+  };
+
+  if (!filter->negotiated) {
+    GST_ELEMENT_ERROR(overlay, CORE, NOT_IMPLEMENTED, (NULL),
+                      ("unknown format"));
+    return GST_FLOW_NOT_NEGOTIATED;
+  }
+
+  /* nothing to draw, and nothing shown anymore to keep imported */
+  meta = gst_buffer_get_video_overlay_composition_meta(buf);
+  if (!meta) {
+    g_hash_table_remove_all(overlay->images);
+    return GST_FLOW_OK;
+  }
+
+  if (!gst_rga_video_frame_init(GST_OBJECT(trans), &frame, &filter->in_info,
+                                buf, DRM_FORMAT_MOD_LINEAR) ||
+      !gst_rga_info_from_video_frame(GST_OBJECT(trans), &dst_info, &dst_frame,
+                                     &frame, DRM_FORMAT_MOD_LINEAR, &map,
+                                     GST_MAP_WRITE, NULL, NULL)) {
+    GST_ELEMENT_ERROR(overlay, STREAM, FORMAT, (NULL),
+                      ("invalid video buffer received"));
+    return GST_FLOW_ERROR;
+  }
+
+  GST_OBJECT_LOCK(overlay);
+  guint32 core_mask = overlay->core_mask;
+  GST_OBJECT_UNLOCK(overlay);
+
+  overlay->frames++;
+  gboolean dma32 = gst_rga_buffer_is_dma32(buf);
+  gboolean imported = TRUE;
+  GArray *blits = gst_rga_overlay_collect(overlay, meta->overlay, &dst_frame,
+                                          &dma32, &imported);
+  IM_STATUS status = IM_STATUS_SUCCESS;
+
+  /* a rectangle RGA could not import sends the whole composition to the
+   * CPU, which keeps the rectangles stacked in order */
+  if (imported && blits->len > 0) {
+    /* RGA2 only reaches the low 4 GB, keep other buffers on RGA3 */
+    gboolean allow_rga2 =
+        !gst_rga_scheduler_has_high_memory(overlay->scheduler) || dma32;
+    opt.core =
+        gst_rga_scheduler_acquire(overlay->scheduler, core_mask, allow_rga2);
+
+    /* one job for all rectangles saves an ioctl round trip per blend */
+    im_job_handle_t job = imbeginJob(0);
+    status = job ? IM_STATUS_SUCCESS : IM_STATUS_FAILED;
+
+    for (guint i = 0; i < blits->len && status == IM_STATUS_SUCCESS; i++) {
+      GstRgaOverlayBlit *blit = &g_array_index(blits, GstRgaOverlayBlit, i);
+      rga_buffer_t src_info = blit->image->info;
+
+      src_info.global_alpha = blit->alpha;
+      status = improcessTask(job, src_info, dst_info, none, blit->src_rect,
+                             blit->dst_rect, none_rect, &opt,
+                             IM_ALPHA_BLEND_SRC_OVER);
+    }
+
+    if (status == IM_STATUS_SUCCESS)
+      status = imendJob(job, IM_SYNC, -1, NULL);
+    else if (job)
+      imcancelJob(job);
+    gst_rga_scheduler_release(overlay->scheduler, opt.core);
+  }
+
+  guint n_blits = blits->len;
+  g_array_unref(blits);
+  if (map.memory) gst_buffer_unmap(buf, &map);
+
+  /* rectangles gone from the composition are not coming back */
+  g_hash_table_foreach_remove(overlay->images, gst_rga_overlay_image_is_stale,
+                              &overlay->frames);
+
+  /* src caps have no overlay meta feature, downstream would drop it */
+  if (status != IM_STATUS_SUCCESS || !imported) {
+    if (status != IM_STATUS_SUCCESS)
+      GST_WARNING_OBJECT(overlay,
+                         "failed to blend %u rectangles: %s, blending on the "
+                         "CPU",
+                         n_blits, imStrError_t(status));
+    if (!gst_rga_overlay_blend_software(overlay, buf, meta->overlay)) {
+      GST_WARNING_OBJECT(overlay, "cannot blend the overlay composition");
+      return GST_FLOW_OK;
+    }
+    GST_LOG_OBJECT(overlay, "blended the composition on the CPU");
+  } else {
+    GST_LOG_OBJECT(overlay, "blended %u rectangles", n_blits);
+  }
+  gst_buffer_remove_meta(buf, (GstMeta *)meta);
+  return GST_FLOW_OK;
+}
@@ -0,0 +1,66 @@
+/* GStreamer
+ * Copyright (C) 2025 FIXME <fixme@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Suite 500,
+ * Boston, MA 02110-1335, USA.
+ */
+
+#ifndef PLUGINS_GSTRGAOVERLAY_H_
+#define PLUGINS_GSTRGAOVERLAY_H_
+
+#include <gst/video/gstvideofilter.h>
+#include <gst/video/video.h>
+
+#include "gstrgadevice.h"  // NOLINT
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_RGA_OVERLAY (gst_rga_overlay_get_type())
+#define GST_RGA_OVERLAY(obj) \
+  (G_TYPE_CHECK_INSTANCE_CAST((obj), GST_TYPE_RGA_OVERLAY, GstRgaOverlay))
+#define GST_RGA_OVERLAY_CLASS(klass)                      \
+  (G_TYPE_CHECK_CLASS_CAST((klass), GST_TYPE_RGA_OVERLAY, \
+                           GstRgaOverlayClass))
+#define GST_IS_RGA_OVERLAY(obj) \
+  (G_TYPE_CHECK_INSTANCE_TYPE((obj), GST_TYPE_RGA_OVERLAY))
+
+typedef struct _GstRgaOverlay GstRgaOverlay;
+typedef struct _GstRgaOverlayClass GstRgaOverlayClass;
+
+struct _GstRgaOverlay {
+  GstVideoFilter parent;
+  guint32 core_mask;
+  gchar *dma_heap;
+
+  GstRgaDevice *device;
+  /* owned by device */
+  GstRgaScheduler *scheduler;
+
+  /* streaming thread only: the rectangles imported for RGA by seqnum, kept
+   * while the compositions of the last frame use them */
+  GstAllocator *allocator;
+  GHashTable *images;
+  guint64 frames;
+};
+
+struct _GstRgaOverlayClass {
+  GstVideoFilterClass parent_class;
+};
+
+GType gst_rga_overlay_get_type(void);
+
+G_END_DECLS
+
+#endif  // PLUGINS_GSTRGAOVERLAY_H_
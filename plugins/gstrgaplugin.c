@@ -0,0 +1,77 @@
+/* GStreamer
+ * Copyright (C) 2025 FIXME <fixme@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Suite 500,
+ * Boston, MA 02110-1335, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"  // NOLINT
+#endif
+
+#include <gst/gst.h>
+
+#include "gstrgacompositor.h"    // NOLINT
+#include "gstrgamultiscale.h"    // NOLINT
+#include "gstrgaoverlay.h"       // NOLINT
+#include "gstrgaroiconvert.h"    // NOLINT
+#include "gstrgatracer.h"        // NOLINT
+#include "gstrgautils.h"         // NOLINT
+#include "gstrgavideoconvert.h"  // NOLINT
+
+static gboolean plugin_init(GstPlugin *plugin) {
+  gst_rga_utils_init();
+
+  /* FIXME Remember to set the rank if it's an element that is meant
+   to be autoplugged by decodebin. */
+  if (!gst_element_register(plugin, "rgavideoconvert", GST_RANK_PRIMARY,
+                            GST_TYPE_RGA_VIDEO_CONVERT))
+    return FALSE;
+
+  if (!gst_element_register(plugin, "rgaroiconvert", GST_RANK_NONE,
+                            GST_TYPE_RGA_ROI_CONVERT))
+    return FALSE;
+
+  if (!gst_element_register(plugin, "rgacompositor", GST_RANK_NONE,
+                            GST_TYPE_RGA_COMPOSITOR))
+    return FALSE;
+
+  if (!gst_element_register(plugin, "rgamultiscale", GST_RANK_NONE,
+                            GST_TYPE_RGA_MULTI_SCALE))
+    return FALSE;
+
+  if (!gst_element_register(plugin, "rgaoverlay", GST_RANK_NONE,
+                            GST_TYPE_RGA_OVERLAY))
+    return FALSE;
+
+  return gst_tracer_register(plugin, "rgajobs", GST_TYPE_RGA_TRACER);
+}
+
+#ifndef VERSION
+#define VERSION "1.0.0"
+#endif
+#ifndef PACKAGE
+#define PACKAGE "gstreamer-rga"
+#endif
+#ifndef PACKAGE_NAME
+#define PACKAGE_NAME "gstreamer-rga"
+#endif
+#ifndef GST_PACKAGE_ORIGIN
+#define GST_PACKAGE_ORIGIN "https://github.com/corenel/gstreamer-rga.git"
+#endif
+
+GST_PLUGIN_DEFINE(GST_VERSION_MAJOR, GST_VERSION_MINOR, rgavideoconvert,
+                  "video Colorspace conversion & scaler", plugin_init, VERSION,
+                  "MIT/X11", PACKAGE_NAME, GST_PACKAGE_ORIGIN)
@@ -0,0 +1,652 @@
+/* GStreamer
+ * Copyright (C) 2025 FIXME <fixme@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Suite 500,
+ * Boston, MA 02110-1335, USA.
+ */
+/**
+ * SECTION:element-gstrgaroiconvert
+ *
+ * The rgaroiconvert element crops every GstVideoRegionOfInterestMeta of the
+ * input frame and scales it to roi-width x roi-height. All crops of a frame
+ * go to RGA as one job and land as tiles stacked vertically in one output
+ * buffer, tile i at line i * roi-height. Each filled tile carries a
+ * GstVideoRegionOfInterestMeta with an "rga/roi" parameter naming its
+ * source rectangle. Tiles past the ROIs of a frame are not cleared and keep
+ * what an earlier frame left in the buffer, so only the tiles with a meta
+ * should be read. The output is at most 4096 lines, which caps max-rois to
+ * 4096 / roi-height. Frames without ROIs are dropped.
+ *
+ * <refsect2>
+ * <title>Example launch line</title>
+ * |[
+ * gst-launch-1.0 filesrc location=faces.mp4 ! decodebin ! facedetect !
+ * rgaroiconvert roi-width=112 roi-height=112 max-rois=20 !
+ * video/x-raw,format=RGB ! fakesink
+ * ]|
+ * </refsect2>
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"  // NOLINT
+#endif
+
+#include <gst/gst.h>
+#include <gst/video/gstvideofilter.h>
+#include <gst/video/video.h>
+
+#include "gstrgaallocator.h"   // NOLINT
+#include "gstrgaroiconvert.h"  // NOLINT
+#include "gstrgautils.h"       // NOLINT
+
+GST_DEBUG_CATEGORY_STATIC(gst_rga_roi_convert_debug_category);
+#define GST_CAT_DEFAULT gst_rga_roi_convert_debug_category
+
+/* prototypes */
+
+static gboolean gst_rga_roi_convert_start(GstBaseTransform *trans);
+static gboolean gst_rga_roi_convert_stop(GstBaseTransform *trans);
+static GstCaps *gst_rga_roi_convert_transform_caps(GstBaseTransform *trans,
+                                                   GstPadDirection direction,
+                                                   GstCaps *caps,
+                                                   GstCaps *filter);
+static gboolean gst_rga_roi_convert_set_caps(GstBaseTransform *trans,
+                                             GstCaps *incaps,
+                                             GstCaps *outcaps);
+static gboolean gst_rga_roi_convert_decide_allocation(GstBaseTransform *trans,
+                                                      GstQuery *query);
+static gboolean gst_rga_roi_convert_propose_allocation(
+    GstBaseTransform *trans, GstQuery *decide_query, GstQuery *query);
+static gboolean gst_rga_roi_convert_set_info(GstVideoFilter *filter,
+                                             GstCaps *incaps,
+                                             GstVideoInfo *in_info,
+                                             GstCaps *outcaps,
+                                             GstVideoInfo *out_info);
+static GstFlowReturn gst_rga_roi_convert_transform(GstBaseTransform *trans,
+                                                   GstBuffer *inbuf,
+                                                   GstBuffer *outbuf);
+
+/* pad templates */
+
+/* the output holds max-rois tiles stacked vertically, as many as fit in
+ * RGA_ROI_MAX_HEIGHT lines */
+#define RGA_ROI_MAX_HEIGHT 4096
+
+#define VIDEO_SRC_CAPS                                                         \
+  "video/x-raw, "                                                              \
+  "format = (string) " GST_RGA_SRC_FORMATS                                     \
+  ", "                                                                         \
+  "width = (int) [ 2, 4096 ] ,"                                                \
+  "height = (int) [ 2, 4096 ] ,"                                               \
+  "framerate = (fraction) [ 0, max ]"
+
+#define VIDEO_SINK_CAPS                                                        \
+  "video/x-raw, "                                                              \
+  "format = (string) " GST_RGA_SINK_FORMATS                                    \
+  ", "                                                                         \
+  "width = (int) [ 1, 8192 ] ,"                                                \
+  "height = (int) [ 1, 8192 ] ,"                                               \
+  "framerate = (fraction) [ 0, max ]"
+
+/* element properties */
+
+typedef enum {
+  GST_RGA_ROI_PROP_0,
+  GST_RGA_ROI_PROP_CORE_MASK,
+  GST_RGA_ROI_PROP_DMA_HEAP,
+  GST_RGA_ROI_PROP_ROI_WIDTH,
+  GST_RGA_ROI_PROP_ROI_HEIGHT,
+  GST_RGA_ROI_PROP_MAX_ROIS,
+  GST_RGA_ROI_PROP_ROI_TYPE,
+  GST_RGA_ROI_PROP_LAST
+} GstRgaRoiProp;
+
+static GParamSpec *rga_roi_props[GST_RGA_ROI_PROP_LAST];
+
+#define DEFAULT_DMA_HEAP "system-uncached"
+#define DEFAULT_ROI_WIDTH 112
+#define DEFAULT_ROI_HEIGHT 112
+#define DEFAULT_MAX_ROIS 32
+
+/* RGA scales by at most 16 in either direction */
+#define RGA_MAX_SCALE 16
+
+/* class initialization */
+
+G_DEFINE_TYPE_WITH_CODE(
+    GstRgaRoiConvert, gst_rga_roi_convert, GST_TYPE_VIDEO_FILTER,
+    GST_DEBUG_CATEGORY_INIT(gst_rga_roi_convert_debug_category,
+                            "rgaroiconvert", 0,
+                            "batched ROI crop & scale"));
+
+static void gst_rga_roi_convert_set_property(GObject *object, guint prop_id,
+                                             const GValue *value,
+                                             GParamSpec *pspec);
+
+static void gst_rga_roi_convert_get_property(GObject *object, guint prop_id,
+                                             GValue *value, GParamSpec *pspec);
+
+static void gst_rga_roi_convert_finalize(GObject *object);
+
+static void gst_rga_roi_convert_class_init(GstRgaRoiConvertClass *klass) {
+  GObjectClass *gobject_class = G_OBJECT_CLASS(klass);
+  GstBaseTransformClass *base_transform_class = GST_BASE_TRANSFORM_CLASS(klass);
+  GstVideoFilterClass *video_filter_class = GST_VIDEO_FILTER_CLASS(klass);
+
+  gst_element_class_add_pad_template(
+      GST_ELEMENT_CLASS(klass),
+      gst_pad_template_new("src", GST_PAD_SRC, GST_PAD_ALWAYS,
+                           gst_rga_template_caps(VIDEO_SRC_CAPS)));
+  gst_element_class_add_pad_template(
+      GST_ELEMENT_CLASS(klass),
+      gst_pad_template_new("sink", GST_PAD_SINK, GST_PAD_ALWAYS,
+                           gst_rga_template_caps(VIDEO_SINK_CAPS)));
+
+  gst_element_class_set_static_metadata(
+      GST_ELEMENT_CLASS(klass), "RgaRoiConv Plugin", "Filter/Converter/Video",
+      "Crops and scales the regions of interest of a frame in one Rockchip "
+      "RGA job",
+      "http://github.com/corenel/gstreamer-rga");
+
+  /* element properties */
+  rga_roi_props[GST_RGA_ROI_PROP_CORE_MASK] = g_param_spec_flags(
+      "core-mask", "Core mask", "Select which RGA core(s) to use (bit-mask)",
+      gst_rga_core_mask_get_type(), IM_SCHEDULER_DEFAULT,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
+  rga_roi_props[GST_RGA_ROI_PROP_DMA_HEAP] = g_param_spec_string(
+      "dma-heap", "DMA heap",
+      "dma-heap (under /dev/dma_heap) to allocate output buffers from, falls "
+      "back to \"" GST_RGA_ALLOCATOR_FALLBACK_HEAP "\" if missing",
+      DEFAULT_DMA_HEAP,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_MUTABLE_READY);
+
+  rga_roi_props[GST_RGA_ROI_PROP_ROI_WIDTH] = g_param_spec_uint(
+      "roi-width", "ROI width", "Width every ROI is scaled to", 2, 4096,
+      DEFAULT_ROI_WIDTH,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_MUTABLE_READY);
+
+  rga_roi_props[GST_RGA_ROI_PROP_ROI_HEIGHT] = g_param_spec_uint(
+      "roi-height", "ROI height", "Height every ROI is scaled to", 2, 4096,
+      DEFAULT_ROI_HEIGHT,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_MUTABLE_READY);
+
+  rga_roi_props[GST_RGA_ROI_PROP_MAX_ROIS] = g_param_spec_uint(
+      "max-rois", "Max ROIs",
+      "Number of tiles in an output buffer, at most 4096 / roi-height, "
+      "further ROIs are ignored",
+      1, 128, DEFAULT_MAX_ROIS,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_MUTABLE_READY);
+
+  rga_roi_props[GST_RGA_ROI_PROP_ROI_TYPE] = g_param_spec_string(
+      "roi-type", "ROI type",
+      "Only convert ROIs of this type (e.g. \"face\"), NULL for all", NULL,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_MUTABLE_PLAYING);
+
+  gobject_class->set_property = gst_rga_roi_convert_set_property;
+  gobject_class->get_property = gst_rga_roi_convert_get_property;
+  gobject_class->finalize = gst_rga_roi_convert_finalize;
+  g_object_class_install_properties(gobject_class, GST_RGA_ROI_PROP_LAST,
+                                    rga_roi_props);
+
+  /* even identical caps need the crops */
+  base_transform_class->passthrough_on_same_caps = FALSE;
+
+  base_transform_class->transform_caps =
+      GST_DEBUG_FUNCPTR(gst_rga_roi_convert_transform_caps);
+  base_transform_class->set_caps =
+      GST_DEBUG_FUNCPTR(gst_rga_roi_convert_set_caps);
+  base_transform_class->decide_allocation =
+      GST_DEBUG_FUNCPTR(gst_rga_roi_convert_decide_allocation);
+  base_transform_class->propose_allocation =
+      GST_DEBUG_FUNCPTR(gst_rga_roi_convert_propose_allocation);
+
+  base_transform_class->start = GST_DEBUG_FUNCPTR(gst_rga_roi_convert_start);
+  base_transform_class->stop = GST_DEBUG_FUNCPTR(gst_rga_roi_convert_stop);
+  video_filter_class->set_info =
+      GST_DEBUG_FUNCPTR(gst_rga_roi_convert_set_info);
+  /* RGA reads the buffers by fd, skip the CPU mapping of transform_frame */
+  base_transform_class->transform =
+      GST_DEBUG_FUNCPTR(gst_rga_roi_convert_transform);
+}
+
+static void gst_rga_roi_convert_init(GstRgaRoiConvert *roiconvert) {
+  roiconvert->core_mask = IM_SCHEDULER_DEFAULT;
+  roiconvert->dma_heap = g_strdup(DEFAULT_DMA_HEAP);
+  roiconvert->roi_width = DEFAULT_ROI_WIDTH;
+  roiconvert->roi_height = DEFAULT_ROI_HEIGHT;
+  roiconvert->max_rois = DEFAULT_MAX_ROIS;
+}
+
+static void gst_rga_roi_convert_finalize(GObject *object) {
+  GstRgaRoiConvert *roiconvert = GST_RGA_ROI_CONVERT(object);
+
+  g_free(roiconvert->dma_heap);
+
+  G_OBJECT_CLASS(gst_rga_roi_convert_parent_class)->finalize(object);
+}
+
+static void gst_rga_roi_convert_set_property(GObject *object, guint prop_id,
+                                             const GValue *value,
+                                             GParamSpec *pspec) {
+  GstRgaRoiConvert *roiconvert = GST_RGA_ROI_CONVERT(object);
+
+  GST_OBJECT_LOCK(roiconvert);
+  switch (prop_id) {
+    case GST_RGA_ROI_PROP_CORE_MASK:
+      roiconvert->core_mask = g_value_get_flags(value);
+      break;
+    case GST_RGA_ROI_PROP_DMA_HEAP:
+      g_free(roiconvert->dma_heap);
+      roiconvert->dma_heap = g_value_dup_string(value);
+      break;
+    case GST_RGA_ROI_PROP_ROI_WIDTH:
+      roiconvert->roi_width = g_value_get_uint(value);
+      break;
+    case GST_RGA_ROI_PROP_ROI_HEIGHT:
+      roiconvert->roi_height = g_value_get_uint(value);
+      break;
+    case GST_RGA_ROI_PROP_MAX_ROIS:
+      roiconvert->max_rois = g_value_get_uint(value);
+      break;
+    case GST_RGA_ROI_PROP_ROI_TYPE: {
+      const gchar *type = g_value_get_string(value);
+      roiconvert->roi_type = type ? g_quark_from_string(type) : 0;
+      break;
+    }
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+      break;
+  }
+  GST_OBJECT_UNLOCK(roiconvert);
+}
+
+static void gst_rga_roi_convert_get_property(GObject *object, guint prop_id,
+                                             GValue *value, GParamSpec *pspec) {
+  GstRgaRoiConvert *roiconvert = GST_RGA_ROI_CONVERT(object);
+
+  GST_OBJECT_LOCK(roiconvert);
+  switch (prop_id) {
+    case GST_RGA_ROI_PROP_CORE_MASK:
+      g_value_set_flags(value, roiconvert->core_mask);
+      break;
+    case GST_RGA_ROI_PROP_DMA_HEAP:
+      g_value_set_string(value, roiconvert->dma_heap);
+      break;
+    case GST_RGA_ROI_PROP_ROI_WIDTH:
+      g_value_set_uint(value, roiconvert->roi_width);
+      break;
+    case GST_RGA_ROI_PROP_ROI_HEIGHT:
+      g_value_set_uint(value, roiconvert->roi_height);
+      break;
+    case GST_RGA_ROI_PROP_MAX_ROIS:
+      g_value_set_uint(value, roiconvert->max_rois);
+      break;
+    case GST_RGA_ROI_PROP_ROI_TYPE:
+      g_value_set_string(value, g_quark_to_string(roiconvert->roi_type));
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+      break;
+  }
+  GST_OBJECT_UNLOCK(roiconvert);
+}
+
+/* The output size only depends on the properties, the input may have any
+ * size */
+static GstCaps *gst_rga_roi_convert_transform_caps(GstBaseTransform *trans,
+                                                   GstPadDirection direction,
+                                                   GstCaps *caps,
+                                                   GstCaps *filter) {
+  GstRgaRoiConvert *roiconvert = GST_RGA_ROI_CONVERT(trans);
+  GstCaps *ret = gst_caps_new_empty();
+
+  GST_OBJECT_LOCK(roiconvert);
+  gint width = roiconvert->roi_width;
+  guint n_tiles =
+      MIN(roiconvert->max_rois, RGA_ROI_MAX_HEIGHT / roiconvert->roi_height);
+  gint height = roiconvert->roi_height * n_tiles;
+  GST_OBJECT_UNLOCK(roiconvert);
+
+  for (guint i = 0; i < gst_caps_get_size(caps); i++) {
+    GstStructure *structure = gst_caps_get_structure(caps, i);
+    GstCapsFeatures *features = gst_caps_get_features(caps, i);
+
+    if (i > 0 && gst_caps_is_subset_structure_full(ret, structure, features))
+      continue;
+
+    structure = gst_structure_copy(structure);
+    if (direction == GST_PAD_SINK)
+      gst_structure_set(structure, "width", G_TYPE_INT, width, "height",
+                        G_TYPE_INT, height, NULL);
+    else
+      gst_structure_set(structure, "width", GST_TYPE_INT_RANGE, 1, 8192,
+                        "height", GST_TYPE_INT_RANGE, 1, 8192, NULL);
+
+    if (gst_caps_features_is_any(features)) {
+      gst_caps_append_structure_full(ret, structure,
+                                     gst_caps_features_copy(features));
+      continue;
+    }
+    ret = gst_caps_merge(ret, gst_rga_caps_any_memory(structure, features));
+  }
+
+  if (filter) {
+    GstCaps *intersection =
+        gst_caps_intersect_full(filter, ret, GST_CAPS_INTERSECT_FIRST);
+    gst_caps_unref(ret);
+    ret = intersection;
+  }
+
+  GST_DEBUG_OBJECT(trans, "transformed %" GST_PTR_FORMAT " to %" GST_PTR_FORMAT,
+                   caps, ret);
+  return ret;
+}
+
+/* allocation */
+
+static gboolean gst_rga_roi_convert_decide_allocation(GstBaseTransform *trans,
+                                                      GstQuery *query) {
+  GstRgaRoiConvert *roiconvert = GST_RGA_ROI_CONVERT(trans);
+  GstAllocator *allocator =
+      gst_rga_create_allocator(GST_OBJECT(trans), roiconvert->dma_heap);
+
+  if (!allocator) {
+    GST_WARNING_OBJECT(roiconvert,
+                       "no dma-heap available, output buffers will be "
+                       "mapped by the CPU");
+    return GST_BASE_TRANSFORM_CLASS(gst_rga_roi_convert_parent_class)
+        ->decide_allocation(trans, query);
+  }
+
+  gboolean ret =
+      gst_rga_decide_allocation(GST_OBJECT(trans), query, allocator, NULL);
+  gst_object_unref(allocator);
+  return ret;
+}
+
+static gboolean gst_rga_roi_convert_propose_allocation(
+    GstBaseTransform *trans, GstQuery *decide_query, GstQuery *query) {
+  GstRgaRoiConvert *roiconvert = GST_RGA_ROI_CONVERT(trans);
+  GstCaps *caps;
+
+  gst_query_parse_allocation(query, &caps, NULL);
+  if (!caps) return FALSE;
+
+  GstAllocator *allocator =
+      gst_rga_create_allocator(GST_OBJECT(trans), roiconvert->dma_heap);
+  gst_rga_propose_allocation(GST_OBJECT(trans), query, allocator);
+  if (allocator) gst_object_unref(allocator);
+
+  gst_query_add_allocation_meta(query, GST_VIDEO_META_API_TYPE, NULL);
+  return TRUE;
+}
+
+static gboolean gst_rga_roi_convert_start(GstBaseTransform *trans) {
+  GstRgaRoiConvert *roiconvert = GST_RGA_ROI_CONVERT(trans);
+
+  roiconvert->device = gst_rga_device_ref();
+  roiconvert->scheduler = gst_rga_device_get_scheduler(roiconvert->device);
+  return TRUE;
+}
+
+static gboolean gst_rga_roi_convert_stop(GstBaseTransform *trans) {
+  GstRgaRoiConvert *roiconvert = GST_RGA_ROI_CONVERT(trans);
+
+  roiconvert->scheduler = NULL;
+  gst_rga_device_unref(roiconvert->device);
+  roiconvert->device = NULL;
+  return TRUE;
+}
+
+/* GstVideoFilter cannot parse DMA_DRM caps, hand it the plain equivalent.
+ * The tiles are addressed by rectangle, so the output must be linear. */
+static gboolean gst_rga_roi_convert_set_caps(GstBaseTransform *trans,
+                                             GstCaps *incaps,
+                                             GstCaps *outcaps) {
+  GstRgaRoiConvert *roiconvert = GST_RGA_ROI_CONVERT(trans);
+  guint64 out_modifier = DRM_FORMAT_MOD_LINEAR;
+  GstCaps *in = gst_rga_caps_to_plain(incaps, &roiconvert->in_modifier);
+  GstCaps *out = gst_rga_caps_to_plain(outcaps, &out_modifier);
+  gboolean ret = FALSE;
+
+  if (in && out && out_modifier == DRM_FORMAT_MOD_LINEAR)
+    ret = GST_BASE_TRANSFORM_CLASS(gst_rga_roi_convert_parent_class)
+              ->set_caps(trans, in, out);
+  else
+    GST_WARNING_OBJECT(trans, "unsupported caps in %" GST_PTR_FORMAT
+                       " out %" GST_PTR_FORMAT, incaps, outcaps);
+
+  if (in) gst_caps_unref(in);
+  if (out) gst_caps_unref(out);
+  return ret;
+}
+
+static gboolean gst_rga_roi_convert_set_info(GstVideoFilter *filter,
+                                             GstCaps *incaps,
+                                             GstVideoInfo *in_info,
+                                             GstCaps *outcaps,
+                                             GstVideoInfo *out_info) {
+  GstRgaRoiConvert *roiconvert = GST_RGA_ROI_CONVERT(filter);
+
+  if (gst_gst_format_to_rga_format(GST_VIDEO_INFO_FORMAT(in_info)) ==
+          RK_FORMAT_UNKNOWN ||
+      gst_gst_format_to_rga_format(GST_VIDEO_INFO_FORMAT(out_info)) ==
+          RK_FORMAT_UNKNOWN)
+    return FALSE;
+
+  GST_OBJECT_LOCK(roiconvert);
+  guint roi_width = roiconvert->roi_width;
+  guint roi_height = roiconvert->roi_height;
+  guint max_rois = roiconvert->max_rois;
+  GST_OBJECT_UNLOCK(roiconvert);
+
+  if (GST_VIDEO_INFO_WIDTH(out_info) != roi_width ||
+      GST_VIDEO_INFO_HEIGHT(out_info) < roi_height) {
+    GST_WARNING_OBJECT(roiconvert, "output %dx%d cannot hold %ux%u tiles",
+                       GST_VIDEO_INFO_WIDTH(out_info),
+                       GST_VIDEO_INFO_HEIGHT(out_info), roi_width, roi_height);
+    return FALSE;
+  }
+
+  guint n_tiles = GST_VIDEO_INFO_HEIGHT(out_info) / roi_height;
+  if (n_tiles < max_rois)
+    GST_WARNING_OBJECT(roiconvert,
+                       "max-rois %u does not fit in %d lines, using %u tiles",
+                       max_rois, GST_VIDEO_INFO_HEIGHT(out_info), n_tiles);
+  return TRUE;
+}
+
+/* transform */
+
+/* Clips @roi to the frame and aligns it for RGA. Returns FALSE when
+ * nothing usable is left or RGA cannot scale it to the tile. */
+static gboolean gst_rga_roi_convert_source_rect(
+    GstVideoRegionOfInterestMeta *roi, const im_rect *frame, guint tile_width,
+    guint tile_height, im_rect *rect) {
+  gint x0 = MIN(roi->x, (guint)frame->width);
+  gint y0 = MIN(roi->y, (guint)frame->height);
+  gint x1 = MIN((guint64)roi->x + roi->w, (guint64)frame->width);
+  gint y1 = MIN((guint64)roi->y + roi->h, (guint64)frame->height);
+
+  /* even origin and size keep the chroma planes aligned */
+  rect->x = x0 & ~1;
+  rect->y = y0 & ~1;
+  rect->width = (x1 - rect->x) & ~1;
+  rect->height = (y1 - rect->y) & ~1;
+
+  return rect->width > 0 && rect->height > 0 &&
+         rect->width * RGA_MAX_SCALE >= (gint)tile_width &&
+         rect->height * RGA_MAX_SCALE >= (gint)tile_height &&
+         (gint)tile_width * RGA_MAX_SCALE >= rect->width &&
+         (gint)tile_height * RGA_MAX_SCALE >= rect->height;
+}
+
+/* Tags tile @index of @outbuf with the ROI it was cut from */
+static void gst_rga_roi_convert_add_meta(GstBuffer *outbuf,
+                                         GstVideoRegionOfInterestMeta *roi,
+                                         const im_rect *src,
+                                         const im_rect *tile, guint index) {
+  GstVideoRegionOfInterestMeta *meta =
+      gst_buffer_add_video_region_of_interest_meta_id(
+          outbuf, roi->roi_type, tile->x, tile->y, tile->width, tile->height);
+
+  meta->id = roi->id;
+  meta->parent_id = roi->parent_id;
+  gst_video_region_of_interest_meta_add_param(
+      meta, gst_structure_new("rga/roi", "index", G_TYPE_UINT, index,
+                              "source-x", G_TYPE_INT, src->x, "source-y",
+                              G_TYPE_INT, src->y, "source-width", G_TYPE_INT,
+                              src->width, "source-height", G_TYPE_INT,
+                              src->height, NULL));
+}
+
+static GstFlowReturn gst_rga_roi_convert_transform(GstBaseTransform *trans,
+                                                   GstBuffer *inbuf,
+                                                   GstBuffer *outbuf) {
+  GstRgaRoiConvert *roiconvert = GST_RGA_ROI_CONVERT(trans);
+  GstVideoFilter *filter = GST_VIDEO_FILTER(trans);
+  GstVideoFrame inframe, outframe;
+  GstMapInfo in_map = {
+      0,
+  };
+  GstMapInfo out_map = {
+      0,
+  };
+  rga_buffer_t src_info = {
+      0,
+  };
+  rga_buffer_t dst_info = {
+      0,
+  };
+  rga_buffer_t pat_info = {
+      0,
+  };
+  im_rect src_frame, dst_frame;
+  im_rect pat_rect = {
+      0,
+  };
+  im_opt_t opt = {
+      0,
+  };
+  GstFlowReturn ret = GST_FLOW_ERROR;
+
+  if (!filter->negotiated) {
+    GST_ELEMENT_ERROR(roiconvert, CORE, NOT_IMPLEMENTED, (NULL),
+                      ("unknown format"));
+    return GST_FLOW_NOT_NEGOTIATED;
+  }
+
+  if (!gst_rga_video_frame_init(GST_OBJECT(trans), &inframe, &filter->in_info,
+                                inbuf, roiconvert->in_modifier) ||
+      !gst_rga_video_frame_init(GST_OBJECT(trans), &outframe,
+                                &filter->out_info, outbuf,
+                                DRM_FORMAT_MOD_LINEAR)) {
+    GST_ELEMENT_ERROR(roiconvert, STREAM, FORMAT, (NULL),
+                      ("invalid video buffer received"));
+    return GST_FLOW_ERROR;
+  }
+
+  GST_OBJECT_LOCK(roiconvert);
+  guint32 core_mask = roiconvert->core_mask;
+  guint tile_width = roiconvert->roi_width;
+  guint tile_height = roiconvert->roi_height;
+  GQuark roi_type = roiconvert->roi_type;
+  GST_OBJECT_UNLOCK(roiconvert);
+  guint max_tiles = GST_VIDEO_FRAME_HEIGHT(&outframe) / tile_height;
+
+  if (!gst_rga_info_from_video_frame(
+          GST_OBJECT(trans), &src_info, &src_frame, &inframe,
+          roiconvert->in_modifier, &in_map, GST_MAP_READ, NULL, NULL) ||
+      !gst_rga_info_from_video_frame(GST_OBJECT(trans), &dst_info, &dst_frame,
+                                     &outframe, DRM_FORMAT_MOD_LINEAR,
+                                     &out_map, GST_MAP_WRITE, NULL, NULL))
+    goto done;
+
+  /* only RGA3 handles AFBC */
+  if (src_info.rd_mode == IM_FBC_MODE) {
+    const guint32 rga3 = IM_SCHEDULER_RGA3_CORE0 | IM_SCHEDULER_RGA3_CORE1;
+
+    core_mask = (core_mask ? core_mask : rga3) & rga3;
+    if (!core_mask) {
+      GST_WARNING_OBJECT(roiconvert,
+                         "AFBC needs RGA3 but core-mask excludes it");
+      goto done;
+    }
+  }
+
+  /* RGA2 only reaches the low 4 GB, keep other buffers on RGA3 */
+  gboolean allow_rga2 =
+      !gst_rga_scheduler_has_high_memory(roiconvert->scheduler) ||
+      (gst_rga_buffer_is_dma32(inbuf) && gst_rga_buffer_is_dma32(outbuf));
+  opt.core =
+      gst_rga_scheduler_acquire(roiconvert->scheduler, core_mask, allow_rga2);
+
+  /* one job for all ROIs saves an ioctl round trip per crop */
+  im_job_handle_t job = imbeginJob(0);
+  IM_STATUS status = job ? IM_STATUS_SUCCESS : IM_STATUS_FAILED;
+  gpointer state = NULL;
+  GstMeta *meta;
+  guint n_tiles = 0;
+
+  while (status == IM_STATUS_SUCCESS && n_tiles < max_tiles &&
+         (meta = gst_buffer_iterate_meta_filtered(
+              inbuf, &state, GST_VIDEO_REGION_OF_INTEREST_META_API_TYPE))) {
+    GstVideoRegionOfInterestMeta *roi = (GstVideoRegionOfInterestMeta *)meta;
+    im_rect src_rect;
+    im_rect tile = {0, (int)(n_tiles * tile_height), (int)tile_width,
+                    (int)tile_height};
+
+    if (roi_type && roi->roi_type != roi_type) continue;
+    if (!gst_rga_roi_convert_source_rect(roi, &src_frame, tile_width,
+                                         tile_height, &src_rect)) {
+      GST_LOG_OBJECT(roiconvert, "skipping ROI %d at %ux%u %ux%u", roi->id,
+                     roi->x, roi->y, roi->w, roi->h);
+      continue;
+    }
+
+    /* the rectangles of the images start at their origin in the dmabuf */
+    im_rect src_task = src_rect, dst_task = tile;
+    src_task.x += src_frame.x;
+    src_task.y += src_frame.y;
+    dst_task.x += dst_frame.x;
+    dst_task.y += dst_frame.y;
+
+    status = improcessTask(job, src_info, dst_info, pat_info, src_task,
+                           dst_task, pat_rect, &opt, 0);
+    if (status == IM_STATUS_SUCCESS)
+      gst_rga_roi_convert_add_meta(outbuf, roi, &src_rect, &tile, n_tiles++);
+  }
+
+  if (status == IM_STATUS_SUCCESS && n_tiles > 0)
+    status = imendJob(job, IM_SYNC, -1, NULL);
+  else if (job)
+    imcancelJob(job);
+  gst_rga_scheduler_release(roiconvert->scheduler, opt.core);
+
+  if (status != IM_STATUS_SUCCESS) {
+    GST_WARNING_OBJECT(roiconvert, "failed to convert ROIs: %s",
+                       imStrError_t(status));
+    goto done;
+  }
+
+  GST_LOG_OBJECT(roiconvert, "converted %u ROIs", n_tiles);
+  ret = n_tiles > 0 ? GST_FLOW_OK : GST_BASE_TRANSFORM_FLOW_DROPPED;
+
+done:
+  if (in_map.memory) gst_buffer_unmap(inbuf, &in_map);
+  if (out_map.memory) gst_buffer_unmap(outbuf, &out_map);
+  return ret;
+}
@@ -0,0 +1,69 @@
+/* GStreamer
+ * Copyright (C) 2025 FIXME <fixme@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Suite 500,
+ * Boston, MA 02110-1335, USA.
+ */
+
+#ifndef PLUGINS_GSTRGAROICONVERT_H_
+#define PLUGINS_GSTRGAROICONVERT_H_
+
+#include <gst/video/gstvideofilter.h>
+#include <gst/video/video.h>
+
+#include "gstrgadevice.h"  // NOLINT
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_RGA_ROI_CONVERT (gst_rga_roi_convert_get_type())
+#define GST_RGA_ROI_CONVERT(obj)                               \
+  (G_TYPE_CHECK_INSTANCE_CAST((obj), GST_TYPE_RGA_ROI_CONVERT, \
+                              GstRgaRoiConvert))
+#define GST_RGA_ROI_CONVERT_CLASS(klass)                      \
+  (G_TYPE_CHECK_CLASS_CAST((klass), GST_TYPE_RGA_ROI_CONVERT, \
+                           GstRgaRoiConvertClass))
+#define GST_IS_RGA_ROI_CONVERT(obj) \
+  (G_TYPE_CHECK_INSTANCE_TYPE((obj), GST_TYPE_RGA_ROI_CONVERT))
+
+typedef struct _GstRgaRoiConvert GstRgaRoiConvert;
+typedef struct _GstRgaRoiConvertClass GstRgaRoiConvertClass;
+
+struct _GstRgaRoiConvert {
+  GstVideoFilter parent;
+  guint32 core_mask;
+  gchar *dma_heap;
+  guint roi_width;
+  guint roi_height;
+  guint max_rois;
+  /* only ROIs of this type are converted, 0 for all */
+  GQuark roi_type;
+
+  GstRgaDevice *device;
+  /* owned by device */
+  GstRgaScheduler *scheduler;
+
+  /* DRM modifier of the input caps, the output is linear */
+  guint64 in_modifier;
+};
+
+struct _GstRgaRoiConvertClass {
+  GstVideoFilterClass parent_class;
+};
+
+GType gst_rga_roi_convert_get_type(void);
+
+G_END_DECLS
+
+#endif  // PLUGINS_GSTRGAROICONVERT_H_
@@ -0,0 +1,231 @@
+/* GStreamer
+ * Copyright (C) 2025 FIXME <fixme@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Suite 500,
+ * Boston, MA 02110-1335, USA.
+ */
+/*
+ * The scheduler belongs to the GstRgaDevice shared by every RGA element of
+ * the process, which serializes its creation and destruction. It counts
+ * the jobs in flight on each core and, when the debugfs load file can be
+ * read, the hardware load reported by the driver, and sends each job to
+ * the least loaded core the element is allowed to use.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"  // NOLINT
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "gstrgascheduler.h"  // NOLINT
+#include "rga/im2d.h"
+
+GST_DEBUG_CATEGORY_STATIC(gst_rga_scheduler_debug_category);
+#define GST_CAT_DEFAULT gst_rga_scheduler_debug_category
+
+#define RGA_LOAD_PATH "/sys/kernel/debug/rkrga/load"
+#define RGA_DRIVERS_PATH "/sys/bus/platform/drivers/"
+
+/* re-read the debugfs load at most this often */
+#define RGA_LOAD_INTERVAL (500 * G_TIME_SPAN_MILLISECOND)
+
+/* one queued job weighs as much as 100 % of reported load */
+#define RGA_JOB_WEIGHT 100
+
+#define RGA_DMA32_LIMIT (G_GUINT64_CONSTANT(1) << 32)
+
+static const guint32 core_bits[GST_RGA_N_CORES] = {
+    IM_SCHEDULER_RGA3_CORE0, IM_SCHEDULER_RGA3_CORE1,
+    IM_SCHEDULER_RGA2_CORE0};
+
+/* scheduler and platform driver names used by the multi-core driver */
+static const gchar *core_names[GST_RGA_N_CORES] = {"rga3_core0", "rga3_core1",
+                                                   "rga2"};
+
+struct _GstRgaScheduler {
+  GMutex lock;
+  guint inflight[GST_RGA_N_CORES];
+  guint load[GST_RGA_N_CORES];
+  guint32 present;
+  gboolean high_memory;
+  gboolean load_readable;
+  gint64 load_time;
+};
+
+static gint gst_rga_core_from_name(const gchar *name) {
+  for (gint i = 0; i < GST_RGA_N_CORES; i++) {
+    if (g_str_has_prefix(name, core_names[i])) return i;
+  }
+  return -1;
+}
+
+static gint gst_rga_core_from_bit(guint32 bit) {
+  for (gint i = 0; i < GST_RGA_N_CORES; i++) {
+    if (core_bits[i] == bit) return i;
+  }
+  return -1;
+}
+
+/* Parses the driver load file, which looks like
+ *   scheduler[0]: rga3_core0
+ *            load = 87%
+ * Returns FALSE if it cannot be read (debugfs is usually root only). */
+static gboolean gst_rga_scheduler_read_load(GstRgaScheduler *self) {
+  FILE *file = fopen(RGA_LOAD_PATH, "r");
+  if (!file) return FALSE;
+
+  gchar line[128];
+  gint core = -1;
+  while (fgets(line, sizeof(line), file)) {
+    gchar name[32];
+    guint load;
+    gint index;
+
+    if (sscanf(line, "scheduler[%d]: %31s", &index, name) == 2) {
+      core = gst_rga_core_from_name(name);
+      if (core >= 0) self->present |= core_bits[core];
+    } else if (core >= 0 && sscanf(line, " load = %u%%", &load) == 1) {
+      self->load[core] = MIN(load, 100);
+      core = -1;
+    }
+  }
+  fclose(file);
+  return TRUE;
+}
+
+static void gst_rga_scheduler_update_load(GstRgaScheduler *self) {
+  if (!self->load_readable) return;
+
+  gint64 now = g_get_monotonic_time();
+  if (now - self->load_time < RGA_LOAD_INTERVAL) return;
+  self->load_time = now;
+
+  if (!gst_rga_scheduler_read_load(self)) {
+    GST_INFO("cannot read " RGA_LOAD_PATH ", using job counts only");
+    self->load_readable = FALSE;
+    memset(self->load, 0, sizeof(self->load));
+  }
+}
+
+/* Without debugfs, a core exists if its platform driver has a device */
+static void gst_rga_scheduler_probe_cores(GstRgaScheduler *self) {
+  for (gint i = 0; i < GST_RGA_N_CORES; i++) {
+    gchar *path = g_strconcat(RGA_DRIVERS_PATH, core_names[i], NULL);
+    GDir *dir = g_dir_open(path, 0, NULL);
+    const gchar *entry;
+
+    while (dir && (entry = g_dir_read_name(dir))) {
+      /* bound devices show up as <address>.<node> links */
+      if (strchr(entry, '.')) {
+        self->present |= core_bits[i];
+        break;
+      }
+    }
+    if (dir) g_dir_close(dir);
+    g_free(path);
+  }
+}
+
+GstRgaScheduler *gst_rga_scheduler_new(void) {
+  GstRgaScheduler *self = g_new0(GstRgaScheduler, 1);
+
+  GST_DEBUG_CATEGORY_INIT(gst_rga_scheduler_debug_category, "rgascheduler", 0,
+                          "RGA core scheduler");
+  g_mutex_init(&self->lock);
+
+  guint64 mem = (guint64)sysconf(_SC_PHYS_PAGES) * sysconf(_SC_PAGESIZE);
+  self->high_memory = mem > RGA_DMA32_LIMIT;
+
+  self->load_readable = gst_rga_scheduler_read_load(self);
+  self->load_time = g_get_monotonic_time();
+  if (!self->present) gst_rga_scheduler_probe_cores(self);
+
+  GST_INFO("RGA cores 0x%x, %s memory above 4 GB, load %s", self->present,
+           self->high_memory ? "with" : "without",
+           self->load_readable ? "from " RGA_LOAD_PATH : "unknown");
+  return self;
+}
+
+void gst_rga_scheduler_free(GstRgaScheduler *self) {
+  g_mutex_clear(&self->lock);
+  g_free(self);
+}
+
+gboolean gst_rga_scheduler_has_high_memory(GstRgaScheduler *self) {
+  return self->high_memory;
+}
+
+gboolean gst_rga_scheduler_needs_dma32(GstRgaScheduler *self, guint32 mask) {
+  guint32 eligible = mask ? mask : self->present;
+  guint32 rga2_bits = core_bits[GST_RGA_CORE_RGA2_CORE0];
+
+  return self->high_memory && (eligible & rga2_bits) &&
+         !(eligible & ~rga2_bits);
+}
+
+guint32 gst_rga_scheduler_acquire(GstRgaScheduler *self, guint32 mask,
+                                  gboolean allow_rga2) {
+  guint32 eligible = mask ? mask : self->present;
+  guint32 rga2_bits = core_bits[GST_RGA_CORE_RGA2_CORE0];
+  guint best = G_MAXUINT;
+  gint core = -1;
+
+  if (!allow_rga2 && (eligible & ~rga2_bits)) eligible &= ~rga2_bits;
+
+  g_mutex_lock(&self->lock);
+  gst_rga_scheduler_update_load(self);
+
+  for (gint i = 0; i < GST_RGA_N_CORES; i++) {
+    if (!(eligible & core_bits[i])) continue;
+
+    guint score = self->inflight[i] * RGA_JOB_WEIGHT + self->load[i];
+    if (score < best) {
+      best = score;
+      core = i;
+    }
+  }
+  if (core >= 0) self->inflight[core]++;
+  g_mutex_unlock(&self->lock);
+
+  if (core < 0) return 0;
+
+  GST_LOG("mask 0x%x -> %s (score %u)", mask, core_names[core], best);
+  return core_bits[core];
+}
+
+void gst_rga_scheduler_release(GstRgaScheduler *self, guint32 core) {
+  gint index = gst_rga_core_from_bit(core);
+  if (index < 0) return;
+
+  g_mutex_lock(&self->lock);
+  if (self->inflight[index] > 0) self->inflight[index]--;
+  g_mutex_unlock(&self->lock);
+}
+
+guint gst_rga_scheduler_get_depth(GstRgaScheduler *self, guint32 mask) {
+  guint32 eligible = mask ? mask : self->present;
+  guint depth = G_MAXUINT;
+
+  g_mutex_lock(&self->lock);
+  for (gint i = 0; i < GST_RGA_N_CORES; i++) {
+    if (eligible & core_bits[i]) depth = MIN(depth, self->inflight[i]);
+  }
+  g_mutex_unlock(&self->lock);
+
+  return depth == G_MAXUINT ? 0 : depth;
+}
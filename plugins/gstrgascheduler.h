@@ -0,0 +1,63 @@
+/* GStreamer
+ * Copyright (C) 2025 FIXME <fixme@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Suite 500,
+ * Boston, MA 02110-1335, USA.
+ */
+
+#ifndef PLUGINS_GSTRGASCHEDULER_H_
+#define PLUGINS_GSTRGASCHEDULER_H_
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+typedef enum {
+  GST_RGA_CORE_RGA3_CORE0,
+  GST_RGA_CORE_RGA3_CORE1,
+  GST_RGA_CORE_RGA2_CORE0,
+  GST_RGA_N_CORES
+} GstRgaCore;
+
+typedef struct _GstRgaScheduler GstRgaScheduler;
+
+/* Elements get the scheduler from gst_rga_device_get_scheduler() */
+GstRgaScheduler *gst_rga_scheduler_new(void);
+void gst_rga_scheduler_free(GstRgaScheduler *scheduler);
+
+/* TRUE if the machine has memory RGA2 cannot address (above 4 GB) */
+gboolean gst_rga_scheduler_has_high_memory(GstRgaScheduler *scheduler);
+
+/* TRUE if jobs allowed by @mask (0 means any core) can only run on RGA2
+ * and the machine has memory RGA2 cannot address, so buffers outside the
+ * first 4 GB go through swiotlb bounce buffers */
+gboolean gst_rga_scheduler_needs_dma32(GstRgaScheduler *scheduler,
+                                       guint32 mask);
+
+/* Picks the least loaded core allowed by @mask (0 means any core) and
+ * accounts one job on it. RGA2 is skipped when @allow_rga2 is FALSE unless
+ * it is the only core in @mask. Returns the IM_SCHEDULER_* bit of the core,
+ * or 0 to let the driver decide. */
+guint32 gst_rga_scheduler_acquire(GstRgaScheduler *scheduler, guint32 mask,
+                                  gboolean allow_rga2);
+void gst_rga_scheduler_release(GstRgaScheduler *scheduler, guint32 core);
+
+/* Jobs in flight on the least busy core allowed by @mask, 0 if no core is
+ * known */
+guint gst_rga_scheduler_get_depth(GstRgaScheduler *scheduler, guint32 mask);
+
+G_END_DECLS
+
+#endif  // PLUGINS_GSTRGASCHEDULER_H_
@@ -0,0 +1,208 @@
+/* GStreamer
+ * Copyright (C) 2025 FIXME <fixme@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Suite 500,
+ * Boston, MA 02110-1335, USA.
+ */
+/* CPU fallback for frames RGA rejects or has no room for. With libyuv the
+ * NEON kernels of libyuv do the work, otherwise plain loops the compiler
+ * vectorizes. Only the common decoder outputs are covered: NV12 scaled to
+ * NV12 or converted to RGB. */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"  // NOLINT
+#endif
+
+#include <string.h>
+#ifdef HAVE_LIBYUV
+#include <libyuv.h>
+#endif
+
+#include "gstrgasoftware.h"  // NOLINT
+
+gboolean gst_rga_software_supports(GstVideoFormat in, GstVideoFormat out) {
+  if (in != GST_VIDEO_FORMAT_NV12) return FALSE;
+
+  switch (out) {
+    case GST_VIDEO_FORMAT_NV12:
+    case GST_VIDEO_FORMAT_RGB:
+    case GST_VIDEO_FORMAT_BGR:
+    case GST_VIDEO_FORMAT_RGBA:
+    case GST_VIDEO_FORMAT_BGRA:
+    case GST_VIDEO_FORMAT_RGBx:
+    case GST_VIDEO_FORMAT_BGRx:
+      return TRUE;
+    default:
+      return FALSE;
+  }
+}
+
+/* An NV12 picture, possibly a window of a bigger one */
+typedef struct {
+  const guint8 *y;
+  const guint8 *uv;
+  gint y_stride;
+  gint uv_stride;
+  gint width;
+  gint height;
+} GstRgaNv12;
+
+static void gst_rga_software_scale_nv12(const GstRgaNv12 *src, guint8 *y,
+                                        gint y_stride, guint8 *uv,
+                                        gint uv_stride, gint width,
+                                        gint height) {
+#ifdef HAVE_LIBYUV
+  NV12Scale(src->y, src->y_stride, src->uv, src->uv_stride, src->width,
+            src->height, y, y_stride, uv, uv_stride, width, height,
+            kFilterBilinear);
+#else
+  /* nearest neighbour, good enough for the odd frame */
+  for (gint row = 0; row < height; row++) {
+    const guint8 *s = src->y + (gsize)(row * src->height / height) *
+                                   src->y_stride;
+    guint8 *d = y + (gsize)row * y_stride;
+
+    for (gint x = 0; x < width; x++) d[x] = s[x * src->width / width];
+  }
+
+  gint cw = (width + 1) / 2, ch = (height + 1) / 2;
+  gint scw = (src->width + 1) / 2, sch = (src->height + 1) / 2;
+  for (gint row = 0; row < ch; row++) {
+    const guint8 *s = src->uv + (gsize)(row * sch / ch) * src->uv_stride;
+    guint8 *d = uv + (gsize)row * uv_stride;
+
+    for (gint x = 0; x < cw; x++) {
+      gint sx = x * scw / cw;
+
+      d[x * 2] = s[sx * 2];
+      d[x * 2 + 1] = s[sx * 2 + 1];
+    }
+  }
+#endif
+}
+
+#ifndef HAVE_LIBYUV
+static inline guint8 gst_rga_clamp(gint v) {
+  return v < 0 ? 0 : v > 255 ? 255 : v;
+}
+#endif
+
+/* Converts @src, already at the size of @out, to the RGB format of @out */
+static void gst_rga_software_nv12_to_rgb(const GstRgaNv12 *src,
+                                         GstVideoFrame *out) {
+  guint8 *data = GST_VIDEO_FRAME_PLANE_DATA(out, 0);
+  gint stride = GST_VIDEO_FRAME_PLANE_STRIDE(out, 0);
+
+#ifdef HAVE_LIBYUV
+  /* libyuv names the formats after the little endian words */
+  switch (GST_VIDEO_FRAME_FORMAT(out)) {
+    case GST_VIDEO_FORMAT_RGB:
+      NV12ToRAW(src->y, src->y_stride, src->uv, src->uv_stride, data, stride,
+                src->width, src->height);
+      break;
+    case GST_VIDEO_FORMAT_BGR:
+      NV12ToRGB24(src->y, src->y_stride, src->uv, src->uv_stride, data,
+                  stride, src->width, src->height);
+      break;
+    case GST_VIDEO_FORMAT_RGBA:
+    case GST_VIDEO_FORMAT_RGBx:
+      NV12ToABGR(src->y, src->y_stride, src->uv, src->uv_stride, data, stride,
+                 src->width, src->height);
+      break;
+    default:
+      NV12ToARGB(src->y, src->y_stride, src->uv, src->uv_stride, data, stride,
+                 src->width, src->height);
+      break;
+  }
+#else
+  const GstVideoFormatInfo *finfo = out->info.finfo;
+  gint pstride = GST_VIDEO_FORMAT_INFO_PSTRIDE(finfo, 0);
+  gint r_off = GST_VIDEO_FORMAT_INFO_POFFSET(finfo, 0);
+  gint g_off = GST_VIDEO_FORMAT_INFO_POFFSET(finfo, 1);
+  gint b_off = GST_VIDEO_FORMAT_INFO_POFFSET(finfo, 2);
+  /* the filler byte of the x formats is set too */
+  gint a_off = pstride == 4 ? 6 - r_off - g_off - b_off : -1;
+
+  for (gint row = 0; row < src->height; row++) {
+    const guint8 *ys = src->y + (gsize)row * src->y_stride;
+    const guint8 *uvs = src->uv + (gsize)(row / 2) * src->uv_stride;
+    guint8 *d = data + (gsize)row * stride;
+
+    for (gint x = 0; x < src->width; x++, d += pstride) {
+      gint c = 298 * (ys[x] - 16);
+      gint u = uvs[x & ~1] - 128;
+      gint v = uvs[x | 1] - 128;
+
+      d[r_off] = gst_rga_clamp((c + 409 * v + 128) >> 8);
+      d[g_off] = gst_rga_clamp((c - 100 * u - 208 * v + 128) >> 8);
+      d[b_off] = gst_rga_clamp((c + 516 * u + 128) >> 8);
+      if (a_off >= 0) d[a_off] = 0xff;
+    }
+  }
+#endif
+}
+
+gboolean gst_rga_software_convert(const GstVideoFrame *in,
+                                  const GstVideoRectangle *src,
+                                  GstVideoFrame *out) {
+  GstVideoFormat out_format = GST_VIDEO_FRAME_FORMAT(out);
+  gint width = GST_VIDEO_FRAME_WIDTH(out);
+  gint height = GST_VIDEO_FRAME_HEIGHT(out);
+  gint y_stride = GST_VIDEO_FRAME_PLANE_STRIDE(in, 0);
+  gint uv_stride = GST_VIDEO_FRAME_PLANE_STRIDE(in, 1);
+  /* the chroma of an odd origin belongs to the even one */
+  gint x = src->x & ~1, y = src->y & ~1;
+  GstRgaNv12 nv12 = {
+      (const guint8 *)GST_VIDEO_FRAME_PLANE_DATA(in, 0) +
+          (gsize)y * y_stride + x,
+      (const guint8 *)GST_VIDEO_FRAME_PLANE_DATA(in, 1) +
+          (gsize)(y / 2) * uv_stride + x,
+      y_stride,
+      uv_stride,
+      src->w,
+      src->h,
+  };
+
+  if (!gst_rga_software_supports(GST_VIDEO_FRAME_FORMAT(in), out_format))
+    return FALSE;
+
+  if (out_format == GST_VIDEO_FORMAT_NV12) {
+    gst_rga_software_scale_nv12(&nv12, GST_VIDEO_FRAME_PLANE_DATA(out, 0),
+                                GST_VIDEO_FRAME_PLANE_STRIDE(out, 0),
+                                GST_VIDEO_FRAME_PLANE_DATA(out, 1),
+                                GST_VIDEO_FRAME_PLANE_STRIDE(out, 1), width,
+                                height);
+    return TRUE;
+  }
+
+  if (src->w == width && src->h == height) {
+    gst_rga_software_nv12_to_rgb(&nv12, out);
+    return TRUE;
+  }
+
+  /* scale in NV12, which moves half the bytes of RGB */
+  gint scaled_stride = GST_ROUND_UP_16(width);
+  gsize y_size = (gsize)scaled_stride * GST_ROUND_UP_2(height);
+  guint8 *scaled = g_malloc(y_size + y_size / 2);
+  GstRgaNv12 dst = {
+      scaled, scaled + y_size, scaled_stride, scaled_stride, width, height,
+  };
+
+  gst_rga_software_scale_nv12(&nv12, scaled, scaled_stride, scaled + y_size,
+                              scaled_stride, width, height);
+  gst_rga_software_nv12_to_rgb(&dst, out);
+  g_free(scaled);
+  return TRUE;
+}
@@ -0,0 +1,39 @@
+/* GStreamer
+ * Copyright (C) 2025 FIXME <fixme@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Suite 500,
+ * Boston, MA 02110-1335, USA.
+ */
+#ifndef PLUGINS_GSTRGASOFTWARE_H_
+#define PLUGINS_GSTRGASOFTWARE_H_
+
+#include <gst/gst.h>
+#include <gst/video/video.h>
+
+G_BEGIN_DECLS
+
+/* TRUE if the CPU fallback handles @in to @out: NV12 to NV12 and to the
+ * 24 and 32 bit RGB formats */
+gboolean gst_rga_software_supports(GstVideoFormat in, GstVideoFormat out);
+
+/* Scales the @src rectangle of the mapped NV12 @in to the whole mapped @out
+ * and converts it with BT.601 limited range, like RGA does by default */
+gboolean gst_rga_software_convert(const GstVideoFrame *in,
+                                  const GstVideoRectangle *src,
+                                  GstVideoFrame *out);
+
+G_END_DECLS
+
+#endif  // PLUGINS_GSTRGASOFTWARE_H_
@@ -0,0 +1,175 @@
+/* GStreamer
+ * Copyright (C) 2025 FIXME <fixme@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Suite 500,
+ * Boston, MA 02110-1335, USA.
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"  // NOLINT
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "gstrgastats.h"  // NOLINT
+#include "gstrgautils.h"  // NOLINT
+
+/* indexed like GstRgaStats.core_jobs */
+static const struct {
+  guint32 core;
+  const gchar *field;
+} gst_rga_stats_cores[GST_RGA_STATS_CORES] = {
+    {IM_SCHEDULER_DEFAULT, "jobs-auto"},
+    {IM_SCHEDULER_RGA3_CORE0, "jobs-rga3-core0"},
+    {IM_SCHEDULER_RGA3_CORE1, "jobs-rga3-core1"},
+    {IM_SCHEDULER_RGA2_CORE0, "jobs-rga2-core0"},
+};
+
+void gst_rga_stats_init(GstRgaStats *stats) {
+  memset(stats, 0, sizeof(*stats));
+  g_mutex_init(&stats->lock);
+  stats->last_post = GST_CLOCK_TIME_NONE;
+}
+
+void gst_rga_stats_clear(GstRgaStats *stats) { g_mutex_clear(&stats->lock); }
+
+void gst_rga_stats_reset(GstRgaStats *stats) {
+  g_mutex_lock(&stats->lock);
+  stats->frames = stats->failed = stats->fallbacks = stats->software = 0;
+  stats->dropped = stats->batched = stats->batch_sum = stats->bytes = 0;
+  memset(stats->core_jobs, 0, sizeof(stats->core_jobs));
+  stats->latency_sum = 0;
+  stats->n_samples = stats->next_sample = 0;
+  stats->last_post = GST_CLOCK_TIME_NONE;
+  g_mutex_unlock(&stats->lock);
+}
+
+void gst_rga_stats_add_frame(GstRgaStats *stats, GstClockTime latency,
+                             guint64 bytes) {
+  g_mutex_lock(&stats->lock);
+  stats->frames++;
+  stats->bytes += bytes;
+  stats->latency_sum += latency;
+  stats->samples[stats->next_sample] = latency;
+  stats->next_sample = (stats->next_sample + 1) % GST_RGA_STATS_SAMPLES;
+  stats->n_samples = MIN(stats->n_samples + 1, GST_RGA_STATS_SAMPLES);
+  g_mutex_unlock(&stats->lock);
+}
+
+void gst_rga_stats_add_failure(GstRgaStats *stats) {
+  g_mutex_lock(&stats->lock);
+  stats->failed++;
+  g_mutex_unlock(&stats->lock);
+}
+
+guint64 gst_rga_stats_add_fallback(GstRgaStats *stats) {
+  g_mutex_lock(&stats->lock);
+  guint64 fallbacks = ++stats->fallbacks;
+  g_mutex_unlock(&stats->lock);
+  return fallbacks;
+}
+
+void gst_rga_stats_add_software(GstRgaStats *stats) {
+  g_mutex_lock(&stats->lock);
+  stats->software++;
+  g_mutex_unlock(&stats->lock);
+}
+
+void gst_rga_stats_add_drop(GstRgaStats *stats) {
+  g_mutex_lock(&stats->lock);
+  stats->dropped++;
+  g_mutex_unlock(&stats->lock);
+}
+
+void gst_rga_stats_add_batch(GstRgaStats *stats, guint batch_size) {
+  g_mutex_lock(&stats->lock);
+  stats->batched++;
+  stats->batch_sum += batch_size;
+  g_mutex_unlock(&stats->lock);
+}
+
+void gst_rga_stats_add_job(GstRgaStats *stats, guint32 core) {
+  g_mutex_lock(&stats->lock);
+  for (guint i = 0; i < GST_RGA_STATS_CORES; i++) {
+    if (gst_rga_stats_cores[i].core == core) {
+      stats->core_jobs[i]++;
+      break;
+    }
+  }
+  g_mutex_unlock(&stats->lock);
+}
+
+static gint gst_rga_stats_compare(gconstpointer a, gconstpointer b) {
+  GstClockTime x = *(const GstClockTime *)a, y = *(const GstClockTime *)b;
+
+  return x < y ? -1 : x > y;
+}
+
+static GstStructure *gst_rga_stats_to_structure_unlocked(GstRgaStats *stats) {
+  GstClockTime samples[GST_RGA_STATS_SAMPLES];
+  GstClockTime mean = 0, p99 = 0;
+  gdouble batch_mean = 0.;
+
+  /* over the whole run for the mean, the last samples for the p99 */
+  if (stats->frames) mean = stats->latency_sum / stats->frames;
+  if (stats->batched) batch_mean = (gdouble)stats->batch_sum / stats->batched;
+  if (stats->n_samples) {
+    memcpy(samples, stats->samples, stats->n_samples * sizeof(samples[0]));
+    qsort(samples, stats->n_samples, sizeof(samples[0]),
+          gst_rga_stats_compare);
+    p99 = samples[(stats->n_samples * 99 - 1) / 100];
+  }
+
+  GstStructure *s = gst_structure_new(
+      "rga-stats", "frames", G_TYPE_UINT64, stats->frames, "failed",
+      G_TYPE_UINT64, stats->failed, "fallback-frames", G_TYPE_UINT64,
+      stats->fallbacks, "software-frames", G_TYPE_UINT64, stats->software,
+      "dropped", G_TYPE_UINT64, stats->dropped, "batched-frames",
+      G_TYPE_UINT64, stats->batched, "batch-size-mean", G_TYPE_DOUBLE,
+      batch_mean, "bytes", G_TYPE_UINT64, stats->bytes, "latency-mean",
+      G_TYPE_UINT64, mean, "latency-p99", G_TYPE_UINT64, p99, NULL);
+  for (guint i = 0; i < GST_RGA_STATS_CORES; i++)
+    gst_structure_set(s, gst_rga_stats_cores[i].field, G_TYPE_UINT64,
+                      stats->core_jobs[i], NULL);
+  return s;
+}
+
+GstStructure *gst_rga_stats_to_structure(GstRgaStats *stats) {
+  g_mutex_lock(&stats->lock);
+  GstStructure *s = gst_rga_stats_to_structure_unlocked(stats);
+  g_mutex_unlock(&stats->lock);
+  return s;
+}
+
+void gst_rga_stats_post(GstRgaStats *stats, GstElement *element,
+                        GstClockTime interval) {
+  GstStructure *s = NULL;
+
+  if (!interval) return;
+
+  GstClockTime now = gst_util_get_timestamp();
+  g_mutex_lock(&stats->lock);
+  if (!GST_CLOCK_TIME_IS_VALID(stats->last_post)) {
+    stats->last_post = now;
+  } else if (now - stats->last_post >= interval) {
+    stats->last_post = now;
+    s = gst_rga_stats_to_structure_unlocked(stats);
+  }
+  g_mutex_unlock(&stats->lock);
+
+  if (s)
+    gst_element_post_message(element,
+                             gst_message_new_element(GST_OBJECT(element), s));
+}
@@ -0,0 +1,81 @@
+/* GStreamer
+ * Copyright (C) 2025 FIXME <fixme@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Suite 500,
+ * Boston, MA 02110-1335, USA.
+ */
+#ifndef PLUGINS_GSTRGASTATS_H_
+#define PLUGINS_GSTRGASTATS_H_
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+/* blit latencies kept for the percentile */
+#define GST_RGA_STATS_SAMPLES 1024
+
+/* cores a job can be pinned to, plus the ones left to the driver */
+#define GST_RGA_STATS_CORES 4
+
+typedef struct _GstRgaStats GstRgaStats;
+
+/* Counters of one element, updated from the streaming and push threads */
+struct _GstRgaStats {
+  GMutex lock;
+  guint64 frames;
+  guint64 failed;
+  guint64 fallbacks;
+  guint64 software;
+  guint64 dropped;
+  guint64 batched;
+  /* blits in the batches of the batched frames, summed */
+  guint64 batch_sum;
+  guint64 bytes;
+  guint64 core_jobs[GST_RGA_STATS_CORES];
+  GstClockTime latency_sum;
+  GstClockTime samples[GST_RGA_STATS_SAMPLES];
+  guint n_samples;
+  guint next_sample;
+  GstClockTime last_post;
+};
+
+void gst_rga_stats_init(GstRgaStats *stats);
+void gst_rga_stats_clear(GstRgaStats *stats);
+void gst_rga_stats_reset(GstRgaStats *stats);
+
+/* A frame got through RGA @latency after it was submitted */
+void gst_rga_stats_add_frame(GstRgaStats *stats, GstClockTime latency,
+                             guint64 bytes);
+void gst_rga_stats_add_failure(GstRgaStats *stats);
+/* Returns the number of CPU mapping fallbacks so far, this one included */
+guint64 gst_rga_stats_add_fallback(GstRgaStats *stats);
+/* A frame was converted on the CPU instead of RGA */
+void gst_rga_stats_add_software(GstRgaStats *stats);
+/* A frame was dropped by max-fps or load shedding before any RGA work */
+void gst_rga_stats_add_drop(GstRgaStats *stats);
+/* A frame went to RGA in a batch of @batch_size blits */
+void gst_rga_stats_add_batch(GstRgaStats *stats, guint batch_size);
+/* A job was handed to @core, 0 when the driver picks it */
+void gst_rga_stats_add_job(GstRgaStats *stats, guint32 core);
+
+GstStructure *gst_rga_stats_to_structure(GstRgaStats *stats);
+/* Posts the stats on the bus when @interval has passed since the last
+ * time, 0 disables it */
+void gst_rga_stats_post(GstRgaStats *stats, GstElement *element,
+                        GstClockTime interval);
+
+G_END_DECLS
+
+#endif  // PLUGINS_GSTRGASTATS_H_
@@ -0,0 +1,154 @@
+/* GStreamer
+ * Copyright (C) 2025 FIXME <fixme@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Suite 500,
+ * Boston, MA 02110-1335, USA.
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"  // NOLINT
+#endif
+
+#include <string.h>
+
+#include "gstrgatensormeta.h"  // NOLINT
+
+GType gst_rga_tensor_meta_api_get_type(void) {
+  static GType type = 0;
+  /* the layout follows the size of the frame */
+  static const gchar *tags[] = {GST_META_TAG_VIDEO_STR,
+                                GST_META_TAG_VIDEO_SIZE_STR, NULL};
+
+  if (g_once_init_enter(&type)) {
+    GType tmp = gst_meta_api_type_register("GstRgaTensorMetaAPI", tags);
+    g_once_init_leave(&type, tmp);
+  }
+  return type;
+}
+
+static gboolean gst_rga_tensor_meta_init(GstMeta *meta, gpointer params,
+                                         GstBuffer *buffer) {
+  GstRgaTensorMeta *tmeta = (GstRgaTensorMeta *)meta;
+
+  tmeta->layout = GST_RGA_TENSOR_LAYOUT_NHWC;
+  tmeta->format = GST_VIDEO_FORMAT_UNKNOWN;
+  memset(tmeta->dims, 0, sizeof(tmeta->dims));
+  memset(tmeta->strides, 0, sizeof(tmeta->strides));
+  tmeta->offset = 0;
+  for (guint c = 0; c < 3; c++) {
+    tmeta->mean[c] = 0.0;
+    tmeta->scale[c] = 1.0;
+  }
+  return TRUE;
+}
+
+static gboolean gst_rga_tensor_meta_transform(GstBuffer *dest, GstMeta *meta,
+                                              GstBuffer *buffer, GQuark type,
+                                              gpointer data) {
+  GstRgaTensorMeta *src = (GstRgaTensorMeta *)meta;
+
+  /* only a full copy keeps the memory layout */
+  if (!GST_META_TRANSFORM_IS_COPY(type)) return FALSE;
+
+  GstMetaTransformCopy *copy = data;
+  if (copy->region) return FALSE;
+
+  GstRgaTensorMeta *dst = (GstRgaTensorMeta *)gst_buffer_add_meta(
+      dest, GST_RGA_TENSOR_META_INFO, NULL);
+  if (!dst) return FALSE;
+
+  dst->layout = src->layout;
+  dst->format = src->format;
+  memcpy(dst->dims, src->dims, sizeof(dst->dims));
+  memcpy(dst->strides, src->strides, sizeof(dst->strides));
+  dst->offset = src->offset;
+  memcpy(dst->mean, src->mean, sizeof(dst->mean));
+  memcpy(dst->scale, src->scale, sizeof(dst->scale));
+  return TRUE;
+}
+
+const GstMetaInfo *gst_rga_tensor_meta_get_info(void) {
+  static const GstMetaInfo *info = NULL;
+
+  if (g_once_init_enter(&info)) {
+    const GstMetaInfo *tmp = gst_meta_register(
+        GST_RGA_TENSOR_META_API_TYPE, "GstRgaTensorMeta",
+        sizeof(GstRgaTensorMeta), gst_rga_tensor_meta_init, NULL,
+        gst_rga_tensor_meta_transform);
+    g_once_init_leave(&info, tmp);
+  }
+  return info;
+}
+
+GstRgaTensorMeta *gst_buffer_add_rga_tensor_meta(GstBuffer *buffer,
+                                                 const GstVideoInfo *info,
+                                                 const gdouble mean[3],
+                                                 const gdouble scale[3]) {
+  const GstVideoFormatInfo *finfo = info->finfo;
+  guint width = GST_VIDEO_INFO_WIDTH(info);
+  guint height = GST_VIDEO_INFO_HEIGHT(info);
+  gsize stride = GST_VIDEO_INFO_PLANE_STRIDE(info, 0);
+  GstRgaTensorLayout layout;
+  gsize channel_stride;
+
+  if (!GST_VIDEO_FORMAT_INFO_IS_RGB(finfo) ||
+      GST_VIDEO_FORMAT_INFO_N_COMPONENTS(finfo) != 3 ||
+      GST_VIDEO_FORMAT_INFO_BITS(finfo) != 8)
+    return NULL;
+
+  if (GST_VIDEO_INFO_N_PLANES(info) == 1) {
+    if (GST_VIDEO_FORMAT_INFO_PSTRIDE(finfo, 0) != 3) return NULL;
+    layout = GST_RGA_TENSOR_LAYOUT_NHWC;
+    channel_stride = 1;
+  } else {
+    gsize offset0 = GST_VIDEO_INFO_PLANE_OFFSET(info, 0);
+
+    /* NCHW needs the same stride and spacing for every plane */
+    channel_stride = GST_VIDEO_INFO_PLANE_OFFSET(info, 1) - offset0;
+    for (guint p = 1; p < 3; p++) {
+      if ((gsize)GST_VIDEO_INFO_PLANE_STRIDE(info, p) != stride ||
+          GST_VIDEO_INFO_PLANE_OFFSET(info, p) != offset0 + p * channel_stride)
+        return NULL;
+    }
+    layout = GST_RGA_TENSOR_LAYOUT_NCHW;
+  }
+
+  GstRgaTensorMeta *meta = (GstRgaTensorMeta *)gst_buffer_add_meta(
+      buffer, GST_RGA_TENSOR_META_INFO, NULL);
+  if (!meta) return NULL;
+
+  meta->layout = layout;
+  meta->format = GST_VIDEO_INFO_FORMAT(info);
+  meta->offset = GST_VIDEO_INFO_PLANE_OFFSET(info, 0);
+  meta->dims[0] = 1;
+  meta->strides[0] = GST_VIDEO_INFO_SIZE(info);
+  if (layout == GST_RGA_TENSOR_LAYOUT_NCHW) {
+    meta->dims[1] = 3;
+    meta->dims[2] = height;
+    meta->dims[3] = width;
+    meta->strides[1] = channel_stride;
+    meta->strides[2] = stride;
+    meta->strides[3] = 1;
+  } else {
+    meta->dims[1] = height;
+    meta->dims[2] = width;
+    meta->dims[3] = 3;
+    meta->strides[1] = stride;
+    meta->strides[2] = 3;
+    meta->strides[3] = 1;
+  }
+  memcpy(meta->mean, mean, sizeof(meta->mean));
+  memcpy(meta->scale, scale, sizeof(meta->scale));
+  return meta;
+}
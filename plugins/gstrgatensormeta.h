@@ -0,0 +1,68 @@
+/* GStreamer
+ * Copyright (C) 2025 FIXME <fixme@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Suite 500,
+ * Boston, MA 02110-1335, USA.
+ */
+#ifndef PLUGINS_GSTRGATENSORMETA_H_
+#define PLUGINS_GSTRGATENSORMETA_H_
+
+#include <gst/gst.h>
+#include <gst/video/video.h>
+
+G_BEGIN_DECLS
+
+#define GST_RGA_TENSOR_META_API_TYPE (gst_rga_tensor_meta_api_get_type())
+#define GST_RGA_TENSOR_META_INFO (gst_rga_tensor_meta_get_info())
+#define gst_buffer_get_rga_tensor_meta(b) \
+  ((GstRgaTensorMeta *)gst_buffer_get_meta((b), GST_RGA_TENSOR_META_API_TYPE))
+
+typedef enum {
+  GST_RGA_TENSOR_LAYOUT_NHWC,
+  GST_RGA_TENSOR_LAYOUT_NCHW,
+} GstRgaTensorLayout;
+
+typedef struct _GstRgaTensorMeta GstRgaTensorMeta;
+
+/* Describes an RGB output frame as a uint8 tensor an NPU can import from
+ * the dmabuf: @dims and @strides (in bytes) are in @layout order, N first,
+ * and the first element is at @offset. @format tells the channel order.
+ * The values are not normalized; @mean and @scale are what the model
+ * expects, (value - mean) * scale per channel, for the runtime to apply. */
+struct _GstRgaTensorMeta {
+  GstMeta meta;
+
+  GstRgaTensorLayout layout;
+  GstVideoFormat format;
+  guint dims[4];
+  gsize strides[4];
+  gsize offset;
+  gdouble mean[3];
+  gdouble scale[3];
+};
+
+GType gst_rga_tensor_meta_api_get_type(void);
+const GstMetaInfo *gst_rga_tensor_meta_get_info(void);
+
+/* Adds the tensor layout of a frame of @info, which must be packed or
+ * planar RGB with equally spaced planes. Returns NULL otherwise. */
+GstRgaTensorMeta *gst_buffer_add_rga_tensor_meta(GstBuffer *buffer,
+                                                 const GstVideoInfo *info,
+                                                 const gdouble mean[3],
+                                                 const gdouble scale[3]);
+
+G_END_DECLS
+
+#endif  // PLUGINS_GSTRGATENSORMETA_H_
@@ -0,0 +1,199 @@
+/* GStreamer
+ * Copyright (C) 2025 FIXME <fixme@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Suite 500,
+ * Boston, MA 02110-1335, USA.
+ */
+/**
+ * SECTION:tracer-rgajobs
+ *
+ * The rgajobs tracer logs one record per RGA job with the time spent in
+ * the submit ioctl and the time until its release fence signalled, tagged
+ * with the element and the core. librga doesn't tell when the hardware
+ * actually started, so the second part is queueing plus execution.
+ *
+ * The records go to the GST_TRACER log like those of the core tracers.
+ * With a file parameter the jobs are also written as Chrome trace events,
+ * one track per core, which ui.perfetto.dev and chrome://tracing open:
+ * |[
+ * GST_TRACERS="rgajobs(file=/tmp/rga.json)" GST_DEBUG="GST_TRACER:7" \
+ *   gst-launch-1.0 ...
+ * ]|
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"  // NOLINT
+#endif
+
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "gstrgatracer.h"  // NOLINT
+#include "gstrgautils.h"   // NOLINT
+
+GST_DEBUG_CATEGORY_STATIC(gst_rga_tracer_debug);
+#define GST_CAT_DEFAULT gst_rga_tracer_debug
+
+G_DEFINE_TYPE_WITH_CODE(GstRgaTracer, gst_rga_tracer, GST_TYPE_TRACER,
+                        GST_DEBUG_CATEGORY_INIT(gst_rga_tracer_debug, "rgajobs",
+                                                0, "RGA job tracer"));
+
+static GstTracerRecord *tr_job;
+/* the elements log into the last tracer created */
+static GstRgaTracer *gst_rga_tracer_instance;
+
+/* Name of the first core in @core, "auto" when the driver picks it */
+static const gchar *gst_rga_tracer_core_name(guint32 core) {
+  GFlagsClass *klass = g_type_class_peek(gst_rga_core_mask_get_type());
+  GFlagsValue *value = g_flags_get_first_value(klass, core);
+
+  return value ? value->value_nick : "unknown";
+}
+
+static void gst_rga_tracer_write_events(GstRgaTracer *self,
+                                        const gchar *element, guint32 core,
+                                        GstClockTime submit,
+                                        GstClockTime submitted,
+                                        GstClockTime done) {
+  const gchar *core_name = gst_rga_tracer_core_name(core);
+  long tid = syscall(SYS_gettid);
+
+  /* timestamps are in microseconds, the trailing ] is optional */
+  g_mutex_lock(&self->lock);
+  guint64 id = self->seq++;
+  fprintf(self->file,
+          "%s{\"name\":\"submit\",\"cat\":\"rga\",\"ph\":\"X\",\"pid\":%d,"
+          "\"tid\":%ld,\"ts\":%.3f,\"dur\":%.3f,"
+          "\"args\":{\"element\":\"%s\",\"core\":\"%s\"}}",
+          id ? ",\n" : "[\n", getpid(), tid, submit / 1000.0,
+          (submitted - submit) / 1000.0, element, core_name);
+  fprintf(self->file,
+          ",\n{\"name\":\"%s\",\"cat\":\"rga\",\"ph\":\"b\","
+          "\"id\":%" G_GUINT64_FORMAT
+          ",\"pid\":%d,\"ts\":%.3f,\"args\":{\"element\":\"%s\"}}",
+          core_name, id, getpid(), submitted / 1000.0, element);
+  fprintf(self->file,
+          ",\n{\"name\":\"%s\",\"cat\":\"rga\",\"ph\":\"e\","
+          "\"id\":%" G_GUINT64_FORMAT
+          ",\"pid\":%d,\"ts\":%.3f}",
+          core_name, id, getpid(), done / 1000.0);
+  fflush(self->file);
+  g_mutex_unlock(&self->lock);
+}
+
+void gst_rga_tracer_log_job(GstObject *element, guint32 core,
+                            GstClockTime submit, GstClockTime submitted,
+                            GstClockTime done) {
+  GstRgaTracer *self = g_atomic_pointer_get(&gst_rga_tracer_instance);
+
+  if (!self) return;
+
+  /* relative to the tracer start like the ts of the core tracers */
+  submit = GST_CLOCK_DIFF(self->start, submit);
+  submitted = GST_CLOCK_DIFF(self->start, submitted);
+  done = GST_CLOCK_DIFF(self->start, done);
+
+  gchar *name = gst_object_get_name(element);
+  gst_tracer_record_log(tr_job, (guint64)done, name,
+                        gst_rga_tracer_core_name(core), (guint64)submit,
+                        (guint64)(submitted - submit),
+                        (guint64)(done - submitted), (guint64)(done - submit));
+  if (self->file)
+    gst_rga_tracer_write_events(self, name, core, submit, submitted, done);
+  g_free(name);
+}
+
+static void gst_rga_tracer_constructed(GObject *object) {
+  GstRgaTracer *self = GST_RGA_TRACER(object);
+  gchar *params = NULL;
+
+  G_OBJECT_CLASS(gst_rga_tracer_parent_class)->constructed(object);
+
+  g_object_get(self, "params", &params, NULL);
+  if (params) {
+    gchar *desc = g_strdup_printf("rgajobs,%s", params);
+    GstStructure *s = gst_structure_from_string(desc, NULL);
+    const gchar *path = s ? gst_structure_get_string(s, "file") : NULL;
+
+    if (path) {
+      self->file = fopen(path, "w");
+      if (!self->file) GST_WARNING_OBJECT(self, "cannot open %s", path);
+    }
+    if (s) gst_structure_free(s);
+    g_free(desc);
+    g_free(params);
+  }
+
+  g_atomic_pointer_set(&gst_rga_tracer_instance, self);
+}
+
+static void gst_rga_tracer_finalize(GObject *object) {
+  GstRgaTracer *self = GST_RGA_TRACER(object);
+
+  g_atomic_pointer_compare_and_exchange(&gst_rga_tracer_instance, self, NULL);
+  if (self->file) {
+    fputs(self->seq ? "\n]\n" : "[]\n", self->file);
+    fclose(self->file);
+  }
+  g_mutex_clear(&self->lock);
+
+  G_OBJECT_CLASS(gst_rga_tracer_parent_class)->finalize(object);
+}
+
+static GstStructure *gst_rga_tracer_field(GType type, const gchar *desc) {
+  return gst_structure_new("value", "type", G_TYPE_GTYPE, type, "related-to",
+                           GST_TYPE_TRACER_VALUE_SCOPE,
+                           GST_TRACER_VALUE_SCOPE_ELEMENT, "description",
+                           G_TYPE_STRING, desc, NULL);
+}
+
+static void gst_rga_tracer_class_init(GstRgaTracerClass *klass) {
+  GObjectClass *gobject_class = G_OBJECT_CLASS(klass);
+
+  gobject_class->constructed = gst_rga_tracer_constructed;
+  gobject_class->finalize = gst_rga_tracer_finalize;
+
+  /* for gst_rga_tracer_core_name() */
+  g_type_class_ref(gst_rga_core_mask_get_type());
+
+  tr_job = gst_tracer_record_new(
+      "rga-job.class",
+      "ts", GST_TYPE_STRUCTURE,
+      gst_structure_new("value", "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+                        "related-to", GST_TYPE_TRACER_VALUE_SCOPE,
+                        GST_TRACER_VALUE_SCOPE_PROCESS, "description",
+                        G_TYPE_STRING, "when the fence signalled", NULL),
+      "element", GST_TYPE_STRUCTURE,
+      gst_rga_tracer_field(G_TYPE_STRING, "element that submitted the job"),
+      "core", GST_TYPE_STRUCTURE,
+      gst_rga_tracer_field(G_TYPE_STRING, "core the job was pinned to"),
+      "submit", GST_TYPE_STRUCTURE,
+      gst_rga_tracer_field(G_TYPE_UINT64, "when the job was submitted"),
+      "ioctl", GST_TYPE_STRUCTURE,
+      gst_rga_tracer_field(G_TYPE_UINT64, "time spent submitting"),
+      "hardware", GST_TYPE_STRUCTURE,
+      gst_rga_tracer_field(G_TYPE_UINT64,
+                           "time from submission to the fence, queueing "
+                           "included"),
+      "wall", GST_TYPE_STRUCTURE,
+      gst_rga_tracer_field(G_TYPE_UINT64, "time from submit to the fence"),
+      NULL);
+  GST_OBJECT_FLAG_SET(tr_job, GST_OBJECT_FLAG_MAY_BE_LEAKED);
+}
+
+static void gst_rga_tracer_init(GstRgaTracer *self) {
+  self->start = gst_util_get_timestamp();
+  g_mutex_init(&self->lock);
+}
@@ -0,0 +1,60 @@
+/* GStreamer
+ * Copyright (C) 2025 FIXME <fixme@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Suite 500,
+ * Boston, MA 02110-1335, USA.
+ */
+#ifndef PLUGINS_GSTRGATRACER_H_
+#define PLUGINS_GSTRGATRACER_H_
+
+#include <gst/gst.h>
+#include <stdio.h>
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_RGA_TRACER (gst_rga_tracer_get_type())
+#define GST_RGA_TRACER(obj) \
+  (G_TYPE_CHECK_INSTANCE_CAST((obj), GST_TYPE_RGA_TRACER, GstRgaTracer))
+
+typedef struct _GstRgaTracer GstRgaTracer;
+typedef struct _GstRgaTracerClass GstRgaTracerClass;
+
+/* Logs every RGA job the elements submit, see gst_rga_tracer_log_job() */
+struct _GstRgaTracer {
+  GstTracer parent;
+  GstClockTime start;
+
+  /* Chrome trace events for Perfetto, protected by lock */
+  GMutex lock;
+  FILE *file;
+  guint64 seq;
+};
+
+struct _GstRgaTracerClass {
+  GstTracerClass parent_class;
+};
+
+GType gst_rga_tracer_get_type(void);
+
+/* Records a job of @element on @core: submitted at @submit, the ioctl
+ * returned at @submitted and its fence signalled at @done. A no-op unless
+ * GST_TRACERS enables rgajobs. */
+void gst_rga_tracer_log_job(GstObject *element, guint32 core,
+                            GstClockTime submit, GstClockTime submitted,
+                            GstClockTime done);
+
+G_END_DECLS
+
+#endif  // PLUGINS_GSTRGATRACER_H_
@@ -0,0 +1,1007 @@
+/* GStreamer
+ * Copyright (C) 2025 FIXME <fixme@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Suite 500,
+ * Boston, MA 02110-1335, USA.
+ */
+/*
+ * Helpers shared by the RGA elements: pad template caps, describing GStreamer
+ * buffers as RGA images and dmabuf pools for the output.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"  // NOLINT
+#endif
+
+#include <gst/allocators/gstdmabuf.h>
+#include <gst/video/gstvideopool.h>
+#include <string.h>
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+#endif
+
+#include "gstrgaallocator.h"   // NOLINT
+#include "gstrgabufferpool.h"  // NOLINT
+#include "gstrgadevice.h"      // NOLINT
+#include "gstrgautils.h"       // NOLINT
+
+GST_DEBUG_CATEGORY_STATIC(gst_rga_utils_debug_category);
+#define GST_CAT_DEFAULT gst_rga_utils_debug_category
+
+#define GST_CASE_RETURN(a, b) \
+  case a:                     \
+    return b
+
+void gst_rga_utils_init(void) {
+  GST_DEBUG_CATEGORY_INIT(gst_rga_utils_debug_category, "rgautils", 0,
+                          "RGA helpers");
+}
+
+GType gst_rga_core_mask_get_type(void) {
+  static GType type = 0;
+  static const GFlagsValue values[] = {
+      {IM_SCHEDULER_DEFAULT, "auto", "auto"},
+      {IM_SCHEDULER_RGA3_CORE0, "rga3_core0", "rga3_core0"},
+      {IM_SCHEDULER_RGA3_CORE1, "rga3_core1", "rga3_core1"},
+      {IM_SCHEDULER_RGA2_CORE0, "rga2_core0", "rga2_core0"},
+      {IM_SCHEDULER_RGA3_CORE0 | IM_SCHEDULER_RGA3_CORE1, "rga3", "rga3"},
+      {IM_SCHEDULER_RGA2_CORE0, "rga2", "rga2"},
+      {0, NULL, NULL}};
+
+  if (g_once_init_enter(&type)) {
+    GType tmp = g_flags_register_static("GstRgaCoreMask", values);
+    g_once_init_leave(&type, tmp);
+  }
+  return type;
+}
+
+GType gst_rga_color_space_get_type(void) {
+  static GType type = 0;
+  static const GEnumValue values[] = {
+      {GST_RGA_COLOR_SPACE_AUTO, "From the caps colorimetry", "auto"},
+      {GST_RGA_COLOR_SPACE_BT601_LIMITED, "BT.601 limited range",
+       "bt601-limited"},
+      {GST_RGA_COLOR_SPACE_BT601_FULL, "BT.601 full range", "bt601-full"},
+      {GST_RGA_COLOR_SPACE_BT709_LIMITED, "BT.709 limited range",
+       "bt709-limited"},
+      {0, NULL, NULL}};
+
+  if (g_once_init_enter(&type)) {
+    GType tmp = g_enum_register_static("GstRgaColorSpace", values);
+    g_once_init_leave(&type, tmp);
+  }
+  return type;
+}
+
+GstRgaColorSpace gst_rga_color_space_from_info(const GstVideoInfo *info,
+                                               gboolean *exact) {
+  gboolean full = info->colorimetry.range == GST_VIDEO_COLOR_RANGE_0_255;
+
+  *exact = TRUE;
+  switch (info->colorimetry.matrix) {
+    case GST_VIDEO_COLOR_MATRIX_BT709:
+    case GST_VIDEO_COLOR_MATRIX_SMPTE240M:
+    case GST_VIDEO_COLOR_MATRIX_BT2020:
+      /* a wrong range shows more than slightly wrong coefficients */
+      *exact =
+          !full && info->colorimetry.matrix == GST_VIDEO_COLOR_MATRIX_BT709;
+      return full ? GST_RGA_COLOR_SPACE_BT601_FULL
+                  : GST_RGA_COLOR_SPACE_BT709_LIMITED;
+    default:
+      return full ? GST_RGA_COLOR_SPACE_BT601_FULL
+                  : GST_RGA_COLOR_SPACE_BT601_LIMITED;
+  }
+}
+
+int gst_rga_color_space_mode(GstVideoFormat in, GstVideoFormat out,
+                             GstRgaColorSpace space) {
+  gboolean in_yuv = GST_VIDEO_FORMAT_INFO_IS_YUV(gst_video_format_get_info(in));
+  gboolean out_yuv =
+      GST_VIDEO_FORMAT_INFO_IS_YUV(gst_video_format_get_info(out));
+
+  if (in_yuv && !out_yuv) {
+    switch (space) {
+      GST_CASE_RETURN(GST_RGA_COLOR_SPACE_BT601_LIMITED,
+                      IM_YUV_TO_RGB_BT601_LIMIT);
+      GST_CASE_RETURN(GST_RGA_COLOR_SPACE_BT601_FULL,
+                      IM_YUV_TO_RGB_BT601_FULL);
+      GST_CASE_RETURN(GST_RGA_COLOR_SPACE_BT709_LIMITED,
+                      IM_YUV_TO_RGB_BT709_LIMIT);
+      default:
+        break;
+    }
+  } else if (!in_yuv && out_yuv) {
+    switch (space) {
+      GST_CASE_RETURN(GST_RGA_COLOR_SPACE_BT601_LIMITED,
+                      IM_RGB_TO_YUV_BT601_LIMIT);
+      GST_CASE_RETURN(GST_RGA_COLOR_SPACE_BT601_FULL,
+                      IM_RGB_TO_YUV_BT601_FULL);
+      GST_CASE_RETURN(GST_RGA_COLOR_SPACE_BT709_LIMITED,
+                      IM_RGB_TO_YUV_BT709_LIMIT);
+      default:
+        break;
+    }
+  }
+  return IM_COLOR_SPACE_DEFAULT;
+}
+
+/* caps */
+
+#if GST_CHECK_VERSION(1, 24, 0)
+/* Formats RGA3 reads and writes AFBC compressed */
+static gboolean gst_rga_format_supports_afbc(GstVideoFormat format) {
+  return format == GST_VIDEO_FORMAT_NV12 || format == GST_VIDEO_FORMAT_NV16;
+}
+#endif
+
+GstCaps *gst_rga_template_caps(const gchar *desc) {
+  GstCaps *sysmem = gst_caps_from_string(desc);
+  GstStructure *structure = gst_caps_get_structure(sysmem, 0);
+  GstCaps *caps = gst_caps_new_empty();
+
+#if GST_CHECK_VERSION(1, 24, 0)
+  const GValue *formats = gst_structure_get_value(structure, "format");
+  GValue drm_formats = G_VALUE_INIT;
+
+  gst_value_list_init(&drm_formats, gst_value_list_get_size(formats));
+  for (guint i = 0; i < gst_value_list_get_size(formats); i++) {
+    GstVideoFormat format = gst_video_format_from_string(
+        g_value_get_string(gst_value_list_get_value(formats, i)));
+    guint32 fourcc = gst_video_dma_drm_fourcc_from_format(format);
+    if (fourcc == DRM_FORMAT_INVALID) continue;
+
+    GValue item = G_VALUE_INIT;
+    g_value_init(&item, G_TYPE_STRING);
+    g_value_take_string(&item, gst_video_dma_drm_fourcc_to_string(
+                                   fourcc, DRM_FORMAT_MOD_LINEAR));
+    gst_value_list_append_and_take_value(&drm_formats, &item);
+
+    if (gst_rga_format_supports_afbc(format)) {
+      g_value_init(&item, G_TYPE_STRING);
+      g_value_take_string(&item, gst_video_dma_drm_fourcc_to_string(
+                                     fourcc, GST_RGA_AFBC_MODIFIER));
+      gst_value_list_append_and_take_value(&drm_formats, &item);
+    }
+  }
+
+  GstStructure *drm = gst_structure_copy(structure);
+  gst_structure_set(drm, "format", G_TYPE_STRING, "DMA_DRM", NULL);
+  gst_structure_take_value(drm, "drm-format", &drm_formats);
+  gst_caps_append_structure_full(
+      caps, drm, gst_caps_features_new(GST_CAPS_FEATURE_MEMORY_DMABUF, NULL));
+#else
+  gst_caps_append_structure_full(
+      caps, gst_structure_copy(structure),
+      gst_caps_features_new(GST_CAPS_FEATURE_MEMORY_DMABUF, NULL));
+#endif
+
+  return gst_caps_merge(caps, sysmem);
+}
+
+GstCaps *gst_rga_caps_to_plain(GstCaps *caps, guint64 *modifier) {
+  if (modifier) *modifier = DRM_FORMAT_MOD_LINEAR;
+
+#if GST_CHECK_VERSION(1, 24, 0)
+  if (gst_video_is_dma_drm_caps(caps)) {
+    GstVideoInfoDmaDrm drm_info;
+
+    if (!gst_video_info_dma_drm_from_caps(&drm_info, caps)) return NULL;
+
+    GstVideoFormat format =
+        gst_video_dma_drm_fourcc_to_format(drm_info.drm_fourcc);
+    if (format == GST_VIDEO_FORMAT_UNKNOWN) return NULL;
+    if (drm_info.drm_modifier != DRM_FORMAT_MOD_LINEAR &&
+        !(drm_info.drm_modifier == GST_RGA_AFBC_MODIFIER &&
+          gst_rga_format_supports_afbc(format)))
+      return NULL;
+
+    GstCaps *plain = gst_caps_copy(caps);
+    GstStructure *structure = gst_caps_get_structure(plain, 0);
+    gst_structure_set(structure, "format", G_TYPE_STRING,
+                      gst_video_format_to_string(format), NULL);
+    gst_structure_remove_field(structure, "drm-format");
+    gst_caps_set_features(plain, 0, NULL);
+
+    if (modifier) *modifier = drm_info.drm_modifier;
+    return plain;
+  }
+#endif
+  return gst_caps_ref(caps);
+}
+
+GstCaps *gst_rga_caps_any_memory(GstStructure *structure,
+                                 GstCapsFeatures *features) {
+  GstCaps *memory = gst_caps_new_empty();
+
+  gst_structure_remove_fields(structure, "format", "drm-format",
+                              "colorimetry", "chroma-site", NULL);
+  gst_caps_append_structure_full(memory, gst_structure_copy(structure),
+                                 gst_caps_features_copy(features));
+  gst_caps_append_structure_full(
+      memory, gst_structure_copy(structure),
+      gst_caps_features_new(GST_CAPS_FEATURE_MEMORY_DMABUF, NULL));
+  gst_caps_append_structure_full(
+      memory, structure,
+      gst_caps_features_new(GST_CAPS_FEATURE_MEMORY_SYSTEM_MEMORY, NULL));
+  return memory;
+}
+
+/* Size of an AFBC 16x16 buffer: a 16 byte header per block, 4 KiB
+ * aligned, followed by the blocks at their uncompressed size */
+static gsize gst_rga_afbc_size(const GstVideoInfo *info) {
+  guint width = GST_ROUND_UP_16(GST_VIDEO_INFO_WIDTH(info));
+  guint height = GST_ROUND_UP_16(GST_VIDEO_INFO_HEIGHT(info));
+  GstVideoInfo blocks;
+
+  gst_video_info_set_format(&blocks, GST_VIDEO_INFO_FORMAT(info), width,
+                            height);
+  return GST_ROUND_UP_N((width / 16) * (height / 16) * 16, 4096) +
+         GST_VIDEO_INFO_SIZE(&blocks);
+}
+
+/* RGA images */
+
+RgaSURF_FORMAT gst_gst_format_to_rga_format(GstVideoFormat format) {
+  switch (format) {
+    GST_CASE_RETURN(GST_VIDEO_FORMAT_I420, RK_FORMAT_YCbCr_420_P);
+    GST_CASE_RETURN(GST_VIDEO_FORMAT_YV12, RK_FORMAT_YCrCb_420_P);
+    GST_CASE_RETURN(GST_VIDEO_FORMAT_NV12, RK_FORMAT_YCbCr_420_SP);
+    GST_CASE_RETURN(GST_VIDEO_FORMAT_NV21, RK_FORMAT_YCrCb_420_SP);
+#ifdef HAVE_NV12_10LE40
+    GST_CASE_RETURN(GST_VIDEO_FORMAT_NV12_10LE40, RK_FORMAT_YCbCr_420_SP_10B);
+#endif
+    GST_CASE_RETURN(GST_VIDEO_FORMAT_Y42B, RK_FORMAT_YCbCr_422_P);
+    GST_CASE_RETURN(GST_VIDEO_FORMAT_NV16, RK_FORMAT_YCbCr_422_SP);
+    GST_CASE_RETURN(GST_VIDEO_FORMAT_NV61, RK_FORMAT_YCrCb_422_SP);
+    GST_CASE_RETURN(GST_VIDEO_FORMAT_RGB16, RK_FORMAT_RGB_565);
+    GST_CASE_RETURN(GST_VIDEO_FORMAT_RGB15, RK_FORMAT_RGBA_5551);
+    GST_CASE_RETURN(GST_VIDEO_FORMAT_BGR, RK_FORMAT_BGR_888);
+    GST_CASE_RETURN(GST_VIDEO_FORMAT_RGB, RK_FORMAT_RGB_888);
+    GST_CASE_RETURN(GST_VIDEO_FORMAT_BGRA, RK_FORMAT_BGRA_8888);
+    GST_CASE_RETURN(GST_VIDEO_FORMAT_RGBA, RK_FORMAT_RGBA_8888);
+    GST_CASE_RETURN(GST_VIDEO_FORMAT_BGRx, RK_FORMAT_BGRX_8888);
+    GST_CASE_RETURN(GST_VIDEO_FORMAT_RGBx, RK_FORMAT_RGBX_8888);
+    default:
+      return RK_FORMAT_UNKNOWN;
+  }
+}
+
+gboolean gst_set_rga_info(rga_buffer_t *info, im_rect *rect,
+                          RgaSURF_FORMAT format, guint x, guint y, guint width,
+                          guint height, guint hstride, guint vstride) {
+  gint pixel_stride;
+
+  switch (format) {
+    case RK_FORMAT_RGBX_8888:
+    case RK_FORMAT_BGRX_8888:
+    case RK_FORMAT_RGBA_8888:
+    case RK_FORMAT_BGRA_8888:
+      pixel_stride = 4;
+      break;
+    case RK_FORMAT_RGB_888:
+    case RK_FORMAT_BGR_888:
+      pixel_stride = 3;
+      break;
+    case RK_FORMAT_RGBA_5551:
+    case RK_FORMAT_RGB_565:
+      pixel_stride = 2;
+      break;
+    case RK_FORMAT_YCbCr_420_SP_10B:
+    case RK_FORMAT_YCbCr_422_SP:
+    case RK_FORMAT_YCrCb_422_SP:
+    case RK_FORMAT_YCbCr_422_P:
+    case RK_FORMAT_YCrCb_422_P:
+    case RK_FORMAT_YCbCr_420_SP:
+    case RK_FORMAT_YCrCb_420_SP:
+    case RK_FORMAT_YCbCr_420_P:
+    case RK_FORMAT_YCrCb_420_P:
+      pixel_stride = 1;
+
+      /* RGA requires yuv image rect align to 2 */
+      width &= ~1;
+      height &= ~1;
+      break;
+    default:
+      return FALSE;
+  }
+
+  if (format == RK_FORMAT_YCbCr_420_SP_10B) {
+    /* 10 bit strides are in bytes, 4 pixels per 5 bytes, RGA wants pixels.
+     * It rounds the bytes of a line up to a 32-bit word, so a 4-byte
+     * aligned stride, as MPP gives, need not be a whole number of pixels */
+    if (hstride % 5 && hstride % 4) {
+      GST_WARNING("10 bit stride of %u bytes is neither whole pixels nor "
+                  "4-byte aligned, RGA cannot express it", hstride);
+      return FALSE;
+    }
+    hstride = hstride * 4 / 5;
+  } else if (hstride / pixel_stride >= width) {
+    hstride /= pixel_stride;
+  }
+
+  info->width = width;
+  info->height = height;
+  info->wstride = hstride;
+  info->hstride = vstride;
+  info->format = format;
+
+  rect->x = x;
+  rect->y = y;
+  rect->width = width;
+  rect->height = height;
+  return TRUE;
+}
+
+/* First component stored in each plane of @finfo */
+static void gst_rga_plane_components(const GstVideoFormatInfo *finfo,
+                                     gint comp[GST_VIDEO_MAX_PLANES]) {
+  for (guint p = 0; p < GST_VIDEO_MAX_PLANES; p++) comp[p] = -1;
+  for (gint c = GST_VIDEO_FORMAT_INFO_N_COMPONENTS(finfo) - 1; c >= 0; c--)
+    comp[GST_VIDEO_FORMAT_INFO_PLANE(finfo, c)] = c;
+}
+
+/* RGA only takes the address of the luma plane and derives the other
+ * planes from the strides and the vertical stride. Given the byte position
+ * of every plane of @vinfo relative to a common base, find the image
+ * origin (@x, @y) and the vertical stride that make RGA address all of
+ * them, or return FALSE if no such layout exists. */
+static gboolean gst_rga_solve_layout(const GstVideoInfo *vinfo,
+                                     const gsize *offsets, guint *x, guint *y,
+                                     guint *vstride) {
+  const GstVideoFormatInfo *finfo = vinfo->finfo;
+  guint n_planes = GST_VIDEO_INFO_N_PLANES(vinfo);
+  gint stride = GST_VIDEO_INFO_PLANE_STRIDE(vinfo, 0);
+  gint comp[GST_VIDEO_MAX_PLANES];
+
+  if (stride <= 0) return FALSE;
+  gst_rga_plane_components(finfo, comp);
+
+  /* packed 10 bit formats have no pixel stride, x must be 0 there */
+  gint pstride = GST_VIDEO_FORMAT_INFO_PSTRIDE(finfo, comp[0]);
+  gsize skip = offsets[0] % stride;
+  if (pstride ? skip % pstride : skip) return FALSE;
+
+  *y = offsets[0] / stride;
+  *x = pstride ? skip / pstride : 0;
+  gsize base = offsets[0] - (gsize)*y * stride - skip;
+
+  if (n_planes == 1) {
+    *vstride = *y + GST_VIDEO_INFO_HEIGHT(vinfo);
+    return TRUE;
+  }
+
+  /* subsampled planes need an even origin */
+  if ((*x | *y) & 1) return FALSE;
+
+  gsize plane_start = 0;
+  guint height = 0;
+  for (guint p = 1; p < n_planes; p++) {
+    gint c = comp[p];
+    gint cstride = GST_VIDEO_INFO_PLANE_STRIDE(vinfo, p);
+    gint cpstride = GST_VIDEO_FORMAT_INFO_PSTRIDE(finfo, c);
+    gint expected = stride;
+    if (pstride)
+      expected =
+          GST_VIDEO_FORMAT_INFO_SCALE_WIDTH(finfo, c, stride / pstride) *
+          cpstride;
+    if (cstride != expected) return FALSE;
+
+    gsize origin =
+        (gsize)GST_VIDEO_FORMAT_INFO_SCALE_HEIGHT(finfo, c, *y) * cstride +
+        (cpstride ? GST_VIDEO_FORMAT_INFO_SCALE_WIDTH(finfo, c, *x) * cpstride
+                  : 0);
+    if (offsets[p] < base + origin) return FALSE;
+
+    gsize pos = offsets[p] - base - origin;
+    if (p == 1) {
+      if (pos % stride) return FALSE;
+      height = pos / stride;
+      if (height < *y + GST_VIDEO_INFO_HEIGHT(vinfo)) return FALSE;
+      plane_start = pos;
+    } else if (pos != plane_start) {
+      return FALSE;
+    }
+    plane_start +=
+        (gsize)cstride * GST_VIDEO_FORMAT_INFO_SCALE_HEIGHT(finfo, c, height);
+  }
+
+  *vstride = height;
+  return TRUE;
+}
+
+guint32 gst_rga_color_from_argb(guint32 argb) {
+  return (argb & 0xff00ff00) | ((argb >> 16) & 0xff) | ((argb & 0xff) << 16);
+}
+
+gboolean gst_rga_clip_rect(const im_rect *rect, gint in_width, gint in_height,
+                           gint out_width, gint out_height, im_rect *src_rect,
+                           im_rect *dst_rect) {
+  gint x0 = CLAMP(rect->x, 0, out_width);
+  gint y0 = CLAMP(rect->y, 0, out_height);
+  gint x1 = CLAMP(rect->x + rect->width, 0, out_width);
+  gint y1 = CLAMP(rect->y + rect->height, 0, out_height);
+
+  /* even rectangles keep the chroma planes aligned */
+  dst_rect->x = GST_ROUND_UP_2(x0);
+  dst_rect->y = GST_ROUND_UP_2(y0);
+  dst_rect->width = (x1 - dst_rect->x) & ~1;
+  dst_rect->height = (y1 - dst_rect->y) & ~1;
+  if (dst_rect->width <= 0 || dst_rect->height <= 0) return FALSE;
+
+  /* the visible part of the source, in proportion */
+  src_rect->x = gst_util_uint64_scale_int(dst_rect->x - rect->x, in_width,
+                                          rect->width) & ~1;
+  src_rect->y = gst_util_uint64_scale_int(dst_rect->y - rect->y, in_height,
+                                          rect->height) & ~1;
+  src_rect->width =
+      gst_util_uint64_scale_int(dst_rect->width, in_width, rect->width) & ~1;
+  src_rect->height =
+      gst_util_uint64_scale_int(dst_rect->height, in_height, rect->height) &
+      ~1;
+  src_rect->width = MIN(src_rect->width, in_width - src_rect->x);
+  src_rect->height = MIN(src_rect->height, in_height - src_rect->y);
+  return src_rect->width > 0 && src_rect->height > 0;
+}
+
+GstVideoFormat gst_rga_planar_rgb_packed_format(GstVideoFormat format) {
+  switch (format) {
+#ifdef HAVE_RGBP
+    GST_CASE_RETURN(GST_VIDEO_FORMAT_RGBP, GST_VIDEO_FORMAT_RGB);
+    GST_CASE_RETURN(GST_VIDEO_FORMAT_BGRP, GST_VIDEO_FORMAT_BGR);
+#endif
+    default:
+      return GST_VIDEO_FORMAT_UNKNOWN;
+  }
+}
+
+void gst_rga_deinterleave_rgb(const GstVideoFrame *packed,
+                              GstVideoFrame *planar) {
+  const GstVideoFormatInfo *finfo = packed->info.finfo;
+  gint width = GST_VIDEO_FRAME_WIDTH(planar);
+  gint height = GST_VIDEO_FRAME_HEIGHT(planar);
+  gint in_stride = GST_VIDEO_FRAME_PLANE_STRIDE(packed, 0);
+  const guint8 *in = GST_VIDEO_FRAME_PLANE_DATA(packed, 0);
+  guint8 *out[3];
+  gint out_stride[3];
+
+  /* the planes in the order of the bytes of a packed pixel */
+  for (guint c = 0; c < 3; c++) {
+    guint i = GST_VIDEO_FORMAT_INFO_POFFSET(finfo, c);
+
+    out[i] = GST_VIDEO_FRAME_COMP_DATA(planar, c);
+    out_stride[i] = GST_VIDEO_FRAME_COMP_STRIDE(planar, c);
+  }
+
+  for (gint y = 0; y < height; y++) {
+    const guint8 *s = in + (gsize)y * in_stride;
+    guint8 *d0 = out[0] + (gsize)y * out_stride[0];
+    guint8 *d1 = out[1] + (gsize)y * out_stride[1];
+    guint8 *d2 = out[2] + (gsize)y * out_stride[2];
+    gint x = 0;
+
+#ifdef __ARM_NEON
+    for (; x + 16 <= width; x += 16) {
+      uint8x16x3_t px = vld3q_u8(s + x * 3);
+
+      vst1q_u8(d0 + x, px.val[0]);
+      vst1q_u8(d1 + x, px.val[1]);
+      vst1q_u8(d2 + x, px.val[2]);
+    }
+#endif
+    for (; x < width; x++) {
+      d0[x] = s[x * 3];
+      d1[x] = s[x * 3 + 1];
+      d2[x] = s[x * 3 + 2];
+    }
+  }
+}
+
+gboolean gst_rga_buffer_is_dma32(GstBuffer *buffer) {
+  guint n = gst_buffer_n_memory(buffer);
+
+  for (guint i = 0; i < n; i++) {
+    GstAllocator *allocator = gst_buffer_peek_memory(buffer, i)->allocator;
+
+    if (!GST_IS_RGA_ALLOCATOR(allocator) ||
+        !strstr(GST_RGA_ALLOCATOR(allocator)->heap_name, "dma32"))
+      return FALSE;
+  }
+  return n > 0;
+}
+
+/* Finds the memory holding plane @plane of @frame and the byte position
+ * of the plane inside that memory's dmabuf */
+static GstMemory *gst_rga_frame_find_plane(GstVideoFrame *frame, guint plane,
+                                           gsize *offset) {
+  guint idx, length;
+  gsize skip;
+
+  if (!gst_buffer_find_memory(frame->buffer,
+                              GST_VIDEO_FRAME_PLANE_OFFSET(frame, plane), 1,
+                              &idx, &length, &skip))
+    return NULL;
+
+  GstMemory *mem = gst_buffer_peek_memory(frame->buffer, idx);
+  *offset = mem->offset + skip;
+  return mem;
+}
+
+/* Copies @rows rows of @row_bytes between two dmabufs with RGA, seen as
+ * 32 bit pixels so no conversion happens */
+static gboolean gst_rga_copy_plane(rga_buffer_handle_t src, gsize src_offset,
+                                   guint src_stride, rga_buffer_handle_t dst,
+                                   gsize dst_offset, guint dst_stride,
+                                   guint row_bytes, guint rows) {
+  rga_buffer_t src_info = {
+      0,
+  };
+  rga_buffer_t dst_info = {
+      0,
+  };
+  rga_buffer_t pat_info = {
+      0,
+  };
+  im_rect src_rect, dst_rect;
+  im_rect pat_rect = {
+      0,
+  };
+
+  if ((src_offset | src_stride | dst_offset | dst_stride | row_bytes) & 3)
+    return FALSE;
+
+  src_info.handle = src;
+  gst_set_rga_info(&src_info, &src_rect, RK_FORMAT_RGBA_8888,
+                   (src_offset % src_stride) / 4, src_offset / src_stride,
+                   row_bytes / 4, rows, src_stride,
+                   src_offset / src_stride + rows);
+  dst_info.handle = dst;
+  gst_set_rga_info(&dst_info, &dst_rect, RK_FORMAT_RGBA_8888,
+                   (dst_offset % dst_stride) / 4, dst_offset / dst_stride,
+                   row_bytes / 4, rows, dst_stride,
+                   dst_offset / dst_stride + rows);
+
+  return improcess(src_info, dst_info, pat_info, src_rect, dst_rect, pat_rect,
+                   -1, NULL, NULL, IM_SYNC) == IM_STATUS_SUCCESS;
+}
+
+/* Planes in different dmabufs cannot be described to RGA at once. Copy
+ * them with RGA into a staging buffer from @pool, which has the default
+ * layout of the frame's format and size. */
+static GstBuffer *gst_rga_gather(GstBufferPool *pool, GstVideoFrame *frame,
+                                 GstMemory **mems, const gsize *offsets,
+                                 GstVideoInfo *info) {
+  gst_video_info_set_format(info, GST_VIDEO_FRAME_FORMAT(frame),
+                            GST_VIDEO_FRAME_WIDTH(frame),
+                            GST_VIDEO_FRAME_HEIGHT(frame));
+
+  GstBuffer *staging;
+  if (gst_buffer_pool_acquire_buffer(pool, &staging, NULL) != GST_FLOW_OK)
+    return NULL;
+
+  GstMemory *dst_mem = gst_buffer_peek_memory(staging, 0);
+  rga_buffer_handle_t dst = gst_rga_memory_get_handle(dst_mem);
+  gint comp[GST_VIDEO_MAX_PLANES];
+
+  gst_rga_plane_components(info->finfo, comp);
+  for (guint p = 0; dst && p < GST_VIDEO_FRAME_N_PLANES(frame); p++) {
+    rga_buffer_handle_t src = gst_rga_memory_get_handle(mems[p]);
+    guint src_stride = GST_VIDEO_FRAME_PLANE_STRIDE(frame, p);
+    guint dst_stride = GST_VIDEO_INFO_PLANE_STRIDE(info, p);
+    gsize dst_offset = dst_mem->offset + GST_VIDEO_INFO_PLANE_OFFSET(info, p);
+
+    if (!src ||
+        !gst_rga_copy_plane(src, offsets[p], src_stride, dst, dst_offset,
+                            dst_stride, MIN(src_stride, dst_stride),
+                            GST_VIDEO_FRAME_COMP_HEIGHT(frame, comp[p]))) {
+      dst = 0;
+    }
+  }
+
+  if (!dst) {
+    gst_buffer_unref(staging);
+    return NULL;
+  }
+  return staging;
+}
+
+/* Describes an AFBC @frame. The headers and blocks fill one dmabuf from
+ * its start, RGA3 only needs the 16 pixel aligned size. */
+static gboolean gst_rga_info_from_afbc_frame(GstObject *obj,
+                                             rga_buffer_t *info,
+                                             im_rect *rect,
+                                             GstVideoFrame *frame,
+                                             RgaSURF_FORMAT rga_format) {
+  GstMemory *mem = gst_buffer_peek_memory(frame->buffer, 0);
+
+  if (gst_buffer_n_memory(frame->buffer) != 1 || !gst_is_dmabuf_memory(mem) ||
+      mem->offset != 0) {
+    GST_WARNING_OBJECT(obj, "AFBC buffer %" GST_PTR_FORMAT " is not one dmabuf",
+                       frame->buffer);
+    return FALSE;
+  }
+
+  info->handle = gst_rga_memory_get_handle(mem);
+  if (!info->handle) return FALSE;
+  info->rd_mode = IM_FBC_MODE;
+
+  return gst_set_rga_info(info, rect, rga_format, 0, 0,
+                          GST_VIDEO_FRAME_WIDTH(frame),
+                          GST_VIDEO_FRAME_HEIGHT(frame),
+                          GST_ROUND_UP_16(GST_VIDEO_FRAME_WIDTH(frame)),
+                          GST_ROUND_UP_16(GST_VIDEO_FRAME_HEIGHT(frame)));
+}
+
+gboolean gst_rga_info_from_video_frame(GstObject *obj, rga_buffer_t *info,
+                                       im_rect *rect, GstVideoFrame *frame,
+                                       guint64 modifier, GstMapInfo *mapInfo,
+                                       GstMapFlags mapFlag,
+                                       GstBufferPool *staging_pool,
+                                       GstBuffer **staging) {
+  RgaSURF_FORMAT rga_format =
+      gst_gst_format_to_rga_format(GST_VIDEO_FRAME_FORMAT(frame));
+
+  if (modifier != DRM_FORMAT_MOD_LINEAR)
+    return gst_rga_info_from_afbc_frame(obj, info, rect, frame, rga_format);
+
+  guint n_planes = GST_VIDEO_FRAME_N_PLANES(frame);
+  GstVideoInfo *vinfo = &frame->info, staging_info;
+  GstMemory *mems[GST_VIDEO_MAX_PLANES];
+  gsize offsets[GST_VIDEO_MAX_PLANES];
+  gboolean dmabuf = TRUE, same_fd = TRUE;
+  guint x, y, vstride;
+
+  for (guint p = 0; p < n_planes && dmabuf; p++) {
+    mems[p] = gst_rga_frame_find_plane(frame, p, &offsets[p]);
+    if (!mems[p] || !gst_is_dmabuf_memory(mems[p]))
+      dmabuf = FALSE;
+    else if (gst_dmabuf_memory_get_fd(mems[p]) !=
+             gst_dmabuf_memory_get_fd(mems[0]))
+      same_fd = FALSE;
+  }
+
+  if (dmabuf && !same_fd && staging_pool) {
+    *staging =
+        gst_rga_gather(staging_pool, frame, mems, offsets, &staging_info);
+    if (*staging) {
+      GstMemory *mem = gst_buffer_peek_memory(*staging, 0);
+
+      vinfo = &staging_info;
+      for (guint p = 0; p < n_planes; p++) {
+        mems[p] = mem;
+        offsets[p] = mem->offset + GST_VIDEO_INFO_PLANE_OFFSET(vinfo, p);
+      }
+      same_fd = TRUE;
+    }
+  }
+
+  if (dmabuf && same_fd && gst_rga_solve_layout(vinfo, offsets, &x, &y,
+                                                &vstride)) {
+    info->handle = gst_rga_memory_get_handle(mems[0]);
+  }
+
+  if (!info->handle) {
+    vinfo = &frame->info;
+    for (guint p = 0; p < n_planes; p++)
+      offsets[p] = GST_VIDEO_FRAME_PLANE_OFFSET(frame, p);
+    if (!gst_rga_solve_layout(vinfo, offsets, &x, &y, &vstride)) {
+      GST_WARNING_OBJECT(obj, "unsupported plane layout");
+      return FALSE;
+    }
+
+    if (!gst_buffer_map(frame->buffer, mapInfo, mapFlag)) return FALSE;
+    info->vir_addr = mapInfo->data;
+  }
+
+  return gst_set_rga_info(info, rect, rga_format, x, y,
+                          GST_VIDEO_FRAME_WIDTH(frame),
+                          GST_VIDEO_FRAME_HEIGHT(frame),
+                          GST_VIDEO_INFO_PLANE_STRIDE(vinfo, 0), vstride);
+}
+
+/* Solves the layout of planes at @offsets and caches it in @tmpl */
+static gboolean gst_rga_image_template_update(GstRgaImageTemplate *tmpl,
+                                              const GstVideoInfo *vinfo,
+                                              const gsize *offsets) {
+  guint x, y, vstride;
+
+  tmpl->valid = FALSE;
+  if (!gst_rga_solve_layout(vinfo, offsets, &x, &y, &vstride)) return FALSE;
+
+  memset(&tmpl->info, 0, sizeof(tmpl->info));
+  if (!gst_set_rga_info(&tmpl->info, &tmpl->rect, tmpl->format, x, y,
+                        GST_VIDEO_INFO_WIDTH(vinfo),
+                        GST_VIDEO_INFO_HEIGHT(vinfo),
+                        GST_VIDEO_INFO_PLANE_STRIDE(vinfo, 0), vstride))
+    return FALSE;
+
+  for (guint p = 0; p < tmpl->n_planes; p++) {
+    tmpl->offsets[p] = offsets[p];
+    tmpl->strides[p] = GST_VIDEO_INFO_PLANE_STRIDE(vinfo, p);
+  }
+  tmpl->valid = TRUE;
+  return TRUE;
+}
+
+gboolean gst_rga_image_template_init(GstRgaImageTemplate *tmpl,
+                                     const GstVideoInfo *info,
+                                     guint64 modifier) {
+  memset(tmpl, 0, sizeof(*tmpl));
+  tmpl->format = gst_gst_format_to_rga_format(GST_VIDEO_INFO_FORMAT(info));
+  tmpl->modifier = modifier;
+  tmpl->n_planes = GST_VIDEO_INFO_N_PLANES(info);
+  if (tmpl->format == RK_FORMAT_UNKNOWN) return FALSE;
+
+  /* buffers without a GstVideoMeta have this layout */
+  if (modifier == DRM_FORMAT_MOD_LINEAR)
+    gst_rga_image_template_update(tmpl, info, info->offset);
+  return TRUE;
+}
+
+gboolean gst_rga_info_from_template(GstObject *obj, GstRgaImageTemplate *tmpl,
+                                    rga_buffer_t *info, im_rect *rect,
+                                    GstVideoFrame *frame, GstMapInfo *map,
+                                    GstMapFlags flags,
+                                    GstBufferPool *staging_pool,
+                                    GstBuffer **staging) {
+  GstMemory *mem = NULL;
+  gsize offsets[GST_VIDEO_MAX_PLANES];
+  gboolean single_dmabuf = tmpl->modifier == DRM_FORMAT_MOD_LINEAR;
+  gboolean same_layout = tmpl->valid;
+
+  for (guint p = 0; p < tmpl->n_planes && single_dmabuf; p++) {
+    GstMemory *plane = gst_rga_frame_find_plane(frame, p, &offsets[p]);
+
+    if (!plane || !gst_is_dmabuf_memory(plane) ||
+        (mem && gst_dmabuf_memory_get_fd(plane) !=
+                    gst_dmabuf_memory_get_fd(mem)))
+      single_dmabuf = FALSE;
+    else if (offsets[p] != tmpl->offsets[p] ||
+             GST_VIDEO_FRAME_PLANE_STRIDE(frame, p) != tmpl->strides[p])
+      same_layout = FALSE;
+    if (!mem) mem = plane;
+  }
+
+  if (single_dmabuf &&
+      (same_layout ||
+       gst_rga_image_template_update(tmpl, &frame->info, offsets))) {
+    *info = tmpl->info;
+    *rect = tmpl->rect;
+    info->handle = gst_rga_memory_get_handle(mem);
+    if (info->handle) return TRUE;
+    memset(info, 0, sizeof(*info));
+  }
+
+  return gst_rga_info_from_video_frame(obj, info, rect, frame, tmpl->modifier,
+                                       map, flags, staging_pool, staging);
+}
+
+gboolean gst_rga_video_frame_init(GstObject *obj, GstVideoFrame *frame,
+                                  const GstVideoInfo *info, GstBuffer *buffer,
+                                  guint64 modifier) {
+  GstVideoMeta *meta = gst_buffer_get_video_meta(buffer);
+
+  memset(frame, 0, sizeof(*frame));
+  frame->info = *info;
+  frame->buffer = buffer;
+  frame->id = -1;
+
+  /* the meta of compressed buffers does not describe planes */
+  if (modifier != DRM_FORMAT_MOD_LINEAR) return TRUE;
+
+  if (meta) {
+    if (meta->format != GST_VIDEO_INFO_FORMAT(info) ||
+        meta->width < GST_VIDEO_INFO_WIDTH(info) ||
+        meta->height < GST_VIDEO_INFO_HEIGHT(info) ||
+        meta->n_planes != GST_VIDEO_INFO_N_PLANES(info)) {
+      GST_WARNING_OBJECT(obj,
+                         "video meta %s %ux%u does not match the caps",
+                         gst_video_format_to_string(meta->format),
+                         meta->width, meta->height);
+      return FALSE;
+    }
+
+    for (guint p = 0; p < meta->n_planes; p++) {
+      GST_VIDEO_INFO_PLANE_OFFSET(&frame->info, p) = meta->offset[p];
+      GST_VIDEO_INFO_PLANE_STRIDE(&frame->info, p) = meta->stride[p];
+    }
+    frame->info.size = gst_buffer_get_size(buffer);
+    frame->meta = meta;
+    frame->id = meta->id;
+  } else if (gst_buffer_get_size(buffer) < GST_VIDEO_INFO_SIZE(info)) {
+    GST_WARNING_OBJECT(obj,
+                       "buffer of %" G_GSIZE_FORMAT
+                       " bytes is too small for the caps",
+                       gst_buffer_get_size(buffer));
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+/* allocation */
+
+GstAllocator *gst_rga_create_allocator(GstObject *obj, const gchar *heap) {
+  GstAllocator *allocator = NULL;
+
+  if (heap) allocator = gst_rga_allocator_new(heap);
+
+  if (!allocator) {
+    GST_INFO_OBJECT(obj, "dma-heap %s not available, trying %s",
+                    GST_STR_NULL(heap), GST_RGA_ALLOCATOR_FALLBACK_HEAP);
+    allocator = gst_rga_allocator_new(GST_RGA_ALLOCATOR_FALLBACK_HEAP);
+  }
+  return allocator;
+}
+
+GstAllocator *gst_rga_create_dma32_allocator(GstObject *obj,
+                                             const gchar *heap) {
+  if (heap && strstr(heap, "dma32")) return gst_rga_create_allocator(obj, heap);
+
+  gchar *own = heap ? g_strconcat(heap, "-dma32", NULL) : NULL;
+  const gchar *candidates[] = {own, "system-uncached-dma32", "system-dma32"};
+  GstAllocator *allocator = NULL;
+
+  for (guint i = 0; i < G_N_ELEMENTS(candidates) && !allocator; i++) {
+    if (candidates[i]) allocator = gst_rga_allocator_new(candidates[i]);
+  }
+  g_free(own);
+
+  if (!allocator) {
+    GST_WARNING_OBJECT(obj,
+                       "no dma32 heap available, RGA2 will go through "
+                       "swiotlb bounce buffers");
+    return gst_rga_create_allocator(obj, heap);
+  }
+
+  GST_INFO_OBJECT(obj, "using dma-heap %s for RGA2",
+                  GST_RGA_ALLOCATOR(allocator)->heap_name);
+  return allocator;
+}
+
+static void gst_rga_video_alignment(const GstVideoInfo *info,
+                                    GstVideoAlignment *align) {
+  guint width = GST_VIDEO_INFO_WIDTH(info);
+  guint height = GST_VIDEO_INFO_HEIGHT(info);
+
+  gst_video_alignment_reset(align);
+  align->padding_right = GST_ROUND_UP_N(width, GST_RGA_WIDTH_ALIGN) - width;
+  align->padding_bottom = GST_ROUND_UP_N(height, GST_RGA_HEIGHT_ALIGN) - height;
+}
+
+GstBufferPool *gst_rga_video_pool_new(GstObject *obj, GstAllocator *allocator,
+                                      GstCaps *caps, guint *size, guint min,
+                                      guint max, gboolean video_meta) {
+  GstVideoInfo info;
+  guint64 modifier;
+  GstCaps *plain = gst_rga_caps_to_plain(caps, &modifier);
+  if (!plain || !gst_video_info_from_caps(&info, plain)) {
+    if (plain) gst_caps_unref(plain);
+    GST_WARNING_OBJECT(obj, "cannot allocate %" GST_PTR_FORMAT, caps);
+    return NULL;
+  }
+
+  GstBufferPool *pool = gst_rga_buffer_pool_new();
+  GstStructure *config = gst_buffer_pool_get_config(pool);
+
+  /* compressed buffers have no GstVideoMeta layout to pad */
+  if (modifier != DRM_FORMAT_MOD_LINEAR) {
+    info.size = gst_rga_afbc_size(&info);
+    video_meta = FALSE;
+  }
+
+  gst_buffer_pool_config_set_params(config, plain, info.size, min, max);
+  gst_caps_unref(plain);
+  gst_buffer_pool_config_set_allocator(config, allocator, NULL);
+  if (video_meta) {
+    GstVideoAlignment align;
+
+    gst_rga_video_alignment(&info, &align);
+    gst_buffer_pool_config_add_option(config,
+                                      GST_BUFFER_POOL_OPTION_VIDEO_META);
+    gst_buffer_pool_config_add_option(config,
+                                      GST_BUFFER_POOL_OPTION_VIDEO_ALIGNMENT);
+    gst_buffer_pool_config_set_video_alignment(config, &align);
+  }
+
+  if (!gst_buffer_pool_set_config(pool, config)) {
+    GST_WARNING_OBJECT(obj, "failed to configure dmabuf pool");
+    gst_object_unref(pool);
+    return NULL;
+  }
+
+  /* the video pool updates the size to account for the padding */
+  config = gst_buffer_pool_get_config(pool);
+  gst_buffer_pool_config_get_params(config, NULL, size, NULL, NULL);
+  gst_structure_free(config);
+  return pool;
+}
+
+gboolean gst_rga_decide_allocation(GstObject *obj, GstQuery *query,
+                                   GstAllocator *allocator,
+                                   const GstRgaPoolParams *params) {
+  GstCaps *outcaps;
+  guint size = 0, min = 0, max = 0;
+
+  gst_query_parse_allocation(query, &outcaps, NULL);
+  if (!outcaps) return FALSE;
+
+  gboolean update_pool = gst_query_get_n_allocation_pools(query) > 0;
+  if (update_pool)
+    gst_query_parse_nth_allocation_pool(query, 0, NULL, &size, &min, &max);
+
+  /* downstream's minimum is what it holds, it cannot be lowered */
+  if (params) {
+    min = MAX(min, params->min_buffers);
+    if (params->max_buffers) {
+      max = MAX(params->max_buffers, min);
+      if (max > params->max_buffers)
+        GST_WARNING_OBJECT(obj,
+                           "downstream needs %u buffers, above the "
+                           "max-buffers of %u",
+                           min, params->max_buffers);
+    }
+  }
+  gboolean lazy = params && params->lazy;
+
+  gboolean video_meta =
+      gst_query_find_allocation_meta(query, GST_VIDEO_META_API_TYPE, NULL);
+  GstBufferPool *pool = gst_rga_video_pool_new(
+      obj, allocator, outcaps, &size, lazy ? 0 : min, max, video_meta);
+  if (!pool) return FALSE;
+
+  /* a lazy pool starts empty but trims no lower than the minimum */
+  if (params) {
+    gst_rga_buffer_pool_set_min_buffers(GST_RGA_BUFFER_POOL(pool), min);
+    gst_rga_buffer_pool_set_idle_timeout(GST_RGA_BUFFER_POOL(pool),
+                                         params->idle_timeout);
+  }
+
+  if (update_pool)
+    gst_query_set_nth_allocation_pool(query, 0, pool, size, min, max);
+  else
+    gst_query_add_allocation_pool(query, pool, size, min, max);
+
+  if (gst_query_get_n_allocation_params(query) > 0)
+    gst_query_set_nth_allocation_param(query, 0, allocator, NULL);
+  else
+    gst_query_add_allocation_param(query, allocator, NULL);
+
+  GST_DEBUG_OBJECT(obj,
+                   "using dmabuf pool from %s, size %u, min %u, max %u%s",
+                   GST_RGA_ALLOCATOR(allocator)->heap_name, size, min, max,
+                   lazy ? ", allocated on demand" : "");
+
+  gst_object_unref(pool);
+  return TRUE;
+}
+
+void gst_rga_propose_allocation(GstObject *obj, GstQuery *query,
+                                GstAllocator *allocator) {
+  GstCaps *caps;
+  guint size = 0;
+
+  gst_query_parse_allocation(query, &caps, NULL);
+  if (!caps || !allocator || gst_query_get_n_allocation_pools(query) > 0)
+    return;
+
+  /* upstream may not read GstVideoMeta, so propose an unpadded layout */
+  GstBufferPool *pool =
+      gst_rga_video_pool_new(obj, allocator, caps, &size, 0, 0, FALSE);
+  if (!pool) return;
+
+  gst_query_add_allocation_pool(query, pool, size, 0, 0);
+  gst_query_add_allocation_param(query, allocator, NULL);
+  gst_object_unref(pool);
+}
@@ -0,0 +1,234 @@
+/* GStreamer
+ * Copyright (C) 2025 FIXME <fixme@example.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Suite 500,
+ * Boston, MA 02110-1335, USA.
+ */
+
+#ifndef PLUGINS_GSTRGAUTILS_H_
+#define PLUGINS_GSTRGAUTILS_H_
+
+#include <drm/drm_fourcc.h>
+#include <gst/gst.h>
+#include <gst/video/video.h>
+
+#include "rga/RgaApi.h"
+#include "rga/im2d.h"
+
+G_BEGIN_DECLS
+
+/* AFBC layout of the RK3588 decoders and display, RGA3 reads and writes it
+ * as IM_FBC_MODE */
+#define GST_RGA_AFBC_MODIFIER \
+  DRM_FORMAT_MOD_ARM_AFBC(AFBC_FORMAT_MOD_BLOCK_SIZE_16x16 | \
+                          AFBC_FORMAT_MOD_SPARSE)
+
+/* RGA prefers 16 pixel aligned strides and 16 line aligned planes */
+#define GST_RGA_WIDTH_ALIGN 16
+#define GST_RGA_HEIGHT_ALIGN 16
+
+/* formats RGA writes */
+#define GST_RGA_SRC_FORMAT_LIST                                                \
+  "I420, YV12, NV12, NV21, Y42B, NV16, NV61, RGB16, RGB15, BGR, RGB, BGRA, "   \
+  "RGBA, BGRx, RGBx"
+#define GST_RGA_SRC_FORMATS "{ " GST_RGA_SRC_FORMAT_LIST " }"
+
+/* planar RGB, written by RGA as packed RGB and split into planes by the
+ * CPU, GStreamer >= 1.20 */
+#ifdef HAVE_RGBP
+#define GST_RGA_PLANAR_RGB_FORMATS ", RGBP, BGRP"
+#else
+#define GST_RGA_PLANAR_RGB_FORMATS
+#endif
+
+/* RGA reads 10 bit NV12 and converts it to any 8 bit output format */
+#ifdef HAVE_NV12_10LE40
+#define GST_RGA_SINK_10BIT_FORMATS "NV12_10LE40, "
+#else
+#define GST_RGA_SINK_10BIT_FORMATS
+#endif
+
+/* formats RGA reads */
+#define GST_RGA_SINK_FORMATS                                                   \
+  "{ I420, YV12, NV12, " GST_RGA_SINK_10BIT_FORMATS                            \
+  "NV21, Y42B, NV16, NV61, RGB16, RGB15, BGR, RGB, BGRA, RGBA, BGRx, RGBx }"
+
+/* Sets up the debug category of the helpers, called from plugin_init */
+void gst_rga_utils_init(void);
+
+/* The GstRgaCoreMask flags of the core-mask properties */
+GType gst_rga_core_mask_get_type(void);
+
+/* Matrix and range of the YUV side of a YUV/RGB conversion, the ones RGA
+ * has coefficients for */
+typedef enum {
+  GST_RGA_COLOR_SPACE_AUTO,
+  GST_RGA_COLOR_SPACE_BT601_LIMITED,
+  GST_RGA_COLOR_SPACE_BT601_FULL,
+  GST_RGA_COLOR_SPACE_BT709_LIMITED,
+} GstRgaColorSpace;
+
+GType gst_rga_color_space_get_type(void);
+
+/* The color space RGA should use for the colorimetry of the YUV @info.
+ * *@exact is FALSE when RGA has no coefficients for it (BT.709 full range,
+ * BT.2020) and the nearest one with the right range is returned. */
+GstRgaColorSpace gst_rga_color_space_from_info(const GstVideoInfo *info,
+                                               gboolean *exact);
+
+/* The IM_COLOR_SPACE_MODE of a blit from @in to @out in @space, the
+ * driver default unless one side is YUV and the other RGB */
+int gst_rga_color_space_mode(GstVideoFormat in, GstVideoFormat out,
+                             GstRgaColorSpace space);
+
+/* Template caps: the plain formats of @desc, also offered as dmabufs. From
+ * GStreamer 1.24 dmabufs are described by DMA_DRM caps with drm-format,
+ * older versions use memory:DMABuf with the plain format list. AFBC is
+ * only negotiable through DMA_DRM caps. */
+GstCaps *gst_rga_template_caps(const gchar *desc);
+
+/* Plain video caps with the format and size of @caps, which may be
+ * DMA_DRM caps, and the DRM modifier of the layout in @modifier. Only
+ * linear and AFBC modifiers are accepted. */
+GstCaps *gst_rga_caps_to_plain(GstCaps *caps, guint64 *modifier);
+
+/* Takes @structure without its format fields and returns it with
+ * @features, as dmabuf and as system memory: RGA reads and writes all of
+ * them, whatever the other side uses */
+GstCaps *gst_rga_caps_any_memory(GstStructure *structure,
+                                 GstCapsFeatures *features);
+
+RgaSURF_FORMAT gst_gst_format_to_rga_format(GstVideoFormat format);
+
+/* Fills the size, strides and format of @info and the @rect at (@x, @y).
+ * @hstride is in bytes, @vstride in lines. */
+gboolean gst_set_rga_info(rga_buffer_t *info, im_rect *rect,
+                          RgaSURF_FORMAT format, guint x, guint y, guint width,
+                          guint height, guint hstride, guint vstride);
+
+/* librga takes colors as 0xAABBGGRR, properties use 0xAARRGGBB */
+guint32 gst_rga_color_from_argb(guint32 argb);
+
+/* Clips @rect, where an @in_width x @in_height picture is drawn, to the
+ * @out_width x @out_height output. The visible part goes to @dst_rect and
+ * the part of the picture it shows to @src_rect. Returns FALSE when nothing
+ * is visible. */
+gboolean gst_rga_clip_rect(const im_rect *rect, gint in_width, gint in_height,
+                           gint out_width, gint out_height, im_rect *src_rect,
+                           im_rect *dst_rect);
+
+/* Packed format with the channel order of the planar RGB @format, or
+ * GST_VIDEO_FORMAT_UNKNOWN if @format isn't planar RGB */
+GstVideoFormat gst_rga_planar_rgb_packed_format(GstVideoFormat format);
+
+/* Splits the mapped packed RGB or BGR @packed into the planes of the mapped
+ * @planar of the same size */
+void gst_rga_deinterleave_rgb(const GstVideoFrame *packed,
+                              GstVideoFrame *planar);
+
+/* TRUE if all memory of @buffer comes from a heap RGA2 can address */
+gboolean gst_rga_buffer_is_dma32(GstBuffer *buffer);
+
+/* Describes @buffer as an unmapped frame of @info. The strides and plane
+ * offsets come from the buffer's GstVideoMeta when it has one, so padded
+ * decoder buffers are used as they are. Only the layout fields are valid,
+ * the frame must not be unmapped. */
+gboolean gst_rga_video_frame_init(GstObject *obj, GstVideoFrame *frame,
+                                  const GstVideoInfo *info, GstBuffer *buffer,
+                                  guint64 modifier);
+
+/* Describes @frame as one RGA image. dmabuf planes are addressed through
+ * the cached handle, with an origin for offsets inside the dmabuf. Planes
+ * in different dmabufs are gathered into @staging, acquired from
+ * @staging_pool when it is given. As a last resort the buffer is mapped
+ * into @map and RGA works on the CPU address. */
+gboolean gst_rga_info_from_video_frame(GstObject *obj, rga_buffer_t *info,
+                                       im_rect *rect, GstVideoFrame *frame,
+                                       guint64 modifier, GstMapInfo *map,
+                                       GstMapFlags flags,
+                                       GstBufferPool *staging_pool,
+                                       GstBuffer **staging);
+
+/* The RGA image of the frames of one negotiated format, built in set_info.
+ * It keeps the plane layout it was solved for, so frames laid out the same
+ * way, which is every frame of a pool, only need their handle looked up. */
+typedef struct {
+  RgaSURF_FORMAT format;
+  guint64 modifier;
+  guint n_planes;
+  /* layout of @info and @rect, when @valid */
+  gboolean valid;
+  gsize offsets[GST_VIDEO_MAX_PLANES];
+  gint strides[GST_VIDEO_MAX_PLANES];
+  rga_buffer_t info;
+  im_rect rect;
+} GstRgaImageTemplate;
+
+/* Fills @tmpl for frames of @info, solved for the default layout. FALSE if
+ * RGA does not know the format. */
+gboolean gst_rga_image_template_init(GstRgaImageTemplate *tmpl,
+                                     const GstVideoInfo *info,
+                                     guint64 modifier);
+
+/* gst_rga_info_from_video_frame() through @tmpl: a dmabuf frame with the
+ * cached layout is described by a copy of the template, a new layout
+ * replaces it and anything else takes the full path */
+gboolean gst_rga_info_from_template(GstObject *obj, GstRgaImageTemplate *tmpl,
+                                    rga_buffer_t *info, im_rect *rect,
+                                    GstVideoFrame *frame, GstMapInfo *map,
+                                    GstMapFlags flags,
+                                    GstBufferPool *staging_pool,
+                                    GstBuffer **staging);
+
+/* The allocator of @heap, or of the fallback heap when it is missing */
+GstAllocator *gst_rga_create_allocator(GstObject *obj, const gchar *heap);
+
+/* Like gst_rga_create_allocator() for buffers RGA2 must reach on boards
+ * with memory above 4 GB: tries <heap>-dma32, then the dma32 system heaps,
+ * and falls back to @heap when there is none */
+GstAllocator *gst_rga_create_dma32_allocator(GstObject *obj,
+                                             const gchar *heap);
+
+/* Creates a dmabuf backed video pool, padded for RGA when the peer can
+ * read the resulting strides from GstVideoMeta. */
+GstBufferPool *gst_rga_video_pool_new(GstObject *obj, GstAllocator *allocator,
+                                      GstCaps *caps, guint *size, guint min,
+                                      guint max, gboolean video_meta);
+
+/* How an element sizes its output pool */
+typedef struct {
+  /* at least this many buffers, or what downstream asks for when more */
+  guint min_buffers;
+  /* at most this many, 0 leaves it to downstream */
+  guint max_buffers;
+  /* allocate the minimum on first use rather than when the pool starts */
+  gboolean lazy;
+  /* free buffers left unused for this long, 0 keeps them */
+  GstClockTime idle_timeout;
+} GstRgaPoolParams;
+
+/* Puts a dmabuf pool from @allocator into the allocation @query of the
+ * src pad, sized by @params when given */
+gboolean gst_rga_decide_allocation(GstObject *obj, GstQuery *query,
+                                   GstAllocator *allocator,
+                                   const GstRgaPoolParams *params);
+
+/* Offers a dmabuf pool from @allocator to upstream unless it has one */
+void gst_rga_propose_allocation(GstObject *obj, GstQuery *query,
+                                GstAllocator *allocator);
+
+G_END_DECLS
+
+#endif  // PLUGINS_GSTRGAUTILS_H_
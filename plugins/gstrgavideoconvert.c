@@ -36,22 +36,29 @@
 #include "config.h"  // NOLINT
 #endif
 
+#include <drm/drm_fourcc.h>
+#include <errno.h>
 #include <gst/allocators/gstdmabuf.h>
 #include <gst/gst.h>
 #include <gst/video/gstvideofilter.h>
+#include <gst/video/gstvideopool.h>
 #include <gst/video/video.h>
-
+#include <linux/sync_file.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include "gstrgaallocator.h"     // NOLINT
+#include "gstrgasoftware.h"      // NOLINT
+#include "gstrgatensormeta.h"    // NOLINT
+#include "gstrgatracer.h"        // NOLINT
+#include "gstrgautils.h"         // NOLINT
 #include "gstrgavideoconvert.h"  // NOLINT
-#include "rga/RgaApi.h"
-#include "rga/im2d.h"
 
 GST_DEBUG_CATEGORY_STATIC(gst_rga_video_convert_debug_category);
 #define GST_CAT_DEFAULT gst_rga_video_convert_debug_category
 
-#define GST_CASE_RETURN(a, b) \
-  case a:                     \
-    return b
-
 /* prototypes */
 
 static gboolean gst_rga_video_convert_start(GstBaseTransform *trans);
@@ -61,6 +68,28 @@ static GstCaps *gst_rga_video_convert_transform_caps(GstBaseTransform *trans,
                                                      GstPadDirection direction,
                                                      GstCaps *caps,
                                                      GstCaps *filter);
+static GstCaps *gst_rga_video_convert_fixate_caps(GstBaseTransform *trans,
+                                                  GstPadDirection direction,
+                                                  GstCaps *caps,
+                                                  GstCaps *othercaps);
+
+static gboolean gst_rga_video_convert_set_caps(GstBaseTransform *trans,
+                                               GstCaps *incaps,
+                                               GstCaps *outcaps);
+
+static gboolean gst_rga_video_convert_sink_event(GstBaseTransform *trans,
+                                                 GstEvent *event);
+static gboolean gst_rga_video_convert_src_event(GstBaseTransform *trans,
+                                                GstEvent *event);
+static GstFlowReturn gst_rga_video_convert_submit_input_buffer(
+    GstBaseTransform *trans, gboolean is_discont, GstBuffer *input);
+static GstFlowReturn gst_rga_video_convert_prepare_output_buffer(
+    GstBaseTransform *trans, GstBuffer *input, GstBuffer **outbuf);
+
+static gboolean gst_rga_video_convert_decide_allocation(
+    GstBaseTransform *trans, GstQuery *query);
+static gboolean gst_rga_video_convert_propose_allocation(
+    GstBaseTransform *trans, GstQuery *decide_query, GstQuery *query);
 
 static gboolean gst_rga_video_convert_set_info(GstVideoFilter *filter,
                                                GstCaps *incaps,
@@ -68,48 +97,102 @@ static gboolean gst_rga_video_convert_set_info(GstVideoFilter *filter,
                                                GstCaps *outcaps,
                                                GstVideoInfo *out_info);
 
-static GstFlowReturn gst_rga_video_convert_transform_frame(
-    GstVideoFilter *filter, GstVideoFrame *inframe, GstVideoFrame *outframe);
+static GstFlowReturn gst_rga_video_convert_transform(GstBaseTransform *trans,
+                                                     GstBuffer *inbuf,
+                                                     GstBuffer *outbuf);
 
 /* pad templates */
 
 #define VIDEO_SRC_CAPS                                                         \
   "video/x-raw, "                                                              \
-  "format = (string) "                                                         \
-  "{ I420, YV12, NV12, NV21, Y42B, NV16, NV61, RGB16, RGB15, BGR, RGB, BGRA, " \
-  "RGBA, BGRx, RGBx }"                                                         \
-  ", "                                                                         \
-  "width = (int) [ 1, 4096 ] ,"                                                \
-  "height = (int) [ 1, 4096 ] ,"                                               \
+  "format = (string) { " GST_RGA_SRC_FORMAT_LIST GST_RGA_PLANAR_RGB_FORMATS    \
+  " }, "                                                                       \
+  "width = (int) [ 1, 16384 ] ,"                                               \
+  "height = (int) [ 1, 16384 ] ,"                                              \
   "framerate = (fraction) [ 0, max ]"
 
 #define VIDEO_SINK_CAPS                                                        \
   "video/x-raw, "                                                              \
-  "format = (string) "                                                         \
-  "{ I420, YV12, NV12, NV21, Y42B, NV16, NV61, RGB16, RGB15, BGR, RGB, BGRA, " \
-  "RGBA, BGRx, RGBx }"                                                         \
+  "format = (string) " GST_RGA_SINK_FORMATS                                    \
   ", "                                                                         \
-  "width = (int) [ 1, 8192 ] ,"                                                \
-  "height = (int) [ 1, 8192 ] ,"                                               \
+  "width = (int) [ 1, 16384 ] ,"                                               \
+  "height = (int) [ 1, 16384 ] ,"                                              \
   "framerate = (fraction) [ 0, max ]"
 
+
 /* element properties */
 
 typedef enum {
   GST_RGA_PROP_0,
   GST_RGA_PROP_CORE_MASK,
-  GST_RGA_PROP_LAST
+  GST_RGA_PROP_DMA_HEAP,
+  GST_RGA_PROP_ASYNC,
+  GST_RGA_PROP_MAX_JOBS,
+  GST_RGA_PROP_CROP_LEFT,
+  GST_RGA_PROP_CROP_RIGHT,
+  GST_RGA_PROP_CROP_TOP,
+  GST_RGA_PROP_CROP_BOTTOM,
+  GST_RGA_PROP_ADD_BORDERS,
+  GST_RGA_PROP_FILL_COLOR,
+  GST_RGA_PROP_STATS,
+  GST_RGA_PROP_STATS_INTERVAL,
+  GST_RGA_PROP_TENSOR_MEAN,
+  GST_RGA_PROP_TENSOR_SCALE,
+  GST_RGA_PROP_SOFTWARE_FALLBACK,
+  GST_RGA_PROP_OVERFLOW_JOBS,
+  GST_RGA_PROP_MAX_FPS,
+  GST_RGA_PROP_IN_PLACE,
+  GST_RGA_PROP_COLOR_SPACE,
+  GST_RGA_PROP_BATCH_WINDOW,
+  GST_RGA_PROP_MIN_BUFFERS,
+  GST_RGA_PROP_MAX_BUFFERS,
+  GST_RGA_PROP_LAZY_ALLOCATION,
+  GST_RGA_PROP_IDLE_TIMEOUT,
+  GST_RGA_PROP_AUTO_DMA32,
+  GST_RGA_PROP_LAST,
+  /* overridden from GstVideoDirection */
+  GST_RGA_PROP_VIDEO_DIRECTION = GST_RGA_PROP_LAST
 } GstRgaProp;
 
 static GParamSpec *rga_props[GST_RGA_PROP_LAST];
 
+#define DEFAULT_DMA_HEAP "system-uncached"
+#define DEFAULT_ASYNC FALSE
+#define DEFAULT_MAX_JOBS 2
+#define DEFAULT_ADD_BORDERS FALSE
+#define DEFAULT_FILL_COLOR 0xff000000
+#define DEFAULT_STATS_INTERVAL 0
+#define DEFAULT_SOFTWARE_FALLBACK TRUE
+#define DEFAULT_OVERFLOW_JOBS 0
+#define DEFAULT_MAX_FPS_N 0
+#define DEFAULT_MAX_FPS_D 1
+#define DEFAULT_IN_PLACE FALSE
+#define DEFAULT_COLOR_SPACE GST_RGA_COLOR_SPACE_AUTO
+#define DEFAULT_BATCH_WINDOW 0
+#define DEFAULT_MIN_BUFFERS 0
+#define DEFAULT_MAX_BUFFERS 0
+#define DEFAULT_LAZY_ALLOCATION FALSE
+#define DEFAULT_IDLE_TIMEOUT 0
+#define DEFAULT_AUTO_DMA32 TRUE
+
+/* how long a release fence may take before it is reported as late */
+#define RGA_FENCE_TIMEOUT_MS 1000
+
+/* RGA limits of one blit, with some room for the even tile edges */
+#define RGA_MAX_SRC_SIZE 8192
+#define RGA_MAX_DST_SIZE 4096
+#define RGA_TILE_MARGIN 16
+/* largest frame handled by splitting it into tiles */
+#define RGA_MAX_TILED_SIZE 16384
+
 /* class initialization */
 
 G_DEFINE_TYPE_WITH_CODE(
     GstRgaVideoConvert, gst_rga_video_convert, GST_TYPE_VIDEO_FILTER,
     GST_DEBUG_CATEGORY_INIT(gst_rga_video_convert_debug_category,
                             "rgavideoconvert", 0,
-                            "video Colorspace conversion & scaler"));
+                            "video Colorspace conversion & scaler");
+    G_IMPLEMENT_INTERFACE(GST_TYPE_VIDEO_DIRECTION, NULL));
 
 static void gst_rga_video_convert_set_property(GObject *object, guint prop_id,
                                                const GValue *value,
@@ -119,6 +202,8 @@ static void gst_rga_video_convert_get_property(GObject *object, guint prop_id,
                                                GValue *value,
                                                GParamSpec *pspec);
 
+static void gst_rga_video_convert_finalize(GObject *object);
+
 static void gst_rga_video_convert_class_init(GstRgaVideoConvertClass *klass) {
   GObjectClass *gobject_class = G_OBJECT_CLASS(klass);
   GstBaseTransformClass *base_transform_class = GST_BASE_TRANSFORM_CLASS(klass);
@@ -128,12 +213,14 @@ static void gst_rga_video_convert_class_init(GstRgaVideoConvertClass *klass) {
    base_class_init if you intend to subclass this class. */
   gst_element_class_add_pad_template(
       GST_ELEMENT_CLASS(klass),
-      gst_pad_template_new("src", GST_PAD_SRC, GST_PAD_ALWAYS,
-                           gst_caps_from_string(VIDEO_SRC_CAPS)));
+      gst_pad_template_new(
+          "src", GST_PAD_SRC, GST_PAD_ALWAYS,
+          gst_rga_template_caps(VIDEO_SRC_CAPS)));
   gst_element_class_add_pad_template(
       GST_ELEMENT_CLASS(klass),
-      gst_pad_template_new("sink", GST_PAD_SINK, GST_PAD_ALWAYS,
-                           gst_caps_from_string(VIDEO_SINK_CAPS)));
+      gst_pad_template_new(
+          "sink", GST_PAD_SINK, GST_PAD_ALWAYS,
+          gst_rga_template_caps(VIDEO_SINK_CAPS)));
 
   gst_element_class_set_static_metadata(
       GST_ELEMENT_CLASS(klass), "RgaVidConv Plugin", "Generic",
@@ -142,146 +229,259 @@ static void gst_rga_video_convert_class_init(GstRgaVideoConvertClass *klass) {
       "http://github.com/corenel/gstreamer-rga");
 
   /* element properties */
-  static const GFlagsValue mask_values[] = {
-      {IM_SCHEDULER_RGA3_DEFAULT, "auto", "auto"},
-      {IM_SCHEDULER_RGA3_CORE0, "rga3_core0", "rga3_core0"},
-      {IM_SCHEDULER_RGA3_CORE1, "rga3_core1", "rga3_core1"},
-      {IM_SCHEDULER_RGA2_CORE0, "rga2_core0", "rga2_core0"},
-      {IM_SCHEDULER_RGA3_CORE0 | IM_SCHEDULER_RGA3_CORE1, "rga3", "rga3"},
-      {IM_SCHEDULER_RGA2_CORE0, "rga2", "rga2"},
-      {0, NULL, NULL}};
-  GType mask_type = g_flags_register_static("GstRgaCoreMask", mask_values);
-
   rga_props[GST_RGA_PROP_CORE_MASK] = g_param_spec_flags(
       "core-mask", "Core mask", "Select which RGA core(s) to use (bit-mask)",
-      mask_type, IM_SCHEDULER_RGA3_DEFAULT, /* default == auto */
+      gst_rga_core_mask_get_type(), IM_SCHEDULER_DEFAULT, /* default == auto */
       G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
 
+  rga_props[GST_RGA_PROP_DMA_HEAP] = g_param_spec_string(
+      "dma-heap", "DMA heap",
+      "dma-heap (under /dev/dma_heap) to allocate output buffers from, falls "
+      "back to \"" GST_RGA_ALLOCATOR_FALLBACK_HEAP "\" if missing",
+      DEFAULT_DMA_HEAP,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY);
+
+  rga_props[GST_RGA_PROP_ASYNC] = g_param_spec_boolean(
+      "async", "Async",
+      "Submit jobs without waiting for RGA and push the output from a "
+      "separate thread once the release fence signals",
+      DEFAULT_ASYNC,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_MUTABLE_READY);
+
+  rga_props[GST_RGA_PROP_MAX_JOBS] = g_param_spec_uint(
+      "max-jobs", "Max jobs", "Maximum number of jobs in flight in async mode",
+      1, 16, DEFAULT_MAX_JOBS,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_MUTABLE_READY);
+
+  rga_props[GST_RGA_PROP_CROP_LEFT] = g_param_spec_uint(
+      "crop-left", "Crop left", "Pixels to crop at the left of the input",
+      0, G_MAXINT, 0,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_MUTABLE_PLAYING);
+  rga_props[GST_RGA_PROP_CROP_RIGHT] = g_param_spec_uint(
+      "crop-right", "Crop right", "Pixels to crop at the right of the input",
+      0, G_MAXINT, 0,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_MUTABLE_PLAYING);
+  rga_props[GST_RGA_PROP_CROP_TOP] = g_param_spec_uint(
+      "crop-top", "Crop top", "Pixels to crop at the top of the input", 0,
+      G_MAXINT, 0,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_MUTABLE_PLAYING);
+  rga_props[GST_RGA_PROP_CROP_BOTTOM] = g_param_spec_uint(
+      "crop-bottom", "Crop bottom", "Pixels to crop at the bottom of the input",
+      0, G_MAXINT, 0,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_MUTABLE_PLAYING);
+
+  rga_props[GST_RGA_PROP_ADD_BORDERS] = g_param_spec_boolean(
+      "add-borders", "Add borders",
+      "Keep the display aspect ratio and fill the rest of the output with "
+      "fill-color",
+      DEFAULT_ADD_BORDERS,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_MUTABLE_PLAYING);
+
+  rga_props[GST_RGA_PROP_FILL_COLOR] = g_param_spec_uint(
+      "fill-color", "Fill color", "Color of the borders (0xAARRGGBB)", 0,
+      G_MAXUINT32, DEFAULT_FILL_COLOR,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_MUTABLE_PLAYING);
+
+  rga_props[GST_RGA_PROP_STATS] = g_param_spec_boxed(
+      "stats", "Statistics",
+      "Frames, failed blits, CPU mapping fallbacks, frames converted on the "
+      "CPU, frames dropped before RGA, bytes moved, blit latency (mean and "
+      "p99 in ns) and jobs per core since start",
+      GST_TYPE_STRUCTURE, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS);
+
+  rga_props[GST_RGA_PROP_STATS_INTERVAL] = g_param_spec_uint(
+      "stats-interval", "Statistics interval",
+      "Post the stats as an element message every this many milliseconds "
+      "(0 = disabled)",
+      0, G_MAXUINT, DEFAULT_STATS_INTERVAL,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_MUTABLE_PLAYING);
+
+  rga_props[GST_RGA_PROP_TENSOR_MEAN] = gst_param_spec_array(
+      "tensor-mean", "Tensor mean",
+      "Per channel mean in the tensor meta of RGB outputs, in the channel "
+      "order of the output format",
+      g_param_spec_double("mean", "Mean", "Mean of one channel", -G_MAXDOUBLE,
+                          G_MAXDOUBLE, 0.0,
+                          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS),
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_MUTABLE_PLAYING);
+
+  rga_props[GST_RGA_PROP_TENSOR_SCALE] = gst_param_spec_array(
+      "tensor-scale", "Tensor scale",
+      "Per channel scale in the tensor meta of RGB outputs, in the channel "
+      "order of the output format",
+      g_param_spec_double("scale", "Scale", "Scale of one channel",
+                          -G_MAXDOUBLE, G_MAXDOUBLE, 1.0,
+                          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS),
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_MUTABLE_PLAYING);
+
+  rga_props[GST_RGA_PROP_SOFTWARE_FALLBACK] = g_param_spec_boolean(
+      "software-fallback", "Software fallback",
+      "Convert NV12 frames on the CPU when RGA rejects them",
+      DEFAULT_SOFTWARE_FALLBACK,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_MUTABLE_PLAYING);
+
+  rga_props[GST_RGA_PROP_OVERFLOW_JOBS] = g_param_spec_uint(
+      "overflow-jobs", "Overflow jobs",
+      "Convert NV12 frames on the CPU while every allowed core has this many "
+      "jobs in flight, needs software-fallback (0 = never)",
+      0, G_MAXUINT, DEFAULT_OVERFLOW_JOBS,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_MUTABLE_PLAYING);
+
+  rga_props[GST_RGA_PROP_MAX_FPS] = gst_param_spec_fraction(
+      "max-fps", "Max fps",
+      "Drop input frames above this rate before any RGA work (0/1 = no "
+      "limit)",
+      0, 1, G_MAXINT, 1, DEFAULT_MAX_FPS_N, DEFAULT_MAX_FPS_D,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_MUTABLE_PLAYING);
+
+  rga_props[GST_RGA_PROP_IN_PLACE] = g_param_spec_boolean(
+      "in-place", "In place",
+      "Write channel swaps of the same size (RGBA to BGRA, NV12 to NV21, ...) "
+      "over writable dmabuf inputs instead of a new buffer. Never use it on "
+      "decoder outputs that are still reference frames",
+      DEFAULT_IN_PLACE,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_MUTABLE_PLAYING);
+
+  rga_props[GST_RGA_PROP_COLOR_SPACE] = g_param_spec_enum(
+      "color-space", "Color space",
+      "Matrix and range of the YUV side of YUV/RGB conversions, auto takes "
+      "them from the colorimetry of the caps",
+      gst_rga_color_space_get_type(), DEFAULT_COLOR_SPACE,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_MUTABLE_READY);
+
+  rga_props[GST_RGA_PROP_BATCH_WINDOW] = g_param_spec_uint(
+      "batch-window", "Batch window",
+      "Microseconds to gather the blits of all elements with a batch-window "
+      "into one RGA job, trading latency for fewer ioctls (0 = off)",
+      0, 10000, DEFAULT_BATCH_WINDOW,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_MUTABLE_PLAYING);
+
+  rga_props[GST_RGA_PROP_MIN_BUFFERS] = g_param_spec_uint(
+      "min-buffers", "Min buffers",
+      "Minimum number of output buffers, raised to what downstream needs "
+      "(0 = downstream's)",
+      0, 64, DEFAULT_MIN_BUFFERS,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_MUTABLE_READY);
+
+  rga_props[GST_RGA_PROP_MAX_BUFFERS] = g_param_spec_uint(
+      "max-buffers", "Max buffers",
+      "Maximum number of output buffers, the element waits for downstream "
+      "to release one beyond it (0 = downstream's)",
+      0, 64, DEFAULT_MAX_BUFFERS,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_MUTABLE_READY);
+
+  rga_props[GST_RGA_PROP_LAZY_ALLOCATION] = g_param_spec_boolean(
+      "lazy-allocation", "Lazy allocation",
+      "Allocate output buffers when they are first needed rather than the "
+      "minimum when the pool starts",
+      DEFAULT_LAZY_ALLOCATION,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_MUTABLE_READY);
+
+  rga_props[GST_RGA_PROP_IDLE_TIMEOUT] = g_param_spec_uint(
+      "idle-timeout", "Idle timeout",
+      "Milliseconds after which output buffers beyond min-buffers that were "
+      "not needed are freed (0 = never)",
+      0, G_MAXUINT, DEFAULT_IDLE_TIMEOUT,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_MUTABLE_READY);
+
+  rga_props[GST_RGA_PROP_AUTO_DMA32] = g_param_spec_boolean(
+      "auto-dma32", "Auto DMA32",
+      "Allocate from a dma32 variant of dma-heap when core-mask only leaves "
+      "RGA2 on a board with memory above 4 GB",
+      DEFAULT_AUTO_DMA32,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_MUTABLE_READY);
+
   gobject_class->set_property = gst_rga_video_convert_set_property;
   gobject_class->get_property = gst_rga_video_convert_get_property;
+  gobject_class->finalize = gst_rga_video_convert_finalize;
   g_object_class_install_property(gobject_class, GST_RGA_PROP_CORE_MASK,
                                   rga_props[GST_RGA_PROP_CORE_MASK]);
+  g_object_class_install_property(gobject_class, GST_RGA_PROP_DMA_HEAP,
+                                  rga_props[GST_RGA_PROP_DMA_HEAP]);
+  g_object_class_install_property(gobject_class, GST_RGA_PROP_ASYNC,
+                                  rga_props[GST_RGA_PROP_ASYNC]);
+  g_object_class_install_property(gobject_class, GST_RGA_PROP_MAX_JOBS,
+                                  rga_props[GST_RGA_PROP_MAX_JOBS]);
+  g_object_class_install_property(gobject_class, GST_RGA_PROP_CROP_LEFT,
+                                  rga_props[GST_RGA_PROP_CROP_LEFT]);
+  g_object_class_install_property(gobject_class, GST_RGA_PROP_CROP_RIGHT,
+                                  rga_props[GST_RGA_PROP_CROP_RIGHT]);
+  g_object_class_install_property(gobject_class, GST_RGA_PROP_CROP_TOP,
+                                  rga_props[GST_RGA_PROP_CROP_TOP]);
+  g_object_class_install_property(gobject_class, GST_RGA_PROP_CROP_BOTTOM,
+                                  rga_props[GST_RGA_PROP_CROP_BOTTOM]);
+  g_object_class_install_property(gobject_class, GST_RGA_PROP_ADD_BORDERS,
+                                  rga_props[GST_RGA_PROP_ADD_BORDERS]);
+  g_object_class_install_property(gobject_class, GST_RGA_PROP_FILL_COLOR,
+                                  rga_props[GST_RGA_PROP_FILL_COLOR]);
+  g_object_class_install_property(gobject_class, GST_RGA_PROP_STATS,
+                                  rga_props[GST_RGA_PROP_STATS]);
+  g_object_class_install_property(gobject_class, GST_RGA_PROP_STATS_INTERVAL,
+                                  rga_props[GST_RGA_PROP_STATS_INTERVAL]);
+  g_object_class_install_property(gobject_class, GST_RGA_PROP_TENSOR_MEAN,
+                                  rga_props[GST_RGA_PROP_TENSOR_MEAN]);
+  g_object_class_install_property(gobject_class, GST_RGA_PROP_TENSOR_SCALE,
+                                  rga_props[GST_RGA_PROP_TENSOR_SCALE]);
+  g_object_class_install_property(gobject_class,
+                                  GST_RGA_PROP_SOFTWARE_FALLBACK,
+                                  rga_props[GST_RGA_PROP_SOFTWARE_FALLBACK]);
+  g_object_class_install_property(gobject_class, GST_RGA_PROP_OVERFLOW_JOBS,
+                                  rga_props[GST_RGA_PROP_OVERFLOW_JOBS]);
+  g_object_class_install_property(gobject_class, GST_RGA_PROP_MAX_FPS,
+                                  rga_props[GST_RGA_PROP_MAX_FPS]);
+  g_object_class_install_property(gobject_class, GST_RGA_PROP_IN_PLACE,
+                                  rga_props[GST_RGA_PROP_IN_PLACE]);
+  g_object_class_install_property(gobject_class, GST_RGA_PROP_COLOR_SPACE,
+                                  rga_props[GST_RGA_PROP_COLOR_SPACE]);
+  g_object_class_install_property(gobject_class, GST_RGA_PROP_BATCH_WINDOW,
+                                  rga_props[GST_RGA_PROP_BATCH_WINDOW]);
+  g_object_class_install_property(gobject_class, GST_RGA_PROP_MIN_BUFFERS,
+                                  rga_props[GST_RGA_PROP_MIN_BUFFERS]);
+  g_object_class_install_property(gobject_class, GST_RGA_PROP_MAX_BUFFERS,
+                                  rga_props[GST_RGA_PROP_MAX_BUFFERS]);
+  g_object_class_install_property(gobject_class,
+                                  GST_RGA_PROP_LAZY_ALLOCATION,
+                                  rga_props[GST_RGA_PROP_LAZY_ALLOCATION]);
+  g_object_class_install_property(gobject_class, GST_RGA_PROP_IDLE_TIMEOUT,
+                                  rga_props[GST_RGA_PROP_IDLE_TIMEOUT]);
+  g_object_class_install_property(gobject_class, GST_RGA_PROP_AUTO_DMA32,
+                                  rga_props[GST_RGA_PROP_AUTO_DMA32]);
+  g_object_class_override_property(gobject_class, GST_RGA_PROP_VIDEO_DIRECTION,
+                                   "video-direction");
 
   base_transform_class->passthrough_on_same_caps = TRUE;
 
   base_transform_class->transform_caps =
       GST_DEBUG_FUNCPTR(gst_rga_video_convert_transform_caps);
+  base_transform_class->fixate_caps =
+      GST_DEBUG_FUNCPTR(gst_rga_video_convert_fixate_caps);
+
+  base_transform_class->set_caps =
+      GST_DEBUG_FUNCPTR(gst_rga_video_convert_set_caps);
+  base_transform_class->sink_event =
+      GST_DEBUG_FUNCPTR(gst_rga_video_convert_sink_event);
+  base_transform_class->src_event =
+      GST_DEBUG_FUNCPTR(gst_rga_video_convert_src_event);
+  base_transform_class->submit_input_buffer =
+      GST_DEBUG_FUNCPTR(gst_rga_video_convert_submit_input_buffer);
+  base_transform_class->prepare_output_buffer =
+      GST_DEBUG_FUNCPTR(gst_rga_video_convert_prepare_output_buffer);
+  base_transform_class->decide_allocation =
+      GST_DEBUG_FUNCPTR(gst_rga_video_convert_decide_allocation);
+  base_transform_class->propose_allocation =
+      GST_DEBUG_FUNCPTR(gst_rga_video_convert_propose_allocation);
 
   base_transform_class->start = GST_DEBUG_FUNCPTR(gst_rga_video_convert_start);
   base_transform_class->stop = GST_DEBUG_FUNCPTR(gst_rga_video_convert_stop);
   video_filter_class->set_info =
       GST_DEBUG_FUNCPTR(gst_rga_video_convert_set_info);
-  video_filter_class->transform_frame =
-      GST_DEBUG_FUNCPTR(gst_rga_video_convert_transform_frame);
-}
-
-static RgaSURF_FORMAT gst_gst_format_to_rga_format(GstVideoFormat format) {
-  switch (format) {
-    GST_CASE_RETURN(GST_VIDEO_FORMAT_I420, RK_FORMAT_YCbCr_420_P);
-    GST_CASE_RETURN(GST_VIDEO_FORMAT_YV12, RK_FORMAT_YCrCb_420_P);
-    GST_CASE_RETURN(GST_VIDEO_FORMAT_NV12, RK_FORMAT_YCbCr_420_SP);
-    GST_CASE_RETURN(GST_VIDEO_FORMAT_NV21, RK_FORMAT_YCrCb_420_SP);
-#ifdef HAVE_NV12_10LE40
-    GST_CASE_RETURN(GST_VIDEO_FORMAT_NV12_10LE40, RK_FORMAT_YCbCr_420_SP_10B);
-#endif
-    GST_CASE_RETURN(GST_VIDEO_FORMAT_Y42B, RK_FORMAT_YCbCr_422_P);
-    GST_CASE_RETURN(GST_VIDEO_FORMAT_NV16, RK_FORMAT_YCbCr_422_SP);
-    GST_CASE_RETURN(GST_VIDEO_FORMAT_NV61, RK_FORMAT_YCrCb_422_SP);
-    GST_CASE_RETURN(GST_VIDEO_FORMAT_RGB16, RK_FORMAT_RGB_565);
-    GST_CASE_RETURN(GST_VIDEO_FORMAT_RGB15, RK_FORMAT_RGBA_5551);
-    GST_CASE_RETURN(GST_VIDEO_FORMAT_BGR, RK_FORMAT_BGR_888);
-    GST_CASE_RETURN(GST_VIDEO_FORMAT_RGB, RK_FORMAT_RGB_888);
-    GST_CASE_RETURN(GST_VIDEO_FORMAT_BGRA, RK_FORMAT_BGRA_8888);
-    GST_CASE_RETURN(GST_VIDEO_FORMAT_RGBA, RK_FORMAT_RGBA_8888);
-    GST_CASE_RETURN(GST_VIDEO_FORMAT_BGRx, RK_FORMAT_BGRX_8888);
-    GST_CASE_RETURN(GST_VIDEO_FORMAT_RGBx, RK_FORMAT_RGBX_8888);
-    default:
-      return RK_FORMAT_UNKNOWN;
-  }
-}
-
-static gboolean gst_set_rga_info(rga_info_t *info, RgaSURF_FORMAT format,
-                                 guint width, guint height, guint hstride,
-                                 guint vstride) {
-  gint pixel_stride;
-
-  switch (format) {
-    case RK_FORMAT_RGBX_8888:
-    case RK_FORMAT_BGRX_8888:
-    case RK_FORMAT_RGBA_8888:
-    case RK_FORMAT_BGRA_8888:
-      pixel_stride = 4;
-      break;
-    case RK_FORMAT_RGB_888:
-    case RK_FORMAT_BGR_888:
-      pixel_stride = 3;
-      break;
-    case RK_FORMAT_RGBA_5551:
-    case RK_FORMAT_RGB_565:
-      pixel_stride = 2;
-      break;
-    case RK_FORMAT_YCbCr_420_SP_10B:
-    case RK_FORMAT_YCbCr_422_SP:
-    case RK_FORMAT_YCrCb_422_SP:
-    case RK_FORMAT_YCbCr_422_P:
-    case RK_FORMAT_YCrCb_422_P:
-    case RK_FORMAT_YCbCr_420_SP:
-    case RK_FORMAT_YCrCb_420_SP:
-    case RK_FORMAT_YCbCr_420_P:
-    case RK_FORMAT_YCrCb_420_P:
-      pixel_stride = 1;
-
-      /* RGA requires yuv image rect align to 2 */
-      width &= ~1;
-      height &= ~1;
-      break;
-    default:
-      return FALSE;
-  }
-
-  if (info->fd < 0 && !info->virAddr) return FALSE;
-
-  if (hstride / pixel_stride >= width) hstride /= pixel_stride;
-
-  info->mmuFlag = 1;
-  rga_set_rect(&info->rect, 0, 0, width, height, hstride, vstride, format);
-  return TRUE;
+  /* RGA reads the buffers by fd, so skip the CPU mapping done by
+   * GstVideoFilter in transform_frame */
+  base_transform_class->transform =
+      GST_DEBUG_FUNCPTR(gst_rga_video_convert_transform);
 }
 
-static gboolean gst_rga_info_from_video_frame(rga_info_t *info,
-                                              GstVideoFrame *frame,
-                                              GstMapInfo *mapInfo,
-                                              GstMapFlags mapFlag) {
-  RgaSURF_FORMAT rga_format =
-      gst_gst_format_to_rga_format(GST_VIDEO_FRAME_FORMAT(frame));
-
-  guint width = GST_VIDEO_FRAME_WIDTH(frame);
-  guint height = GST_VIDEO_FRAME_HEIGHT(frame);
-  guint hstride = GST_VIDEO_FRAME_PLANE_STRIDE(frame, 0);
-  guint vstride = GST_VIDEO_FRAME_N_PLANES(frame) == 1
-                      ? GST_VIDEO_INFO_HEIGHT(&frame->info)
-                      : GST_VIDEO_INFO_PLANE_OFFSET(&frame->info, 1) / hstride;
-
-  if (!gst_set_rga_info(info, rga_format, width, height, hstride, vstride)) {
-    return FALSE;
-  }
-  GstBuffer *inbuf = frame->buffer;
-  if (gst_buffer_n_memory(inbuf) == 1) {
-    GstMemory *mem = gst_buffer_peek_memory(inbuf, 0);
-    gsize offset;
-
-    if (gst_is_dmabuf_memory(mem)) {
-      gst_memory_get_sizes(mem, &offset, NULL);
-      if (!offset) info->fd = gst_dmabuf_memory_get_fd(mem);
-    }
-  }
-
-  if (info->fd <= 0) {
-    gst_buffer_map(inbuf, mapInfo, mapFlag);
-    info->virAddr = mapInfo->data;
-  }
-  return TRUE;
-}
 
 static GstCaps *gst_rga_video_convert_transform_caps(GstBaseTransform *trans,
                                                      GstPadDirection direction,
@@ -311,22 +511,17 @@ static GstCaps *gst_rga_video_convert_transform_caps(GstBaseTransform *trans,
     /* make copy */
     structure = gst_structure_copy(structure);
 
-    if (direction == GST_PAD_SRC) {
-      // rga 输出最大 4096
-      gst_structure_set(structure, "width", GST_TYPE_INT_RANGE, 1, 4096,
-                        "height", GST_TYPE_INT_RANGE, 1, 4096, NULL);
-    } else {
-      // 输入最大 8192
-      gst_structure_set(structure, "width", GST_TYPE_INT_RANGE, 1, 8192,
-                        "height", GST_TYPE_INT_RANGE, 1, 8192, NULL);
-    }
-    if (!gst_caps_features_is_any(features)) {
-      gst_structure_remove_fields(structure, "format", "colorimetry",
-                                  "chroma-site", NULL);
+    /* frames above the RGA limits are split into tiles */
+    gst_structure_set(structure, "width", GST_TYPE_INT_RANGE, 1,
+                      RGA_MAX_TILED_SIZE, "height", GST_TYPE_INT_RANGE, 1,
+                      RGA_MAX_TILED_SIZE, NULL);
+    if (gst_caps_features_is_any(features)) {
+      gst_caps_append_structure_full(ret, structure,
+                                     gst_caps_features_copy(features));
+      continue;
     }
 
-    gst_caps_append_structure_full(ret, structure,
-                                   gst_caps_features_copy(features));
+    ret = gst_caps_merge(ret, gst_rga_caps_any_memory(structure, features));
   }
 
   if (filter) {
@@ -343,6 +538,145 @@ static GstCaps *gst_rga_video_convert_transform_caps(GstBaseTransform *trans,
   return ret;
 }
 
+static gboolean gst_rga_structure_is_yuv(const GstStructure *s) {
+  const gchar *name = gst_structure_get_string(s, "format");
+  if (!name) return FALSE;
+
+  GstVideoFormat format = gst_video_format_from_string(name);
+  return format != GST_VIDEO_FORMAT_UNKNOWN &&
+         GST_VIDEO_FORMAT_INFO_IS_YUV(gst_video_format_get_info(format));
+}
+
+/* RGA only converts between YUV and RGB, never between two YUV matrices,
+ * so a YUV output downstream leaves open keeps the colorimetry of a YUV
+ * input */
+static GstCaps *gst_rga_video_convert_fixate_colorimetry(
+    const GstStructure *ins, GstCaps *outcaps) {
+  static const gchar *fields[] = {"colorimetry", "chroma-site"};
+
+  if (gst_caps_is_empty(outcaps) || !gst_rga_structure_is_yuv(ins) ||
+      !gst_rga_structure_is_yuv(gst_caps_get_structure(outcaps, 0)))
+    return outcaps;
+
+  outcaps = gst_caps_make_writable(outcaps);
+  GstStructure *outs = gst_caps_get_structure(outcaps, 0);
+  for (guint i = 0; i < G_N_ELEMENTS(fields); i++) {
+    const GValue *value = gst_structure_get_value(ins, fields[i]);
+
+    if (value && !gst_structure_has_field(outs, fields[i]))
+      gst_structure_set_value(outs, fields[i], value);
+  }
+  return outcaps;
+}
+
+/* video-direction with auto resolved from the image-orientation tag, call
+ * with the object lock */
+static GstVideoOrientationMethod gst_rga_video_convert_method_unlocked(
+    GstRgaVideoConvert *rgavideoconvert) {
+  if (rgavideoconvert->method == GST_VIDEO_ORIENTATION_AUTO)
+    return rgavideoconvert->tag_method;
+  return rgavideoconvert->method;
+}
+
+static gboolean gst_rga_method_swaps_size(GstVideoOrientationMethod method) {
+  return method == GST_VIDEO_ORIENTATION_90R ||
+         method == GST_VIDEO_ORIENTATION_90L ||
+         method == GST_VIDEO_ORIENTATION_UL_LR ||
+         method == GST_VIDEO_ORIENTATION_UR_LL;
+}
+
+/* Prefers an output of the size of the cropped and rotated input, like
+ * videocrop and videoflip. transform_caps allows any output size since RGA
+ * scales, so the swap for 90/270 degrees only matters here. */
+static GstCaps *gst_rga_video_convert_fixate_caps(GstBaseTransform *trans,
+                                                  GstPadDirection direction,
+                                                  GstCaps *caps,
+                                                  GstCaps *othercaps) {
+  GstRgaVideoConvert *rgavideoconvert = gst_rga_video_convert(trans);
+  GstStructure *ins = gst_caps_get_structure(caps, 0);
+  gint width, height;
+
+  if (direction == GST_PAD_SINK &&
+      gst_structure_get_int(ins, "width", &width) &&
+      gst_structure_get_int(ins, "height", &height)) {
+    GST_OBJECT_LOCK(rgavideoconvert);
+    width -= rgavideoconvert->crop_left + rgavideoconvert->crop_right;
+    height -= rgavideoconvert->crop_top + rgavideoconvert->crop_bottom;
+    gboolean swap = gst_rga_method_swaps_size(
+        gst_rga_video_convert_method_unlocked(rgavideoconvert));
+    GST_OBJECT_UNLOCK(rgavideoconvert);
+
+    if (swap) {
+      gint tmp = width;
+      width = height;
+      height = tmp;
+    }
+
+    othercaps = gst_caps_make_writable(gst_caps_truncate(othercaps));
+    GstStructure *outs = gst_caps_get_structure(othercaps, 0);
+    gst_structure_fixate_field_nearest_int(outs, "width", MAX(width, 1));
+    gst_structure_fixate_field_nearest_int(outs, "height", MAX(height, 1));
+  }
+
+  othercaps = GST_BASE_TRANSFORM_CLASS(gst_rga_video_convert_parent_class)
+                  ->fixate_caps(trans, direction, caps, othercaps);
+  if (direction == GST_PAD_SINK)
+    othercaps = gst_rga_video_convert_fixate_colorimetry(ins, othercaps);
+  return othercaps;
+}
+
+/* TRUE when the output differs from the input even with equal caps */
+static gboolean gst_rga_video_convert_changes_picture(
+    GstRgaVideoConvert *rgavideoconvert) {
+  GST_OBJECT_LOCK(rgavideoconvert);
+  gboolean ret = rgavideoconvert->crop_left || rgavideoconvert->crop_right ||
+                 rgavideoconvert->crop_top || rgavideoconvert->crop_bottom ||
+                 gst_rga_video_convert_method_unlocked(rgavideoconvert) !=
+                     GST_VIDEO_ORIENTATION_IDENTITY;
+  GST_OBJECT_UNLOCK(rgavideoconvert);
+  return ret;
+}
+
+/* Call after a change of crop or direction. The base class keeps the old
+ * configuration when renegotiation ends up with the same caps, so leave
+ * passthrough here. */
+static void gst_rga_video_convert_reconfigure(
+    GstRgaVideoConvert *rgavideoconvert) {
+  GstBaseTransform *trans = GST_BASE_TRANSFORM(rgavideoconvert);
+
+  if (gst_rga_video_convert_changes_picture(rgavideoconvert))
+    gst_base_transform_set_passthrough(trans, FALSE);
+  gst_base_transform_reconfigure_src(trans);
+}
+
+static void gst_rga_video_convert_set_crop(GstRgaVideoConvert *rgavideoconvert,
+                                           guint *crop, const GValue *value) {
+  GST_OBJECT_LOCK(rgavideoconvert);
+  *crop = g_value_get_uint(value);
+  GST_OBJECT_UNLOCK(rgavideoconvert);
+
+  gst_rga_video_convert_reconfigure(rgavideoconvert);
+}
+
+/* Takes up to three channel values from a GstValueArray, call with the
+ * object lock */
+static void gst_rga_video_convert_set_channels(gdouble channels[3],
+                                               const GValue *value) {
+  for (guint c = 0; c < MIN(gst_value_array_get_size(value), 3); c++)
+    channels[c] = g_value_get_double(gst_value_array_get_value(value, c));
+}
+
+static void gst_rga_video_convert_get_channels(const gdouble channels[3],
+                                               GValue *value) {
+  for (guint c = 0; c < 3; c++) {
+    GValue v = G_VALUE_INIT;
+
+    g_value_init(&v, G_TYPE_DOUBLE);
+    g_value_set_double(&v, channels[c]);
+    gst_value_array_append_and_take_value(value, &v);
+  }
+}
+
 static void gst_rga_video_convert_set_property(GObject *object, guint prop_id,
                                                const GValue *value,
                                                GParamSpec *pspec) {
@@ -351,6 +685,109 @@ static void gst_rga_video_convert_set_property(GObject *object, guint prop_id,
     case GST_RGA_PROP_CORE_MASK:
       rgavideoconvert->core_mask = g_value_get_flags(value);
       break;
+    case GST_RGA_PROP_DMA_HEAP:
+      g_free(rgavideoconvert->dma_heap);
+      rgavideoconvert->dma_heap = g_value_dup_string(value);
+      break;
+    case GST_RGA_PROP_ASYNC:
+      rgavideoconvert->async = g_value_get_boolean(value);
+      break;
+    case GST_RGA_PROP_MAX_JOBS:
+      rgavideoconvert->max_jobs = g_value_get_uint(value);
+      break;
+    case GST_RGA_PROP_CROP_LEFT:
+      gst_rga_video_convert_set_crop(rgavideoconvert,
+                                     &rgavideoconvert->crop_left, value);
+      break;
+    case GST_RGA_PROP_CROP_RIGHT:
+      gst_rga_video_convert_set_crop(rgavideoconvert,
+                                     &rgavideoconvert->crop_right, value);
+      break;
+    case GST_RGA_PROP_CROP_TOP:
+      gst_rga_video_convert_set_crop(rgavideoconvert,
+                                     &rgavideoconvert->crop_top, value);
+      break;
+    case GST_RGA_PROP_CROP_BOTTOM:
+      gst_rga_video_convert_set_crop(rgavideoconvert,
+                                     &rgavideoconvert->crop_bottom, value);
+      break;
+    case GST_RGA_PROP_ADD_BORDERS:
+      GST_OBJECT_LOCK(rgavideoconvert);
+      rgavideoconvert->add_borders = g_value_get_boolean(value);
+      GST_OBJECT_UNLOCK(rgavideoconvert);
+      break;
+    case GST_RGA_PROP_FILL_COLOR:
+      GST_OBJECT_LOCK(rgavideoconvert);
+      rgavideoconvert->fill_color = g_value_get_uint(value);
+      GST_OBJECT_UNLOCK(rgavideoconvert);
+      break;
+    case GST_RGA_PROP_STATS_INTERVAL:
+      GST_OBJECT_LOCK(rgavideoconvert);
+      rgavideoconvert->stats_interval = g_value_get_uint(value);
+      GST_OBJECT_UNLOCK(rgavideoconvert);
+      break;
+    case GST_RGA_PROP_TENSOR_MEAN:
+      GST_OBJECT_LOCK(rgavideoconvert);
+      gst_rga_video_convert_set_channels(rgavideoconvert->tensor_mean, value);
+      GST_OBJECT_UNLOCK(rgavideoconvert);
+      break;
+    case GST_RGA_PROP_TENSOR_SCALE:
+      GST_OBJECT_LOCK(rgavideoconvert);
+      gst_rga_video_convert_set_channels(rgavideoconvert->tensor_scale, value);
+      GST_OBJECT_UNLOCK(rgavideoconvert);
+      break;
+    case GST_RGA_PROP_SOFTWARE_FALLBACK:
+      GST_OBJECT_LOCK(rgavideoconvert);
+      rgavideoconvert->software_fallback = g_value_get_boolean(value);
+      GST_OBJECT_UNLOCK(rgavideoconvert);
+      break;
+    case GST_RGA_PROP_OVERFLOW_JOBS:
+      GST_OBJECT_LOCK(rgavideoconvert);
+      rgavideoconvert->overflow_jobs = g_value_get_uint(value);
+      GST_OBJECT_UNLOCK(rgavideoconvert);
+      break;
+    case GST_RGA_PROP_MAX_FPS:
+      GST_OBJECT_LOCK(rgavideoconvert);
+      rgavideoconvert->max_fps_n = gst_value_get_fraction_numerator(value);
+      rgavideoconvert->max_fps_d = gst_value_get_fraction_denominator(value);
+      GST_OBJECT_UNLOCK(rgavideoconvert);
+      break;
+    case GST_RGA_PROP_IN_PLACE:
+      GST_OBJECT_LOCK(rgavideoconvert);
+      rgavideoconvert->in_place = g_value_get_boolean(value);
+      GST_OBJECT_UNLOCK(rgavideoconvert);
+      break;
+    case GST_RGA_PROP_COLOR_SPACE:
+      GST_OBJECT_LOCK(rgavideoconvert);
+      rgavideoconvert->color_space = g_value_get_enum(value);
+      GST_OBJECT_UNLOCK(rgavideoconvert);
+      break;
+    case GST_RGA_PROP_BATCH_WINDOW:
+      GST_OBJECT_LOCK(rgavideoconvert);
+      rgavideoconvert->batch_window = g_value_get_uint(value);
+      GST_OBJECT_UNLOCK(rgavideoconvert);
+      break;
+    case GST_RGA_PROP_MIN_BUFFERS:
+      rgavideoconvert->min_buffers = g_value_get_uint(value);
+      break;
+    case GST_RGA_PROP_MAX_BUFFERS:
+      rgavideoconvert->max_buffers = g_value_get_uint(value);
+      break;
+    case GST_RGA_PROP_LAZY_ALLOCATION:
+      rgavideoconvert->lazy_allocation = g_value_get_boolean(value);
+      break;
+    case GST_RGA_PROP_IDLE_TIMEOUT:
+      rgavideoconvert->idle_timeout = g_value_get_uint(value);
+      break;
+    case GST_RGA_PROP_AUTO_DMA32:
+      rgavideoconvert->auto_dma32 = g_value_get_boolean(value);
+      break;
+    case GST_RGA_PROP_VIDEO_DIRECTION:
+      GST_OBJECT_LOCK(rgavideoconvert);
+      rgavideoconvert->method = g_value_get_enum(value);
+      GST_OBJECT_UNLOCK(rgavideoconvert);
+      gst_rga_video_convert_reconfigure(rgavideoconvert);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
   }
@@ -364,20 +801,775 @@ static void gst_rga_video_convert_get_property(GObject *object, guint prop_id,
     case GST_RGA_PROP_CORE_MASK:
       g_value_set_flags(value, rgavideoconvert->core_mask);
       break;
+    case GST_RGA_PROP_DMA_HEAP:
+      g_value_set_string(value, rgavideoconvert->dma_heap);
+      break;
+    case GST_RGA_PROP_ASYNC:
+      g_value_set_boolean(value, rgavideoconvert->async);
+      break;
+    case GST_RGA_PROP_MAX_JOBS:
+      g_value_set_uint(value, rgavideoconvert->max_jobs);
+      break;
+    case GST_RGA_PROP_CROP_LEFT:
+      GST_OBJECT_LOCK(rgavideoconvert);
+      g_value_set_uint(value, rgavideoconvert->crop_left);
+      GST_OBJECT_UNLOCK(rgavideoconvert);
+      break;
+    case GST_RGA_PROP_CROP_RIGHT:
+      GST_OBJECT_LOCK(rgavideoconvert);
+      g_value_set_uint(value, rgavideoconvert->crop_right);
+      GST_OBJECT_UNLOCK(rgavideoconvert);
+      break;
+    case GST_RGA_PROP_CROP_TOP:
+      GST_OBJECT_LOCK(rgavideoconvert);
+      g_value_set_uint(value, rgavideoconvert->crop_top);
+      GST_OBJECT_UNLOCK(rgavideoconvert);
+      break;
+    case GST_RGA_PROP_CROP_BOTTOM:
+      GST_OBJECT_LOCK(rgavideoconvert);
+      g_value_set_uint(value, rgavideoconvert->crop_bottom);
+      GST_OBJECT_UNLOCK(rgavideoconvert);
+      break;
+    case GST_RGA_PROP_ADD_BORDERS:
+      GST_OBJECT_LOCK(rgavideoconvert);
+      g_value_set_boolean(value, rgavideoconvert->add_borders);
+      GST_OBJECT_UNLOCK(rgavideoconvert);
+      break;
+    case GST_RGA_PROP_FILL_COLOR:
+      GST_OBJECT_LOCK(rgavideoconvert);
+      g_value_set_uint(value, rgavideoconvert->fill_color);
+      GST_OBJECT_UNLOCK(rgavideoconvert);
+      break;
+    case GST_RGA_PROP_STATS:
+      g_value_take_boxed(value,
+                         gst_rga_stats_to_structure(&rgavideoconvert->stats));
+      break;
+    case GST_RGA_PROP_STATS_INTERVAL:
+      GST_OBJECT_LOCK(rgavideoconvert);
+      g_value_set_uint(value, rgavideoconvert->stats_interval);
+      GST_OBJECT_UNLOCK(rgavideoconvert);
+      break;
+    case GST_RGA_PROP_TENSOR_MEAN:
+      GST_OBJECT_LOCK(rgavideoconvert);
+      gst_rga_video_convert_get_channels(rgavideoconvert->tensor_mean, value);
+      GST_OBJECT_UNLOCK(rgavideoconvert);
+      break;
+    case GST_RGA_PROP_TENSOR_SCALE:
+      GST_OBJECT_LOCK(rgavideoconvert);
+      gst_rga_video_convert_get_channels(rgavideoconvert->tensor_scale, value);
+      GST_OBJECT_UNLOCK(rgavideoconvert);
+      break;
+    case GST_RGA_PROP_SOFTWARE_FALLBACK:
+      GST_OBJECT_LOCK(rgavideoconvert);
+      g_value_set_boolean(value, rgavideoconvert->software_fallback);
+      GST_OBJECT_UNLOCK(rgavideoconvert);
+      break;
+    case GST_RGA_PROP_OVERFLOW_JOBS:
+      GST_OBJECT_LOCK(rgavideoconvert);
+      g_value_set_uint(value, rgavideoconvert->overflow_jobs);
+      GST_OBJECT_UNLOCK(rgavideoconvert);
+      break;
+    case GST_RGA_PROP_MAX_FPS:
+      GST_OBJECT_LOCK(rgavideoconvert);
+      gst_value_set_fraction(value, rgavideoconvert->max_fps_n,
+                             rgavideoconvert->max_fps_d);
+      GST_OBJECT_UNLOCK(rgavideoconvert);
+      break;
+    case GST_RGA_PROP_IN_PLACE:
+      GST_OBJECT_LOCK(rgavideoconvert);
+      g_value_set_boolean(value, rgavideoconvert->in_place);
+      GST_OBJECT_UNLOCK(rgavideoconvert);
+      break;
+    case GST_RGA_PROP_COLOR_SPACE:
+      GST_OBJECT_LOCK(rgavideoconvert);
+      g_value_set_enum(value, rgavideoconvert->color_space);
+      GST_OBJECT_UNLOCK(rgavideoconvert);
+      break;
+    case GST_RGA_PROP_BATCH_WINDOW:
+      GST_OBJECT_LOCK(rgavideoconvert);
+      g_value_set_uint(value, rgavideoconvert->batch_window);
+      GST_OBJECT_UNLOCK(rgavideoconvert);
+      break;
+    case GST_RGA_PROP_MIN_BUFFERS:
+      g_value_set_uint(value, rgavideoconvert->min_buffers);
+      break;
+    case GST_RGA_PROP_MAX_BUFFERS:
+      g_value_set_uint(value, rgavideoconvert->max_buffers);
+      break;
+    case GST_RGA_PROP_LAZY_ALLOCATION:
+      g_value_set_boolean(value, rgavideoconvert->lazy_allocation);
+      break;
+    case GST_RGA_PROP_IDLE_TIMEOUT:
+      g_value_set_uint(value, rgavideoconvert->idle_timeout);
+      break;
+    case GST_RGA_PROP_AUTO_DMA32:
+      g_value_set_boolean(value, rgavideoconvert->auto_dma32);
+      break;
+    case GST_RGA_PROP_VIDEO_DIRECTION:
+      GST_OBJECT_LOCK(rgavideoconvert);
+      g_value_set_enum(value, rgavideoconvert->method);
+      GST_OBJECT_UNLOCK(rgavideoconvert);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
   }
 }
 
-static void gst_rga_video_convert_init(GstRgaVideoConvert *rgavideoconvert) {}
+static void gst_rga_video_convert_init(GstRgaVideoConvert *rgavideoconvert) {
+  rgavideoconvert->dma_heap = g_strdup(DEFAULT_DMA_HEAP);
+  rgavideoconvert->async = DEFAULT_ASYNC;
+  rgavideoconvert->max_jobs = DEFAULT_MAX_JOBS;
+  rgavideoconvert->add_borders = DEFAULT_ADD_BORDERS;
+  rgavideoconvert->fill_color = DEFAULT_FILL_COLOR;
+  rgavideoconvert->method = GST_VIDEO_ORIENTATION_IDENTITY;
+  rgavideoconvert->tag_method = GST_VIDEO_ORIENTATION_IDENTITY;
+  rgavideoconvert->stats_interval = DEFAULT_STATS_INTERVAL;
+  rgavideoconvert->software_fallback = DEFAULT_SOFTWARE_FALLBACK;
+  rgavideoconvert->overflow_jobs = DEFAULT_OVERFLOW_JOBS;
+  rgavideoconvert->max_fps_n = DEFAULT_MAX_FPS_N;
+  rgavideoconvert->max_fps_d = DEFAULT_MAX_FPS_D;
+  rgavideoconvert->in_place = DEFAULT_IN_PLACE;
+  rgavideoconvert->color_space = DEFAULT_COLOR_SPACE;
+  rgavideoconvert->batch_window = DEFAULT_BATCH_WINDOW;
+  rgavideoconvert->min_buffers = DEFAULT_MIN_BUFFERS;
+  rgavideoconvert->max_buffers = DEFAULT_MAX_BUFFERS;
+  rgavideoconvert->lazy_allocation = DEFAULT_LAZY_ALLOCATION;
+  rgavideoconvert->idle_timeout = DEFAULT_IDLE_TIMEOUT;
+  rgavideoconvert->auto_dma32 = DEFAULT_AUTO_DMA32;
+  rgavideoconvert->qos_proportion = 1.0;
+  rgavideoconvert->next_ts = GST_CLOCK_TIME_NONE;
+  for (guint c = 0; c < 3; c++) {
+    rgavideoconvert->tensor_mean[c] = 0.0;
+    rgavideoconvert->tensor_scale[c] = 1.0;
+  }
+
+  gst_rga_stats_init(&rgavideoconvert->stats);
+  g_mutex_init(&rgavideoconvert->lock);
+  g_cond_init(&rgavideoconvert->cond);
+  g_queue_init(&rgavideoconvert->jobs);
+
+  /* late frames are dropped before they reach RGA */
+  gst_base_transform_set_qos_enabled(GST_BASE_TRANSFORM(rgavideoconvert),
+                                     TRUE);
+}
+
+static void gst_rga_video_convert_finalize(GObject *object) {
+  GstRgaVideoConvert *rgavideoconvert = gst_rga_video_convert(object);
+
+  g_free(rgavideoconvert->dma_heap);
+  gst_rga_stats_clear(&rgavideoconvert->stats);
+  g_mutex_clear(&rgavideoconvert->lock);
+  g_cond_clear(&rgavideoconvert->cond);
+
+  G_OBJECT_CLASS(gst_rga_video_convert_parent_class)->finalize(object);
+}
+
+/* allocation */
+
+/* The allocator of the dma-heap property, or of a dma32 heap when jobs can
+ * only run on RGA2 and RGA2 cannot reach every buffer of the board */
+static GstAllocator *gst_rga_video_convert_create_allocator(
+    GstRgaVideoConvert *rgavideoconvert) {
+  GstObject *obj = GST_OBJECT(rgavideoconvert);
+
+  if (rgavideoconvert->auto_dma32 && rgavideoconvert->scheduler &&
+      gst_rga_scheduler_needs_dma32(rgavideoconvert->scheduler,
+                                    rgavideoconvert->core_mask))
+    return gst_rga_create_dma32_allocator(obj, rgavideoconvert->dma_heap);
+
+  return gst_rga_create_allocator(obj, rgavideoconvert->dma_heap);
+}
+
+static gboolean gst_rga_video_convert_decide_allocation(
+    GstBaseTransform *trans, GstQuery *query) {
+  GstRgaVideoConvert *rgavideoconvert = gst_rga_video_convert(trans);
+  GstAllocator *allocator =
+      gst_rga_video_convert_create_allocator(rgavideoconvert);
+
+  if (!allocator) {
+    GST_WARNING_OBJECT(rgavideoconvert,
+                       "no dma-heap available, output buffers will be "
+                       "mapped by the CPU");
+    return GST_BASE_TRANSFORM_CLASS(gst_rga_video_convert_parent_class)
+        ->decide_allocation(trans, query);
+  }
+
+  GstRgaPoolParams params = {
+      rgavideoconvert->min_buffers,
+      rgavideoconvert->max_buffers,
+      rgavideoconvert->lazy_allocation,
+      rgavideoconvert->idle_timeout * GST_MSECOND,
+  };
+  gboolean ret =
+      gst_rga_decide_allocation(GST_OBJECT(trans), query, allocator, &params);
+  gst_object_unref(allocator);
+  return ret;
+}
+
+static gboolean gst_rga_video_convert_propose_allocation(
+    GstBaseTransform *trans, GstQuery *decide_query, GstQuery *query) {
+  GstRgaVideoConvert *rgavideoconvert = gst_rga_video_convert(trans);
+  GstCaps *caps;
+
+  /* passthrough, let downstream answer */
+  if (!decide_query)
+    return GST_BASE_TRANSFORM_CLASS(gst_rga_video_convert_parent_class)
+        ->propose_allocation(trans, decide_query, query);
+
+  gst_query_parse_allocation(query, &caps, NULL);
+  if (!caps) return FALSE;
+
+  GstAllocator *allocator =
+      gst_rga_video_convert_create_allocator(rgavideoconvert);
+  gst_rga_propose_allocation(GST_OBJECT(trans), query, allocator);
+  if (allocator) gst_object_unref(allocator);
+
+  gst_query_add_allocation_meta(query, GST_VIDEO_META_API_TYPE, NULL);
+  gst_query_add_allocation_meta(query, GST_VIDEO_CROP_META_API_TYPE, NULL);
+  return TRUE;
+}
+
+/* async jobs */
+
+typedef struct {
+  GstBuffer *inbuf;
+  GstBuffer *outbuf;
+  GstBuffer *staging;
+  GstMapInfo in_map;
+  GstMapInfo out_map;
+  gint fence;
+  guint32 core;
+  /* the second half of the tiles of a large frame, on another core */
+  gint tile_fence;
+  guint32 tile_core;
+  /* for the stats and the tracer */
+  GstClockTime start;
+  GstClockTime submitted;
+  GstClockTime done;
+  guint64 bytes;
+} GstRgaJob;
+
+/* Releases what the hardware needed while the job was running */
+static void gst_rga_job_clear(GstRgaJob *job) {
+  if (job->in_map.memory) gst_buffer_unmap(job->inbuf, &job->in_map);
+  if (job->out_map.memory) gst_buffer_unmap(job->outbuf, &job->out_map);
+  job->in_map.memory = job->out_map.memory = NULL;
+  if (job->staging) gst_buffer_unref(job->staging);
+  job->staging = NULL;
+}
+
+static void gst_rga_job_free(GstRgaJob *job) {
+  gst_rga_job_clear(job);
+  if (job->fence >= 0) close(job->fence);
+  if (job->tile_fence >= 0) close(job->tile_fence);
+  if (job->inbuf) gst_buffer_unref(job->inbuf);
+  if (job->outbuf) gst_buffer_unref(job->outbuf);
+  g_free(job);
+}
+
+/* When a signalled @fence signalled, on the monotonic clock, or
+ * GST_CLOCK_TIME_NONE when the kernel does not tell */
+static GstClockTime gst_rga_fence_signalled(gint fence) {
+  struct sync_fence_info fences[4];
+  struct sync_file_info info = {
+      0,
+  };
+
+  info.num_fences = G_N_ELEMENTS(fences);
+  info.sync_fence_info = (guint64)(guintptr)fences;
+  if (ioctl(fence, SYNC_IOC_FILE_INFO, &info) < 0 || info.status != 1)
+    return GST_CLOCK_TIME_NONE;
+
+  GstClockTime signalled = 0;
+  for (guint i = 0; i < info.num_fences; i++)
+    signalled = MAX(signalled, fences[i].timestamp_ns);
+  return signalled ? signalled : GST_CLOCK_TIME_NONE;
+}
+
+/* Waits for a release fence and closes it, FALSE on error.
+ * @done gets when the hardware finished: the push thread only waits for a
+ * fence after pushing the previous frame, which may be long after. A late
+ * fence is waited for anyway, the hardware may still use the buffers and
+ * the driver fails a hung job itself. */
+static gboolean gst_rga_fence_wait(gint *fence, GstClockTime *done) {
+  if (*fence < 0) return TRUE;
+
+  struct pollfd pfd = {*fence, POLLIN, 0};
+  gint timeout = RGA_FENCE_TIMEOUT_MS;
+  gint ret;
+  while (TRUE) {
+    ret = poll(&pfd, 1, timeout);
+    if (ret < 0 && (errno == EINTR || errno == EAGAIN)) continue;
+    if (ret == 0 && timeout >= 0) {
+      GST_WARNING("RGA job still running after %d ms", RGA_FENCE_TIMEOUT_MS);
+      timeout = -1;
+      continue;
+    }
+    break;
+  }
+
+  gboolean signalled = ret > 0 && !(pfd.revents & (POLLERR | POLLNVAL));
+  if (signalled) {
+    GstClockTime when = gst_rga_fence_signalled(*fence);
+
+    if (!GST_CLOCK_TIME_IS_VALID(when)) when = gst_util_get_timestamp();
+    *done = MAX(*done, when);
+  }
+
+  close(*fence);
+  *fence = -1;
+  return signalled;
+}
+
+/* Waits for the release fences of a job, FALSE on error */
+static gboolean gst_rga_job_wait(GstRgaJob *job) {
+  gboolean done = gst_rga_fence_wait(&job->fence, &job->done);
+
+  done = gst_rga_fence_wait(&job->tile_fence, &job->done) && done;
+  /* converted on the CPU */
+  if (!job->done) job->done = gst_util_get_timestamp();
+  return done;
+}
+
+/* Folds @other into @fence so that one wait covers both, takes @other */
+static void gst_rga_fence_merge(gint *fence, gint other) {
+  struct sync_merge_data data = {
+      0,
+  };
+
+  if (other < 0) return;
+  if (*fence < 0) {
+    *fence = other;
+    return;
+  }
+
+  data.fd2 = other;
+  g_strlcpy(data.name, "rga", sizeof(data.name));
+  if (ioctl(*fence, SYNC_IOC_MERGE, &data) < 0) {
+    GstClockTime done = 0;
+
+    GST_WARNING("cannot merge fences: %s", g_strerror(errno));
+    gst_rga_fence_wait(&other, &done);
+    return;
+  }
+  close(*fence);
+  close(other);
+  *fence = data.fence;
+}
+
+/* Logs a job once its fences were waited for, which set job->done */
+static void gst_rga_video_convert_trace_job(
+    GstRgaVideoConvert *rgavideoconvert, GstRgaJob *job) {
+  /* converted on the CPU */
+  if (!job->submitted) return;
+
+  gst_rga_tracer_log_job(GST_OBJECT(rgavideoconvert),
+                         job->core | job->tile_core, job->start,
+                         job->submitted, MAX(job->done, job->submitted));
+}
+
+/* Accounts a frame RGA finished and posts the stats when they are due */
+static void gst_rga_video_convert_add_frame(
+    GstRgaVideoConvert *rgavideoconvert, GstRgaJob *job) {
+  GST_OBJECT_LOCK(rgavideoconvert);
+  guint interval = rgavideoconvert->stats_interval;
+  GST_OBJECT_UNLOCK(rgavideoconvert);
+
+  /* a frame converted on the CPU in sync mode was never waited for */
+  GstClockTime done = job->done ? job->done : gst_util_get_timestamp();
+  gst_rga_stats_add_frame(&rgavideoconvert->stats, done - job->start,
+                          job->bytes);
+  gst_rga_stats_post(&rgavideoconvert->stats, GST_ELEMENT(rgavideoconvert),
+                     interval * GST_MSECOND);
+}
+
+static gpointer gst_rga_video_convert_push_loop(gpointer data) {
+  GstRgaVideoConvert *rgavideoconvert = gst_rga_video_convert(data);
+  GstPad *srcpad = GST_BASE_TRANSFORM_SRC_PAD(rgavideoconvert);
+
+  g_mutex_lock(&rgavideoconvert->lock);
+  while (TRUE) {
+    while (!rgavideoconvert->stopping &&
+           g_queue_is_empty(&rgavideoconvert->jobs))
+      g_cond_wait(&rgavideoconvert->cond, &rgavideoconvert->lock);
+
+    /* finish the queued jobs before leaving */
+    GstRgaJob *job = g_queue_peek_head(&rgavideoconvert->jobs);
+    if (!job) break;
+    g_mutex_unlock(&rgavideoconvert->lock);
+
+    GstFlowReturn ret;
+    gboolean done = gst_rga_job_wait(job);
+
+    if (done) gst_rga_video_convert_trace_job(rgavideoconvert, job);
+    gst_rga_scheduler_release(rgavideoconvert->scheduler, job->core);
+    gst_rga_scheduler_release(rgavideoconvert->scheduler, job->tile_core);
+    if (done) {
+      GstBuffer *outbuf = job->outbuf;
+
+      job->outbuf = NULL;
+      gst_rga_job_clear(job);
+      /* an in-place output stays writable for downstream */
+      gst_clear_buffer(&job->inbuf);
+      gst_rga_video_convert_add_frame(rgavideoconvert, job);
+      ret = gst_pad_push(srcpad, outbuf);
+    } else {
+      GST_WARNING_OBJECT(rgavideoconvert, "RGA job did not complete");
+      gst_rga_stats_add_failure(&rgavideoconvert->stats);
+      ret = GST_FLOW_ERROR;
+    }
+
+    g_mutex_lock(&rgavideoconvert->lock);
+    g_queue_pop_head(&rgavideoconvert->jobs);
+    rgavideoconvert->push_ret = ret;
+    g_cond_broadcast(&rgavideoconvert->cond);
+    gst_rga_job_free(job);
+  }
+  g_mutex_unlock(&rgavideoconvert->lock);
+  return NULL;
+}
+
+/* Blocks until a job slot is free, returns the last downstream flow */
+static GstFlowReturn gst_rga_video_convert_wait_slot(
+    GstRgaVideoConvert *rgavideoconvert) {
+  GstFlowReturn ret;
+
+  g_mutex_lock(&rgavideoconvert->lock);
+  while (!rgavideoconvert->flushing &&
+         rgavideoconvert->push_ret == GST_FLOW_OK &&
+         g_queue_get_length(&rgavideoconvert->jobs) >=
+             rgavideoconvert->max_jobs)
+    g_cond_wait(&rgavideoconvert->cond, &rgavideoconvert->lock);
+  ret = rgavideoconvert->flushing ? GST_FLOW_FLUSHING
+                                  : rgavideoconvert->push_ret;
+  g_mutex_unlock(&rgavideoconvert->lock);
+  return ret;
+}
+
+static void gst_rga_video_convert_queue_job(
+    GstRgaVideoConvert *rgavideoconvert, GstRgaJob *job) {
+  g_mutex_lock(&rgavideoconvert->lock);
+  g_queue_push_tail(&rgavideoconvert->jobs, job);
+  g_cond_broadcast(&rgavideoconvert->cond);
+  g_mutex_unlock(&rgavideoconvert->lock);
+}
+
+/* Waits until every queued job has been pushed downstream */
+static void gst_rga_video_convert_drain(GstRgaVideoConvert *rgavideoconvert) {
+  g_mutex_lock(&rgavideoconvert->lock);
+  while (!g_queue_is_empty(&rgavideoconvert->jobs))
+    g_cond_wait(&rgavideoconvert->cond, &rgavideoconvert->lock);
+  g_mutex_unlock(&rgavideoconvert->lock);
+}
+
+static void gst_rga_video_convert_set_flushing(
+    GstRgaVideoConvert *rgavideoconvert, gboolean flushing) {
+  g_mutex_lock(&rgavideoconvert->lock);
+  rgavideoconvert->flushing = flushing;
+  if (!flushing) rgavideoconvert->push_ret = GST_FLOW_OK;
+  g_cond_broadcast(&rgavideoconvert->cond);
+  g_mutex_unlock(&rgavideoconvert->lock);
+}
+
+/* Maps an image-orientation tag to the method that undoes it, the same
+ * way videoflip does */
+static gboolean gst_rga_orientation_from_tag(
+    GstTagList *taglist, GstVideoOrientationMethod *method) {
+  static const struct {
+    const gchar *tag;
+    GstVideoOrientationMethod method;
+  } orientations[] = {
+      {"rotate-0", GST_VIDEO_ORIENTATION_IDENTITY},
+      {"rotate-90", GST_VIDEO_ORIENTATION_90R},
+      {"rotate-180", GST_VIDEO_ORIENTATION_180},
+      {"rotate-270", GST_VIDEO_ORIENTATION_90L},
+      {"flip-rotate-0", GST_VIDEO_ORIENTATION_HORIZ},
+      {"flip-rotate-90", GST_VIDEO_ORIENTATION_UL_LR},
+      {"flip-rotate-180", GST_VIDEO_ORIENTATION_VERT},
+      {"flip-rotate-270", GST_VIDEO_ORIENTATION_UR_LL},
+  };
+  gchar *orientation;
+  gboolean ret = FALSE;
+
+  if (!gst_tag_list_get_string(taglist, GST_TAG_IMAGE_ORIENTATION,
+                               &orientation))
+    return FALSE;
+
+  for (guint i = 0; i < G_N_ELEMENTS(orientations); i++) {
+    if (g_str_equal(orientation, orientations[i].tag)) {
+      *method = orientations[i].method;
+      ret = TRUE;
+      break;
+    }
+  }
+  g_free(orientation);
+  return ret;
+}
+
+/* Forgets the decimation phase and the downstream lateness */
+static void gst_rga_video_convert_reset_qos(
+    GstRgaVideoConvert *rgavideoconvert) {
+  rgavideoconvert->next_ts = GST_CLOCK_TIME_NONE;
+  GST_OBJECT_LOCK(rgavideoconvert);
+  rgavideoconvert->qos_proportion = 1.0;
+  GST_OBJECT_UNLOCK(rgavideoconvert);
+}
+
+static gboolean gst_rga_video_convert_sink_event(GstBaseTransform *trans,
+                                                 GstEvent *event) {
+  GstRgaVideoConvert *rgavideoconvert = gst_rga_video_convert(trans);
+
+  if (GST_EVENT_TYPE(event) == GST_EVENT_TAG) {
+    GstTagList *taglist;
+    GstVideoOrientationMethod method;
+
+    gst_event_parse_tag(event, &taglist);
+    if (gst_rga_orientation_from_tag(taglist, &method)) {
+      GST_OBJECT_LOCK(rgavideoconvert);
+      gboolean changed = rgavideoconvert->tag_method != method &&
+                         rgavideoconvert->method == GST_VIDEO_ORIENTATION_AUTO;
+      rgavideoconvert->tag_method = method;
+      GST_OBJECT_UNLOCK(rgavideoconvert);
+
+      if (changed) gst_rga_video_convert_reconfigure(rgavideoconvert);
+    }
+  }
+
+  if (GST_EVENT_TYPE(event) == GST_EVENT_FLUSH_STOP ||
+      GST_EVENT_TYPE(event) == GST_EVENT_SEGMENT)
+    gst_rga_video_convert_reset_qos(rgavideoconvert);
+
+  if (rgavideoconvert->push_thread) {
+    switch (GST_EVENT_TYPE(event)) {
+      case GST_EVENT_FLUSH_START:
+        gst_rga_video_convert_set_flushing(rgavideoconvert, TRUE);
+        break;
+      case GST_EVENT_FLUSH_STOP:
+        gst_rga_video_convert_drain(rgavideoconvert);
+        gst_rga_video_convert_set_flushing(rgavideoconvert, FALSE);
+        break;
+      default:
+        /* keep serialized events behind the buffers still in flight */
+        if (GST_EVENT_IS_SERIALIZED(event))
+          gst_rga_video_convert_drain(rgavideoconvert);
+        break;
+    }
+  }
+
+  return GST_BASE_TRANSFORM_CLASS(gst_rga_video_convert_parent_class)
+      ->sink_event(trans, event);
+}
+
+/* GstBaseTransform drops the frames already late for downstream, this
+ * keeps the proportion to also shed load while RGA is backed up */
+static gboolean gst_rga_video_convert_src_event(GstBaseTransform *trans,
+                                                GstEvent *event) {
+  GstRgaVideoConvert *rgavideoconvert = gst_rga_video_convert(trans);
+
+  if (GST_EVENT_TYPE(event) == GST_EVENT_QOS) {
+    gdouble proportion;
+
+    gst_event_parse_qos(event, NULL, &proportion, NULL, NULL);
+    GST_OBJECT_LOCK(rgavideoconvert);
+    rgavideoconvert->qos_proportion = proportion;
+    GST_OBJECT_UNLOCK(rgavideoconvert);
+  }
+
+  return GST_BASE_TRANSFORM_CLASS(gst_rga_video_convert_parent_class)
+      ->src_event(trans, event);
+}
+
+/* TRUE if @input is above max-fps, or if downstream is behind and every
+ * job slot of the element or every allowed core is busy */
+static gboolean gst_rga_video_convert_should_drop(
+    GstRgaVideoConvert *rgavideoconvert, GstBuffer *input) {
+  GstClockTime ts = GST_BUFFER_PTS(input);
+
+  GST_OBJECT_LOCK(rgavideoconvert);
+  gint fps_n = rgavideoconvert->max_fps_n;
+  gint fps_d = rgavideoconvert->max_fps_d;
+  gdouble proportion = rgavideoconvert->qos_proportion;
+  GST_OBJECT_UNLOCK(rgavideoconvert);
+
+  if (fps_n > 0 && GST_CLOCK_TIME_IS_VALID(ts)) {
+    GstClockTime interval = gst_util_uint64_scale_int(GST_SECOND, fps_d, fps_n);
+    GstClockTime next = rgavideoconvert->next_ts;
+
+    /* a quarter frame of slack for timestamp jitter */
+    if (GST_CLOCK_TIME_IS_VALID(next) && ts + interval / 4 < next) {
+      GST_LOG_OBJECT(rgavideoconvert,
+                     "above max-fps, dropping %" GST_PTR_FORMAT, input);
+      return TRUE;
+    }
+    /* stay on the grid unless the stream jumped ahead */
+    if (GST_CLOCK_TIME_IS_VALID(next) && ts < next + interval)
+      rgavideoconvert->next_ts = next + interval;
+    else
+      rgavideoconvert->next_ts = ts + interval;
+  }
+
+  if (proportion <= 1.0) return FALSE;
+
+  gboolean busy;
+  if (rgavideoconvert->push_thread) {
+    g_mutex_lock(&rgavideoconvert->lock);
+    busy = g_queue_get_length(&rgavideoconvert->jobs) >=
+           rgavideoconvert->max_jobs;
+    g_mutex_unlock(&rgavideoconvert->lock);
+  } else {
+    busy = rgavideoconvert->scheduler &&
+           gst_rga_scheduler_get_depth(rgavideoconvert->scheduler,
+                                       rgavideoconvert->core_mask) >=
+               rgavideoconvert->max_jobs;
+  }
+  if (busy)
+    GST_LOG_OBJECT(rgavideoconvert,
+                   "RGA backed up and downstream at %.2f, dropping %"
+                   GST_PTR_FORMAT, proportion, input);
+  return busy;
+}
+
+/* Drops frames before an output buffer is even allocated */
+static GstFlowReturn gst_rga_video_convert_submit_input_buffer(
+    GstBaseTransform *trans, gboolean is_discont, GstBuffer *input) {
+  GstRgaVideoConvert *rgavideoconvert = gst_rga_video_convert(trans);
+
+  if (gst_rga_video_convert_should_drop(rgavideoconvert, input)) {
+    gst_rga_stats_add_drop(&rgavideoconvert->stats);
+    gst_buffer_unref(input);
+    return GST_FLOW_OK;
+  }
+
+  return GST_BASE_TRANSFORM_CLASS(gst_rga_video_convert_parent_class)
+      ->submit_input_buffer(trans, is_discont, input);
+}
+
+/* TRUE if @in to @out only reorders the bytes of each pixel in place, so
+ * RGA can write the result over the source */
+static gboolean gst_rga_formats_swap_in_place(GstVideoFormat in,
+                                              GstVideoFormat out) {
+  static const GstVideoFormat groups[][4] = {
+      {GST_VIDEO_FORMAT_RGBA, GST_VIDEO_FORMAT_BGRA, GST_VIDEO_FORMAT_RGBx,
+       GST_VIDEO_FORMAT_BGRx},
+      {GST_VIDEO_FORMAT_RGB, GST_VIDEO_FORMAT_BGR},
+      {GST_VIDEO_FORMAT_NV12, GST_VIDEO_FORMAT_NV21},
+      {GST_VIDEO_FORMAT_NV16, GST_VIDEO_FORMAT_NV61},
+  };
+  gint in_group = -1, out_group = -2;
+
+  for (guint g = 0; g < G_N_ELEMENTS(groups); g++) {
+    for (guint f = 0; f < G_N_ELEMENTS(groups[g]); f++) {
+      if (groups[g][f] == GST_VIDEO_FORMAT_UNKNOWN) continue;
+      if (groups[g][f] == in) in_group = g;
+      if (groups[g][f] == out) out_group = g;
+    }
+  }
+  return in_group == out_group;
+}
+
+/* Whether @inbuf can take its own conversion. RGA writes through the fd,
+ * so the buffer and its memories must not be shared with anyone. */
+static gboolean gst_rga_video_convert_can_convert_in_place(
+    GstRgaVideoConvert *rgavideoconvert, GstBuffer *inbuf) {
+  GST_OBJECT_LOCK(rgavideoconvert);
+  gboolean enabled =
+      rgavideoconvert->in_place && !rgavideoconvert->add_borders;
+  GST_OBJECT_UNLOCK(rgavideoconvert);
+
+  if (!enabled || !rgavideoconvert->in_place_formats ||
+      gst_rga_video_convert_changes_picture(rgavideoconvert) ||
+      gst_buffer_get_video_crop_meta(inbuf) || !gst_buffer_is_writable(inbuf))
+    return FALSE;
+
+  guint n = gst_buffer_n_memory(inbuf);
+  for (guint i = 0; i < n; i++) {
+    GstMemory *mem = gst_buffer_peek_memory(inbuf, i);
+
+    if (!gst_is_dmabuf_memory(mem) || !gst_memory_is_writable(mem))
+      return FALSE;
+  }
+  return n > 0;
+}
+
+/* Hands the input back as output for in-place swaps, which saves a buffer
+ * from the pool and half the memory traffic of the frame */
+static GstFlowReturn gst_rga_video_convert_prepare_output_buffer(
+    GstBaseTransform *trans, GstBuffer *input, GstBuffer **outbuf) {
+  GstRgaVideoConvert *rgavideoconvert = gst_rga_video_convert(trans);
+
+  if (!gst_base_transform_is_passthrough(trans) &&
+      gst_rga_video_convert_can_convert_in_place(rgavideoconvert, input)) {
+    GST_LOG_OBJECT(rgavideoconvert, "converting %" GST_PTR_FORMAT " in place",
+                   input);
+    *outbuf = input;
+    return GST_FLOW_OK;
+  }
+
+  return GST_BASE_TRANSFORM_CLASS(gst_rga_video_convert_parent_class)
+      ->prepare_output_buffer(trans, input, outbuf);
+}
+
+static void gst_rga_video_convert_clear_staging(
+    GstRgaVideoConvert *rgavideoconvert) {
+  if (!rgavideoconvert->staging_pool) return;
+
+  gst_buffer_pool_set_active(rgavideoconvert->staging_pool, FALSE);
+  gst_clear_object(&rgavideoconvert->staging_pool);
+}
+
+static void gst_rga_video_convert_clear_planar(
+    GstRgaVideoConvert *rgavideoconvert) {
+  if (!rgavideoconvert->planar_pool) return;
+
+  gst_buffer_pool_set_active(rgavideoconvert->planar_pool, FALSE);
+  gst_clear_object(&rgavideoconvert->planar_pool);
+}
+
+/* Pool of packed RGB frames RGA writes before they are split into the
+ * planes of @out_info. The CPU reads them, so they come from a cached
+ * heap. */
+static gboolean gst_rga_video_convert_setup_planar(
+    GstRgaVideoConvert *rgavideoconvert, GstVideoFormat packed,
+    const GstVideoInfo *out_info) {
+  GstVideoInfo *info = &rgavideoconvert->planar_info;
+  GstAllocator *allocator = gst_rga_create_allocator(
+      GST_OBJECT(rgavideoconvert), GST_RGA_ALLOCATOR_FALLBACK_HEAP);
+  guint size;
+
+  if (!allocator) return FALSE;
+
+  gst_video_info_set_format(info, packed, GST_VIDEO_INFO_WIDTH(out_info),
+                            GST_VIDEO_INFO_HEIGHT(out_info));
+  GstCaps *caps = gst_video_info_to_caps(info);
+  rgavideoconvert->planar_pool = gst_rga_video_pool_new(
+      GST_OBJECT(rgavideoconvert), allocator, caps, &size, 0, 0, FALSE);
+  gst_caps_unref(caps);
+  gst_object_unref(allocator);
+
+  if (rgavideoconvert->planar_pool &&
+      !gst_buffer_pool_set_active(rgavideoconvert->planar_pool, TRUE))
+    gst_clear_object(&rgavideoconvert->planar_pool);
+  return rgavideoconvert->planar_pool != NULL;
+}
 
 static gboolean gst_rga_video_convert_start(GstBaseTransform *trans) {
   GstRgaVideoConvert *rgavideoconvert = gst_rga_video_convert(trans);
 
   GST_DEBUG_OBJECT(rgavideoconvert, "start");
-  c_RkRgaInit();
-  if (rgavideoconvert->core_mask) {
-    imconfig(IM_CONFIG_SCHEDULER_CORE, rgavideoconvert->core_mask);
+  rgavideoconvert->device = gst_rga_device_ref();
+  rgavideoconvert->scheduler =
+      gst_rga_device_get_scheduler(rgavideoconvert->device);
+  rgavideoconvert->batcher =
+      gst_rga_device_get_batcher(rgavideoconvert->device);
+  gst_rga_stats_reset(&rgavideoconvert->stats);
+  gst_rga_video_convert_reset_qos(rgavideoconvert);
+
+  if (rgavideoconvert->async) {
+    rgavideoconvert->flushing = FALSE;
+    rgavideoconvert->stopping = FALSE;
+    rgavideoconvert->push_ret = GST_FLOW_OK;
+    rgavideoconvert->push_thread = g_thread_new(
+        "rgaconvert-push", gst_rga_video_convert_push_loop, rgavideoconvert);
   }
   return TRUE;
 }
@@ -386,10 +1578,53 @@ static gboolean gst_rga_video_convert_stop(GstBaseTransform *trans) {
   GstRgaVideoConvert *rgavideoconvert = gst_rga_video_convert(trans);
 
   GST_DEBUG_OBJECT(rgavideoconvert, "stop");
-  c_RkRgaDeInit();
+
+  if (rgavideoconvert->push_thread) {
+    g_mutex_lock(&rgavideoconvert->lock);
+    rgavideoconvert->stopping = TRUE;
+    g_cond_broadcast(&rgavideoconvert->cond);
+    g_mutex_unlock(&rgavideoconvert->lock);
+
+    g_thread_join(rgavideoconvert->push_thread);
+    rgavideoconvert->push_thread = NULL;
+  }
+
+  gst_rga_video_convert_clear_staging(rgavideoconvert);
+  gst_rga_video_convert_clear_planar(rgavideoconvert);
+  GstStructure *stats = gst_rga_stats_to_structure(&rgavideoconvert->stats);
+  GST_INFO_OBJECT(rgavideoconvert, "%" GST_PTR_FORMAT, stats);
+  gst_structure_free(stats);
+
+  rgavideoconvert->scheduler = NULL;
+  rgavideoconvert->batcher = NULL;
+  gst_rga_device_unref(rgavideoconvert->device);
+  rgavideoconvert->device = NULL;
   return TRUE;
 }
 
+/* GstVideoFilter parses the caps with gst_video_info_from_caps(), which
+ * knows nothing about DMA_DRM caps, so hand it the plain equivalent */
+static gboolean gst_rga_video_convert_set_caps(GstBaseTransform *trans,
+                                               GstCaps *incaps,
+                                               GstCaps *outcaps) {
+  GstRgaVideoConvert *rgavideoconvert = gst_rga_video_convert(trans);
+  GstCaps *in = gst_rga_caps_to_plain(incaps, &rgavideoconvert->in_modifier);
+  GstCaps *out =
+      gst_rga_caps_to_plain(outcaps, &rgavideoconvert->out_modifier);
+  gboolean ret = FALSE;
+
+  if (in && out)
+    ret = GST_BASE_TRANSFORM_CLASS(gst_rga_video_convert_parent_class)
+              ->set_caps(trans, in, out);
+  else
+    GST_WARNING_OBJECT(trans, "unsupported caps in %" GST_PTR_FORMAT
+                       " out %" GST_PTR_FORMAT, incaps, outcaps);
+
+  if (in) gst_caps_unref(in);
+  if (out) gst_caps_unref(out);
+  return ret;
+}
+
 static gboolean gst_rga_video_convert_set_info(GstVideoFilter *filter,
                                                GstCaps *incaps,
                                                GstVideoInfo *in_info,
@@ -398,84 +1633,848 @@ static gboolean gst_rga_video_convert_set_info(GstVideoFilter *filter,
   GstRgaVideoConvert *rgavideoconvert = gst_rga_video_convert(filter);
   GST_DEBUG_OBJECT(rgavideoconvert, "set_info");
 
+  /* staging buffers follow the caps */
+  gst_rga_video_convert_clear_staging(rgavideoconvert);
+  gst_rga_video_convert_clear_planar(rgavideoconvert);
+
   GstVideoFormat in_format = GST_VIDEO_INFO_FORMAT(in_info);
   GstVideoFormat out_format = GST_VIDEO_INFO_FORMAT(out_info);
+  /* RGA has no planar RGB, it writes packed RGB the CPU splits */
+  GstVideoFormat packed = gst_rga_planar_rgb_packed_format(out_format);
+  GstVideoFormat rga_out_format =
+      packed != GST_VIDEO_FORMAT_UNKNOWN ? packed : out_format;
+
+  if (packed != GST_VIDEO_FORMAT_UNKNOWN &&
+      !gst_rga_video_convert_setup_planar(rgavideoconvert, packed, out_info)) {
+    GST_WARNING_OBJECT(filter, "cannot allocate packed RGB for %s",
+                       gst_video_format_to_string(out_format));
+    return FALSE;
+  }
 
-  if (gst_gst_format_to_rga_format(in_format) == RK_FORMAT_UNKNOWN ||
-      gst_gst_format_to_rga_format(in_format) == RK_FORMAT_UNKNOWN) {
-    GST_INFO_OBJECT(filter, "don't support format. in format=%d,out format=%d",
-                    in_format, out_format);
+  /* everything but the handles is known from the caps */
+  if (!gst_rga_image_template_init(&rgavideoconvert->src_template, in_info,
+                                   rgavideoconvert->in_modifier) ||
+      !gst_rga_image_template_init(
+          &rgavideoconvert->dst_template,
+          rgavideoconvert->planar_pool ? &rgavideoconvert->planar_info
+                                       : out_info,
+          rgavideoconvert->out_modifier)) {
+    GST_INFO_OBJECT(filter, "don't support format. in format=%s,out format=%s",
+                    gst_video_format_to_string(in_format),
+                    gst_video_format_to_string(rga_out_format));
+    gst_rga_video_convert_clear_planar(rgavideoconvert);
     return FALSE;
   }
+
+  GST_OBJECT_LOCK(rgavideoconvert);
+  GstRgaColorSpace space = rgavideoconvert->color_space;
+  GST_OBJECT_UNLOCK(rgavideoconvert);
+
+  /* the YUV side carries the matrix */
+  const GstVideoInfo *yuv_info =
+      GST_VIDEO_INFO_IS_YUV(in_info) ? in_info : out_info;
+  gboolean exact = TRUE;
+  if (space == GST_RGA_COLOR_SPACE_AUTO)
+    space = gst_rga_color_space_from_info(yuv_info, &exact);
+  rgavideoconvert->color_space_mode =
+      gst_rga_color_space_mode(in_format, rga_out_format, space);
+  if (!exact && rgavideoconvert->color_space_mode != IM_COLOR_SPACE_DEFAULT) {
+    /* the class is held by the param spec */
+    GEnumClass *spaces = g_type_class_peek(gst_rga_color_space_get_type());
+    gchar *colorimetry =
+        gst_video_colorimetry_to_string(&yuv_info->colorimetry);
+
+    GST_WARNING_OBJECT(filter, "RGA has no coefficients for %s, using %s",
+                       GST_STR_NULL(colorimetry),
+                       g_enum_get_value(spaces, space)->value_nick);
+    g_free(colorimetry);
+  }
+
+  rgavideoconvert->in_place_formats =
+      GST_VIDEO_INFO_WIDTH(in_info) == GST_VIDEO_INFO_WIDTH(out_info) &&
+      GST_VIDEO_INFO_HEIGHT(in_info) == GST_VIDEO_INFO_HEIGHT(out_info) &&
+      rgavideoconvert->in_modifier == DRM_FORMAT_MOD_LINEAR &&
+      rgavideoconvert->out_modifier == DRM_FORMAT_MOD_LINEAR &&
+      gst_rga_formats_swap_in_place(in_format, out_format);
+
+  if (gst_rga_video_convert_changes_picture(rgavideoconvert))
+    gst_base_transform_set_passthrough(GST_BASE_TRANSFORM(filter), FALSE);
+
+  /* buffers are only taken from it when planes need gathering */
+  GstAllocator *allocator =
+      rgavideoconvert->in_modifier == DRM_FORMAT_MOD_LINEAR
+          ? gst_rga_create_allocator(GST_OBJECT(filter),
+                                     rgavideoconvert->dma_heap)
+          : NULL;
+  if (allocator) {
+    guint size;
+
+    rgavideoconvert->staging_pool = gst_rga_video_pool_new(
+        GST_OBJECT(filter), allocator, incaps, &size, 0, 0, FALSE);
+    if (rgavideoconvert->staging_pool &&
+        !gst_buffer_pool_set_active(rgavideoconvert->staging_pool, TRUE))
+      gst_clear_object(&rgavideoconvert->staging_pool);
+    gst_object_unref(allocator);
+  }
   return TRUE;
 }
 
 /* transform */
-static GstFlowReturn gst_rga_video_convert_transform_frame(
-    GstVideoFilter *filter, GstVideoFrame *inframe, GstVideoFrame *outframe) {
-  GstRgaVideoConvert *rgavideoconvert = gst_rga_video_convert(filter);
 
-  GST_DEBUG_OBJECT(rgavideoconvert, "transform_frame");
 
-  GstMapInfo inMapinfo = {
+/* RGA rotates clockwise first and mirrors the rotated picture */
+static int gst_rga_method_to_usage(GstVideoOrientationMethod method) {
+  switch (method) {
+    case GST_VIDEO_ORIENTATION_90R:
+      return IM_HAL_TRANSFORM_ROT_90;
+    case GST_VIDEO_ORIENTATION_180:
+      return IM_HAL_TRANSFORM_ROT_180;
+    case GST_VIDEO_ORIENTATION_90L:
+      return IM_HAL_TRANSFORM_ROT_270;
+    case GST_VIDEO_ORIENTATION_HORIZ:
+      return IM_HAL_TRANSFORM_FLIP_H;
+    case GST_VIDEO_ORIENTATION_VERT:
+      return IM_HAL_TRANSFORM_FLIP_V;
+    case GST_VIDEO_ORIENTATION_UL_LR:
+      return IM_HAL_TRANSFORM_ROT_90 | IM_HAL_TRANSFORM_FLIP_H;
+    case GST_VIDEO_ORIENTATION_UR_LL:
+      return IM_HAL_TRANSFORM_ROT_90 | IM_HAL_TRANSFORM_FLIP_V;
+    default:
+      return 0;
+  }
+}
+
+/* Narrows the source rect to the GstVideoCropMeta of @frame, then to the
+ * crop-* properties */
+static gboolean gst_rga_video_convert_crop(GstRgaVideoConvert *rgavideoconvert,
+                                           GstVideoFrame *frame,
+                                           im_rect *rect) {
+  GstVideoCropMeta *meta = gst_buffer_get_video_crop_meta(frame->buffer);
+  gint left = 0, top = 0, width = rect->width, height = rect->height;
+
+  if (meta && meta->width && meta->height && meta->x < (guint)width &&
+      meta->y < (guint)height) {
+    left = meta->x;
+    top = meta->y;
+    width = MIN((gint)meta->width, width - left);
+    height = MIN((gint)meta->height, height - top);
+  }
+
+  GST_OBJECT_LOCK(rgavideoconvert);
+  left += rgavideoconvert->crop_left;
+  top += rgavideoconvert->crop_top;
+  width -= rgavideoconvert->crop_left + rgavideoconvert->crop_right;
+  height -= rgavideoconvert->crop_top + rgavideoconvert->crop_bottom;
+  GST_OBJECT_UNLOCK(rgavideoconvert);
+
+  /* subsampled chroma needs an even rect */
+  if (GST_VIDEO_INFO_IS_YUV(&frame->info)) {
+    left &= ~1;
+    top &= ~1;
+    width &= ~1;
+    height &= ~1;
+  }
+
+  if (width < 2 || height < 2) {
+    GST_WARNING_OBJECT(rgavideoconvert, "nothing left after cropping");
+    return FALSE;
+  }
+
+  rect->x += left;
+  rect->y += top;
+  rect->width = width;
+  rect->height = height;
+  return TRUE;
+}
+
+/* Fits @src, rotated when @swap, inside @dst keeping the display aspect
+ * ratio of the negotiated caps, and centers it */
+static void gst_rga_video_convert_letterbox(
+    GstRgaVideoConvert *rgavideoconvert, const im_rect *src, gboolean swap,
+    im_rect *dst) {
+  GstVideoFilter *filter = GST_VIDEO_FILTER(rgavideoconvert);
+  guint64 num = swap ? src->height : src->width;
+  guint64 den = swap ? src->width : src->height;
+  gint in_par_n = GST_VIDEO_INFO_PAR_N(&filter->in_info);
+  gint in_par_d = GST_VIDEO_INFO_PAR_D(&filter->in_info);
+
+  if (swap) {
+    gint tmp = in_par_n;
+    in_par_n = in_par_d;
+    in_par_d = tmp;
+  }
+  /* output width / height that keeps the display aspect ratio */
+  num *= in_par_n * GST_VIDEO_INFO_PAR_D(&filter->out_info);
+  den *= in_par_d * GST_VIDEO_INFO_PAR_N(&filter->out_info);
+
+  gint width = dst->width, height = dst->height;
+  if (gst_util_uint64_scale(width, den, num) <= (guint64)height)
+    height = gst_util_uint64_scale_round(width, den, num);
+  else
+    width = gst_util_uint64_scale_round(height, num, den);
+
+  gint x = (dst->width - width) / 2, y = (dst->height - height) / 2;
+  if (GST_VIDEO_INFO_IS_YUV(&filter->out_info)) {
+    x &= ~1;
+    y &= ~1;
+    width &= ~1;
+    height &= ~1;
+  }
+
+  dst->x += x;
+  dst->y += y;
+  dst->width = MAX(width, 2);
+  dst->height = MAX(height, 2);
+}
+
+/* Paints the parts of @full around @picture with @color, on @core, as one
+ * async job whose release fence goes to @fence */
+static gboolean gst_rga_fill_borders(rga_buffer_t dst, const im_rect *full,
+                                     const im_rect *picture, guint32 color,
+                                     guint32 core, gint *fence) {
+  rga_buffer_t none = {
+      0,
+  };
+  im_rect none_rect = {
       0,
   };
-  GstMapInfo outMapinfo = {
+  im_opt_t opt = {
       0,
   };
+  im_rect borders[2] = {*full, *full};
+
+  if (picture->width < full->width) {
+    borders[0].width = picture->x - full->x;
+    borders[1].x = picture->x + picture->width;
+    borders[1].width = full->x + full->width - borders[1].x;
+  } else {
+    borders[0].height = picture->y - full->y;
+    borders[1].y = picture->y + picture->height;
+    borders[1].height = full->y + full->height - borders[1].y;
+  }
+
+  opt.color = gst_rga_color_from_argb(color);
+  opt.core = core;
+
+  im_job_handle_t job = imbeginJob(0);
+  IM_STATUS status = job ? IM_STATUS_SUCCESS : IM_STATUS_FAILED;
+  for (guint i = 0; i < G_N_ELEMENTS(borders); i++) {
+    const im_rect *border = &borders[i];
+
+    /* a fill is a blit too, keep it within the output limit */
+    for (gint y = 0; y < border->height && status == IM_STATUS_SUCCESS;
+         y += RGA_MAX_DST_SIZE) {
+      for (gint x = 0; x < border->width && status == IM_STATUS_SUCCESS;
+           x += RGA_MAX_DST_SIZE) {
+        im_rect part = {border->x + x, border->y + y,
+                        MIN(border->width - x, RGA_MAX_DST_SIZE),
+                        MIN(border->height - y, RGA_MAX_DST_SIZE)};
+
+        status = improcessTask(job, none, dst, none, none_rect, part,
+                               none_rect, &opt, IM_COLOR_FILL);
+      }
+    }
+  }
+
+  if (job && status == IM_STATUS_SUCCESS)
+    status = imendJob(job, IM_ASYNC, -1, fence);
+  else if (job)
+    imcancelJob(job);
+  if (status != IM_STATUS_SUCCESS) {
+    GST_WARNING("failed to fill borders: %s", imStrError_t(status));
+    return FALSE;
+  }
+  return TRUE;
+}
+
+/* Tells downstream where the picture is, so detections can be mapped back
+ * to input coordinates */
+static void gst_rga_add_letterbox_meta(GstBuffer *outbuf, const im_rect *full,
+                                       const im_rect *src,
+                                       const im_rect *picture,
+                                       gboolean swap) {
+  GstVideoRegionOfInterestMeta *meta =
+      gst_buffer_add_video_region_of_interest_meta(
+          outbuf, "letterbox", picture->x - full->x, picture->y - full->y,
+          picture->width, picture->height);
+
+  gst_video_region_of_interest_meta_add_param(
+      meta,
+      gst_structure_new(
+          "rga/letterbox", "scale-x", G_TYPE_DOUBLE,
+          (gdouble)picture->width / (swap ? src->height : src->width),
+          "scale-y", G_TYPE_DOUBLE,
+          (gdouble)picture->height / (swap ? src->width : src->height),
+          "offset-x", G_TYPE_INT, picture->x - full->x, "offset-y", G_TYPE_INT,
+          picture->y - full->y, "source-x", G_TYPE_INT, src->x, "source-y",
+          G_TYPE_INT, src->y, "source-width", G_TYPE_INT, src->width,
+          "source-height", G_TYPE_INT, src->height, NULL));
+}
+
+/* TRUE when one blit cannot do @src to @dst */
+static gboolean gst_rga_needs_tiles(const im_rect *src, const im_rect *dst) {
+  return src->width > RGA_MAX_SRC_SIZE || src->height > RGA_MAX_SRC_SIZE ||
+         dst->width > RGA_MAX_DST_SIZE || dst->height > RGA_MAX_DST_SIZE;
+}
+
+/* Number of tiles along an output axis of @dst pixels fed from @src */
+static gint gst_rga_tile_count(gint src, gint dst) {
+  gint by_src = (src + RGA_MAX_SRC_SIZE - RGA_TILE_MARGIN - 1) /
+                (RGA_MAX_SRC_SIZE - RGA_TILE_MARGIN);
+  gint by_dst = (dst + RGA_MAX_DST_SIZE - RGA_TILE_MARGIN - 1) /
+                (RGA_MAX_DST_SIZE - RGA_TILE_MARGIN);
+  return MAX(by_src, by_dst);
+}
+
+/* Edge @i of @n tiles over @size, even so the chroma planes stay aligned */
+static gint gst_rga_tile_edge(gint i, gint n, gint size) {
+  return i == n ? size : gst_util_uint64_scale_int(i, size, n) & ~1;
+}
 
-  rga_info_t src_info = {
+/* Maps the output @tile, inside the picture @dst, back to the part of @src
+ * it is made of. RGA rotates clockwise first and mirrors the rotated
+ * picture, so undo the mirroring, then the rotation. */
+static void gst_rga_tile_source(int usage, const im_rect *src,
+                                const im_rect *dst, const im_rect *tile,
+                                im_rect *rect) {
+  gint w = dst->width, h = dst->height;
+  gint u0 = tile->x - dst->x, u1 = u0 + tile->width;
+  gint v0 = tile->y - dst->y, v1 = v0 + tile->height;
+  gint s0, s1, t0, t1, s_size, t_size, tmp;
+
+  if (usage & IM_HAL_TRANSFORM_FLIP_H) {
+    tmp = u0;
+    u0 = w - u1;
+    u1 = w - tmp;
+  }
+  if (usage & IM_HAL_TRANSFORM_FLIP_V) {
+    tmp = v0;
+    v0 = h - v1;
+    v1 = h - tmp;
+  }
+
+  /* s runs along the source width, t along its height */
+  if (usage & IM_HAL_TRANSFORM_ROT_90) {
+    s0 = v0, s1 = v1, s_size = h;
+    t0 = w - u1, t1 = w - u0, t_size = w;
+  } else if (usage & IM_HAL_TRANSFORM_ROT_180) {
+    s0 = w - u1, s1 = w - u0, s_size = w;
+    t0 = h - v1, t1 = h - v0, t_size = h;
+  } else if (usage & IM_HAL_TRANSFORM_ROT_270) {
+    s0 = h - v1, s1 = h - v0, s_size = h;
+    t0 = u0, t1 = u1, t_size = w;
+  } else {
+    s0 = u0, s1 = u1, s_size = w;
+    t0 = v0, t1 = v1, t_size = h;
+  }
+
+  gint x0 = s0 == s_size ? src->width
+                         : gst_util_uint64_scale_int(s0, src->width, s_size);
+  gint x1 = s1 == s_size ? src->width
+                         : gst_util_uint64_scale_int(s1, src->width, s_size);
+  gint y0 = t0 == t_size ? src->height
+                         : gst_util_uint64_scale_int(t0, src->height, t_size);
+  gint y1 = t1 == t_size ? src->height
+                         : gst_util_uint64_scale_int(t1, src->height, t_size);
+
+  /* neighbouring tiles round their shared edge the same way */
+  rect->x = src->x + (x0 & ~1);
+  rect->y = src->y + (y0 & ~1);
+  rect->width = (x1 == src->width ? x1 : x1 & ~1) - (x0 & ~1);
+  rect->height = (y1 == src->height ? y1 : y1 & ~1) - (y0 & ~1);
+}
+
+/* Splits @src to @dst into tiles RGA can process and submits them as up
+ * to two jobs: one on job->core and, when the scheduler has another core
+ * for it, one on job->tile_core. The jobs always run async; in sync mode
+ * their fences are waited for here. */
+static IM_STATUS gst_rga_video_convert_blit_tiled(
+    GstRgaVideoConvert *rgavideoconvert, rga_buffer_t src_info,
+    rga_buffer_t dst_info, const im_rect *src, const im_rect *dst, int usage,
+    guint32 core_mask, gboolean allow_rga2, GstRgaJob *job, gboolean async) {
+  rga_buffer_t none = {
       0,
   };
-  rga_info_t dst_info = {
+  im_rect none_rect = {
       0,
   };
+  im_opt_t opt[2];
+  im_job_handle_t handles[2] = {0, 0};
+  gboolean swap = (usage & (IM_HAL_TRANSFORM_ROT_90 |
+                            IM_HAL_TRANSFORM_ROT_270)) != 0;
+  gint cols =
+      gst_rga_tile_count(swap ? src->height : src->width, dst->width);
+  gint rows =
+      gst_rga_tile_count(swap ? src->width : src->height, dst->height);
+  guint n_jobs = 1;
+
+  job->tile_core = gst_rga_scheduler_acquire(rgavideoconvert->scheduler,
+                                             core_mask, allow_rga2);
+  if (cols * rows > 1 && (job->tile_core != job->core || !job->core)) {
+    n_jobs = 2;
+    gst_rga_stats_add_job(&rgavideoconvert->stats, job->tile_core);
+  } else {
+    gst_rga_scheduler_release(rgavideoconvert->scheduler, job->tile_core);
+    job->tile_core = 0;
+  }
+  memset(opt, 0, sizeof(opt));
+  opt[0].core = job->core;
+  opt[1].core = job->tile_core;
 
-  if (!gst_rga_info_from_video_frame(&src_info, inframe, &inMapinfo,
-                                     GST_MAP_READ))
-    return GST_FLOW_ERROR;
+  GST_LOG_OBJECT(rgavideoconvert, "blitting %dx%d tiles in %u job(s)", cols,
+                 rows, n_jobs);
 
-  if (!gst_rga_info_from_video_frame(&dst_info, outframe, &outMapinfo,
-                                     GST_MAP_WRITE))
-    return GST_FLOW_ERROR;
+  IM_STATUS status = IM_STATUS_SUCCESS;
+  for (guint i = 0; i < n_jobs && status == IM_STATUS_SUCCESS; i++) {
+    handles[i] = imbeginJob(0);
+    if (!handles[i]) status = IM_STATUS_FAILED;
+  }
 
-  gboolean ret = TRUE;
-  src_info.core = dst_info.core = rgavideoconvert->core_mask;
-  if (c_RkRgaBlit(&src_info, &dst_info, NULL) < 0) {
-    GST_WARNING_OBJECT(filter, "failed to blit");
-    ret = FALSE;
+  for (gint r = 0; r < rows && status == IM_STATUS_SUCCESS; r++) {
+    for (gint c = 0; c < cols && status == IM_STATUS_SUCCESS; c++) {
+      gint x0 = gst_rga_tile_edge(c, cols, dst->width);
+      gint y0 = gst_rga_tile_edge(r, rows, dst->height);
+      im_rect tile = {dst->x + x0, dst->y + y0,
+                      gst_rga_tile_edge(c + 1, cols, dst->width) - x0,
+                      gst_rga_tile_edge(r + 1, rows, dst->height) - y0};
+      im_rect src_tile;
+      guint i = (r * cols + c) % n_jobs;
+
+      gst_rga_tile_source(usage, src, dst, &tile, &src_tile);
+      status = improcessTask(handles[i], src_info, dst_info, none, src_tile,
+                             tile, none_rect, &opt[i], usage);
+    }
+  }
+
+  gint fences[2] = {-1, -1};
+  for (guint i = 0; i < n_jobs; i++) {
+    if (!handles[i]) continue;
+    if (status == IM_STATUS_SUCCESS)
+      status = imendJob(handles[i], IM_ASYNC, -1, &fences[i]);
+    else
+      imcancelJob(handles[i]);
+  }
+  job->submitted = gst_util_get_timestamp();
+
+  if (async) {
+    job->fence = fences[0];
+    job->tile_fence = fences[1];
+  } else {
+    gboolean done = gst_rga_fence_wait(&fences[0], &job->done);
+
+    if (!gst_rga_fence_wait(&fences[1], &job->done) || !done) {
+      GST_WARNING_OBJECT(rgavideoconvert, "RGA job did not complete");
+      if (status == IM_STATUS_SUCCESS) status = IM_STATUS_FAILED;
+    }
+    if (status == IM_STATUS_SUCCESS)
+      gst_rga_video_convert_trace_job(rgavideoconvert, job);
+  }
+
+  if (!async || status != IM_STATUS_SUCCESS) {
+    gst_rga_scheduler_release(rgavideoconvert->scheduler, job->tile_core);
+    job->tile_core = 0;
+  }
+  return status;
+}
+
+/* Counts a frame once when its input, output or both go through a CPU
+ * mapping */
+static void gst_rga_video_convert_count_fallback(
+    GstRgaVideoConvert *rgavideoconvert, GstVideoFrame *inframe,
+    GstVideoFrame *outframe, GstRgaJob *job) {
+  if (!job->in_map.memory && !job->out_map.memory) return;
+
+  guint64 fallbacks = gst_rga_stats_add_fallback(&rgavideoconvert->stats);
+  GstBuffer *buffer = job->in_map.memory ? inframe->buffer : outframe->buffer;
+
+  if (fallbacks == 1) {
+    GST_WARNING_OBJECT(rgavideoconvert,
+                       "%s buffer %" GST_PTR_FORMAT
+                       " cannot be imported by fd, RGA will use a CPU "
+                       "mapping (%u memories)",
+                       job->in_map.memory ? "input" : "output", buffer,
+                       gst_buffer_n_memory(buffer));
+  } else {
+    GST_LOG_OBJECT(rgavideoconvert,
+                   "CPU mapping fallback #%" G_GUINT64_FORMAT, fallbacks);
+  }
+}
+
+/* Describes both frames and submits the blit, sync or async */
+static gboolean gst_rga_video_convert_submit(
+    GstRgaVideoConvert *rgavideoconvert, GstVideoFrame *inframe,
+    GstVideoFrame *outframe, GstRgaJob *job, gboolean async) {
+  rga_buffer_t src_info = {
+      0,
+  };
+  rga_buffer_t dst_info = {
+      0,
+  };
+  rga_buffer_t pat_info = {
+      0,
+  };
+  im_rect src_rect, dst_rect;
+  im_rect pat_rect = {
+      0,
+  };
+  im_opt_t opt = {
+      0,
+  };
+
+  if (!gst_rga_info_from_template(
+          GST_OBJECT(rgavideoconvert), &rgavideoconvert->src_template,
+          &src_info, &src_rect, inframe, &job->in_map, GST_MAP_READ,
+          rgavideoconvert->staging_pool, &job->staging))
+    return FALSE;
+
+  if (!gst_rga_video_convert_crop(rgavideoconvert, inframe, &src_rect))
+    return FALSE;
+
+  if (!gst_rga_info_from_template(
+          GST_OBJECT(rgavideoconvert), &rgavideoconvert->dst_template,
+          &dst_info, &dst_rect, outframe, &job->out_map, GST_MAP_WRITE, NULL,
+          NULL))
+    return FALSE;
+  gst_rga_video_convert_count_fallback(rgavideoconvert, inframe, outframe,
+                                       job);
+
+  /* only RGA3 handles AFBC */
+  guint32 core_mask = rgavideoconvert->core_mask;
+  if (src_info.rd_mode == IM_FBC_MODE || dst_info.rd_mode == IM_FBC_MODE) {
+    const guint32 rga3 = IM_SCHEDULER_RGA3_CORE0 | IM_SCHEDULER_RGA3_CORE1;
+
+    core_mask = (core_mask ? core_mask : rga3) & rga3;
+    if (!core_mask) {
+      GST_WARNING_OBJECT(rgavideoconvert,
+                         "AFBC needs RGA3 but core-mask excludes it");
+      return FALSE;
+    }
+  }
+
+  /* RGA2 only reaches the low 4 GB, keep other buffers on RGA3 */
+  gboolean allow_rga2 =
+      !gst_rga_scheduler_has_high_memory(rgavideoconvert->scheduler) ||
+      (gst_rga_buffer_is_dma32(inframe->buffer) &&
+       gst_rga_buffer_is_dma32(outframe->buffer));
+
+  GST_OBJECT_LOCK(rgavideoconvert);
+  GstVideoOrientationMethod method =
+      gst_rga_video_convert_method_unlocked(rgavideoconvert);
+  gboolean add_borders = rgavideoconvert->add_borders;
+  guint32 fill_color = rgavideoconvert->fill_color;
+  guint batch_window = rgavideoconvert->batch_window;
+  GST_OBJECT_UNLOCK(rgavideoconvert);
+
+  int usage = gst_rga_method_to_usage(method);
+
+  /* the core is chosen per job, imconfig() would affect the whole process */
+  job->core = gst_rga_scheduler_acquire(rgavideoconvert->scheduler, core_mask,
+                                        allow_rga2);
+  opt.core = job->core;
+  gst_rga_stats_add_job(&rgavideoconvert->stats, job->core);
+
+  IM_STATUS status = IM_STATUS_SUCCESS;
+  gint fill_fence = -1;
+  if (add_borders) {
+    gboolean swap = gst_rga_method_swaps_size(method);
+    im_rect full = dst_rect;
+
+    gst_rga_video_convert_letterbox(rgavideoconvert, &src_rect, swap,
+                                    &dst_rect);
+    if (!gst_rga_fill_borders(dst_info, &full, &dst_rect, fill_color,
+                              job->core, &fill_fence))
+      status = IM_STATUS_FAILED;
+    else
+      gst_rga_add_letterbox_meta(job->outbuf, &full, &src_rect,
+                                 &dst_rect, swap);
+  }
+
+  /* set after the fill, which has no source to convert */
+  dst_info.color_space_mode = rgavideoconvert->color_space_mode;
+
+  if (status == IM_STATUS_SUCCESS &&
+      gst_rga_needs_tiles(&src_rect, &dst_rect)) {
+    status = gst_rga_video_convert_blit_tiled(
+        rgavideoconvert, src_info, dst_info, &src_rect, &dst_rect,
+        usage, core_mask, allow_rga2, job, async);
+  } else if (status == IM_STATUS_SUCCESS && batch_window) {
+    guint batch_size;
+
+    status = gst_rga_batcher_submit(
+        rgavideoconvert->batcher, batch_window * GST_USECOND, &src_info,
+        &dst_info, &src_rect, &dst_rect, &opt, usage, &job->fence,
+        &batch_size);
+    job->submitted = gst_util_get_timestamp();
+    if (status == IM_STATUS_SUCCESS)
+      gst_rga_stats_add_batch(&rgavideoconvert->stats, batch_size);
+    /* the batch always runs async, a sync blit waits for it here */
+    if (!async && status == IM_STATUS_SUCCESS) {
+      if (gst_rga_fence_wait(&job->fence, &job->done))
+        gst_rga_video_convert_trace_job(rgavideoconvert, job);
+      else
+        status = IM_STATUS_FAILED;
+    }
+  } else if (status == IM_STATUS_SUCCESS) {
+    /* always async, so the tracer tells the ioctl from the hardware time;
+     * a sync blit waits for it here like a batch does */
+    status = improcess(src_info, dst_info, pat_info, src_rect, dst_rect,
+                       pat_rect, -1, &job->fence, &opt, usage | IM_ASYNC);
+    job->submitted = gst_util_get_timestamp();
+    if (!async && status == IM_STATUS_SUCCESS) {
+      if (gst_rga_fence_wait(&job->fence, &job->done))
+        gst_rga_video_convert_trace_job(rgavideoconvert, job);
+      else
+        status = IM_STATUS_FAILED;
+    }
+  }
+
+  /* the fill runs next to the blit, an async job waits for both */
+  if (async && status == IM_STATUS_SUCCESS)
+    gst_rga_fence_merge(&job->fence, fill_fence);
+  else if (!gst_rga_fence_wait(&fill_fence, &job->done))
+    status = IM_STATUS_FAILED;
+
+  if (!async || status != IM_STATUS_SUCCESS) {
+    gst_rga_scheduler_release(rgavideoconvert->scheduler, job->core);
+    job->core = 0;
+  }
+
+  if (status != IM_STATUS_SUCCESS) {
+    GST_WARNING_OBJECT(rgavideoconvert, "failed to blit: %s",
+                       imStrError_t(status));
+    gst_rga_stats_add_failure(&rgavideoconvert->stats);
+    return FALSE;
+  }
+  return TRUE;
+}
+
+/* Converts on the CPU what RGA could not take. Only NV12 inputs without
+ * rotation, borders or AFBC are handled, FALSE for anything else. */
+static gboolean gst_rga_video_convert_software(
+    GstRgaVideoConvert *rgavideoconvert, GstVideoFrame *inframe,
+    GstVideoFrame *outframe) {
+  GstVideoFrame in_map, out_map;
+
+  GST_OBJECT_LOCK(rgavideoconvert);
+  gboolean supported =
+      gst_rga_video_convert_method_unlocked(rgavideoconvert) ==
+          GST_VIDEO_ORIENTATION_IDENTITY &&
+      !rgavideoconvert->add_borders;
+  GST_OBJECT_UNLOCK(rgavideoconvert);
+
+  /* the CPU kernels only have the BT.601 limited range coefficients */
+  if (rgavideoconvert->color_space_mode != IM_COLOR_SPACE_DEFAULT &&
+      rgavideoconvert->color_space_mode != IM_YUV_TO_RGB_BT601_LIMIT)
+    supported = FALSE;
+
+  if (!supported || rgavideoconvert->in_modifier != DRM_FORMAT_MOD_LINEAR ||
+      rgavideoconvert->out_modifier != DRM_FORMAT_MOD_LINEAR ||
+      !gst_rga_software_supports(GST_VIDEO_FRAME_FORMAT(inframe),
+                                 GST_VIDEO_FRAME_FORMAT(outframe)))
+    return FALSE;
+
+  if (!gst_video_frame_map(&in_map, &inframe->info, inframe->buffer,
+                           GST_MAP_READ))
+    return FALSE;
+  if (!gst_video_frame_map(&out_map, &outframe->info, outframe->buffer,
+                           GST_MAP_WRITE)) {
+    gst_video_frame_unmap(&in_map);
+    return FALSE;
+  }
+
+  im_rect rect = {0, 0, GST_VIDEO_FRAME_WIDTH(&in_map),
+                  GST_VIDEO_FRAME_HEIGHT(&in_map)};
+  gboolean ret = gst_rga_video_convert_crop(rgavideoconvert, &in_map, &rect);
+  if (ret) {
+    GstVideoRectangle src = {rect.x, rect.y, rect.width, rect.height};
+
+    ret = gst_rga_software_convert(&in_map, &src, &out_map);
+  }
+  gst_video_frame_unmap(&out_map);
+  gst_video_frame_unmap(&in_map);
+
+  if (ret) gst_rga_stats_add_software(&rgavideoconvert->stats);
+  return ret;
+}
+
+/* Submits the blit to RGA, or converts on the CPU when RGA rejects it or
+ * every allowed core already has overflow-jobs in flight. A job done on the
+ * CPU has no fence, so the push thread sends it out right away. */
+static gboolean gst_rga_video_convert_process(
+    GstRgaVideoConvert *rgavideoconvert, GstVideoFrame *inframe,
+    GstVideoFrame *outframe, GstRgaJob *job, gboolean async) {
+  GST_OBJECT_LOCK(rgavideoconvert);
+  gboolean software = rgavideoconvert->software_fallback;
+  guint overflow = rgavideoconvert->overflow_jobs;
+  GST_OBJECT_UNLOCK(rgavideoconvert);
+
+  job->start = gst_util_get_timestamp();
+
+  if (software && overflow &&
+      gst_rga_scheduler_get_depth(rgavideoconvert->scheduler,
+                                  rgavideoconvert->core_mask) >= overflow) {
+    GST_LOG_OBJECT(rgavideoconvert, "RGA is saturated, trying the CPU");
+    if (gst_rga_video_convert_software(rgavideoconvert, inframe, outframe))
+      return TRUE;
   }
 
-  gst_buffer_unmap(inframe->buffer, &inMapinfo);
-  gst_buffer_unmap(outframe->buffer, &outMapinfo);
+  if (gst_rga_video_convert_submit(rgavideoconvert, inframe, outframe, job,
+                                   async))
+    return TRUE;
+  if (!software) return FALSE;
+
+  /* a failed tiled blit may have left one half running */
+  gst_rga_job_wait(job);
+  gst_rga_job_clear(job);
+  job->submitted = job->done = 0;
+
+  if (!gst_rga_video_convert_software(rgavideoconvert, inframe, outframe))
+    return FALSE;
+  GST_LOG_OBJECT(rgavideoconvert, "converted a rejected frame on the CPU");
+  return TRUE;
+}
+
+/* Describes an RGB output for an NPU, other formats get no meta */
+static void gst_rga_video_convert_add_tensor_meta(
+    GstRgaVideoConvert *rgavideoconvert, GstBuffer *outbuf,
+    const GstVideoInfo *info) {
+  gdouble mean[3], scale[3];
+
+  GST_OBJECT_LOCK(rgavideoconvert);
+  memcpy(mean, rgavideoconvert->tensor_mean, sizeof(mean));
+  memcpy(scale, rgavideoconvert->tensor_scale, sizeof(scale));
+  GST_OBJECT_UNLOCK(rgavideoconvert);
 
-  if (!ret) {
+  gst_buffer_add_rga_tensor_meta(outbuf, info, mean, scale);
+}
+
+/* RGA writes packed RGB to a staging buffer that the CPU splits into the
+ * planes of @outbuf, so this is always synchronous */
+static GstFlowReturn gst_rga_video_convert_transform_planar(
+    GstRgaVideoConvert *rgavideoconvert, GstVideoFrame *inframe,
+    GstBuffer *outbuf, guint64 bytes) {
+  GstVideoFilter *filter = GST_VIDEO_FILTER(rgavideoconvert);
+  GstVideoFrame packed_frame, packed_map, out_map;
+  GstBuffer *packed = NULL;
+  GstRgaJob job = {
+      inframe->buffer,
+      outbuf,
+  };
+  job.fence = job.tile_fence = -1;
+  job.bytes = bytes;
+
+  if (gst_buffer_pool_acquire_buffer(rgavideoconvert->planar_pool, &packed,
+                                     NULL) != GST_FLOW_OK)
     return GST_FLOW_ERROR;
+
+  gboolean ret =
+      gst_rga_video_frame_init(GST_OBJECT(rgavideoconvert), &packed_frame,
+                               &rgavideoconvert->planar_info, packed,
+                               DRM_FORMAT_MOD_LINEAR) &&
+      gst_rga_video_convert_process(rgavideoconvert, inframe, &packed_frame,
+                                    &job, FALSE);
+  gst_rga_job_clear(&job);
+
+  if (ret && gst_video_frame_map(&packed_map, &rgavideoconvert->planar_info,
+                                 packed, GST_MAP_READ)) {
+    if (gst_video_frame_map(&out_map, &filter->out_info, outbuf,
+                            GST_MAP_WRITE)) {
+      gst_rga_deinterleave_rgb(&packed_map, &out_map);
+      gst_rga_video_convert_add_tensor_meta(rgavideoconvert, outbuf,
+                                            &out_map.info);
+      gst_video_frame_unmap(&out_map);
+    } else {
+      ret = FALSE;
+    }
+    gst_video_frame_unmap(&packed_map);
+  } else {
+    ret = FALSE;
   }
+  gst_buffer_unref(packed);
 
+  if (!ret) return GST_FLOW_ERROR;
+  gst_rga_video_convert_add_frame(rgavideoconvert, &job);
   return GST_FLOW_OK;
 }
 
-static gboolean plugin_init(GstPlugin *plugin) {
-  /* FIXME Remember to set the rank if it's an element that is meant
-   to be autoplugged by decodebin. */
-  return gst_element_register(plugin, "rgavideoconvert", GST_RANK_PRIMARY,
-                              GST_TYPE_RGA_VIDEO_CONVERT);
-}
+static GstFlowReturn gst_rga_video_convert_transform(GstBaseTransform *trans,
+                                                     GstBuffer *inbuf,
+                                                     GstBuffer *outbuf) {
+  GstRgaVideoConvert *rgavideoconvert = gst_rga_video_convert(trans);
+  GstVideoFilter *filter = GST_VIDEO_FILTER(trans);
+  GstVideoFrame inframe, outframe;
 
-#ifndef VERSION
-#define VERSION "1.0.0"
-#endif
-#ifndef PACKAGE
-#define PACKAGE "gstreamer-rga"
-#endif
-#ifndef PACKAGE_NAME
-#define PACKAGE_NAME "gstreamer-rga"
-#endif
-#ifndef GST_PACKAGE_ORIGIN
-#define GST_PACKAGE_ORIGIN "https://github.com/corenel/gstreamer-rga.git"
-#endif
+  GST_DEBUG_OBJECT(rgavideoconvert, "transform");
 
-GST_PLUGIN_DEFINE(GST_VERSION_MAJOR, GST_VERSION_MINOR, rgavideoconvert,
-                  "video Colorspace conversion & scaler", plugin_init, VERSION,
-                  "MIT/X11", PACKAGE_NAME, GST_PACKAGE_ORIGIN)
+  if (!filter->negotiated) {
+    GST_ELEMENT_ERROR(rgavideoconvert, CORE, NOT_IMPLEMENTED, (NULL),
+                      ("unknown format"));
+    return GST_FLOW_NOT_NEGOTIATED;
+  }
+
+  if (!gst_rga_video_frame_init(GST_OBJECT(trans), &inframe, &filter->in_info,
+                                inbuf, rgavideoconvert->in_modifier) ||
+      (inbuf != outbuf &&
+       !gst_rga_video_frame_init(GST_OBJECT(trans), &outframe,
+                                 &filter->out_info, outbuf,
+                                 rgavideoconvert->out_modifier))) {
+    GST_ELEMENT_ERROR(rgavideoconvert, STREAM, FORMAT, (NULL),
+                      ("invalid video buffer received"));
+    return GST_FLOW_ERROR;
+  }
+
+  /* in place: the layout of the input with the output format, which has
+   * the same planes and pixel size */
+  if (inbuf == outbuf) {
+    GstVideoMeta *meta = gst_buffer_get_video_meta(outbuf);
+
+    outframe = inframe;
+    outframe.info.finfo = filter->out_info.finfo;
+    if (meta) meta->format = GST_VIDEO_INFO_FORMAT(&filter->out_info);
+  }
+
+  /* read from the input and written to the output */
+  guint64 bytes = GST_VIDEO_INFO_SIZE(&filter->in_info) +
+                  GST_VIDEO_INFO_SIZE(&filter->out_info);
+
+  if (rgavideoconvert->planar_pool)
+    return gst_rga_video_convert_transform_planar(rgavideoconvert, &inframe,
+                                                  outbuf, bytes);
+  gst_rga_video_convert_add_tensor_meta(rgavideoconvert, outbuf,
+                                        &outframe.info);
+
+  if (!rgavideoconvert->push_thread) {
+    GstRgaJob job = {
+        inbuf,
+        outbuf,
+    };
+    job.fence = job.tile_fence = -1;
+    job.bytes = bytes;
+
+    gboolean ret = gst_rga_video_convert_process(rgavideoconvert, &inframe,
+                                                 &outframe, &job, FALSE);
+    gst_rga_job_clear(&job);
+    if (ret) gst_rga_video_convert_add_frame(rgavideoconvert, &job);
+
+    return ret ? GST_FLOW_OK : GST_FLOW_ERROR;
+  }
+
+  GstFlowReturn ret = gst_rga_video_convert_wait_slot(rgavideoconvert);
+  if (ret != GST_FLOW_OK) return ret;
+
+  GstRgaJob *job = g_new0(GstRgaJob, 1);
+  job->inbuf = gst_buffer_ref(inbuf);
+  job->outbuf = gst_buffer_ref(outbuf);
+  job->fence = job->tile_fence = -1;
+  job->bytes = bytes;
+
+  if (!gst_rga_video_convert_process(rgavideoconvert, &inframe, &outframe,
+                                     job, TRUE)) {
+    gst_rga_job_free(job);
+    return GST_FLOW_ERROR;
+  }
+
+  /* the push thread sends outbuf downstream once the fence signals */
+  gst_rga_video_convert_queue_job(rgavideoconvert, job);
+  return GST_BASE_TRANSFORM_FLOW_DROPPED;
+}
@@ -23,6 +23,10 @@
 #include <gst/video/gstvideofilter.h>
 #include <gst/video/video.h>
 
+#include "gstrgadevice.h"  // NOLINT
+#include "gstrgastats.h"   // NOLINT
+#include "gstrgautils.h"   // NOLINT
+
 G_BEGIN_DECLS
 
 #define GST_TYPE_RGA_VIDEO_CONVERT (gst_rga_video_convert_get_type())
@@ -43,6 +47,74 @@ typedef struct _GstRgaVideoConvertClass GstRgaVideoConvertClass;
 struct _GstRgaVideoConvert {
   GstVideoFilter base_rgavideoconvert;
   guint32 core_mask;
+  gchar *dma_heap;
+  gboolean async;
+  guint max_jobs;
+  /* output pool, see GstRgaPoolParams, idle_timeout is in milliseconds */
+  guint min_buffers;
+  guint max_buffers;
+  gboolean lazy_allocation;
+  guint idle_timeout;
+  /* allocate from a dma32 heap when jobs can only run on RGA2 */
+  gboolean auto_dma32;
+  /* protected by the object lock */
+  guint crop_left;
+  guint crop_right;
+  guint crop_top;
+  guint crop_bottom;
+  gboolean add_borders;
+  guint32 fill_color;
+  GstVideoOrientationMethod method;
+  GstVideoOrientationMethod tag_method;
+  guint stats_interval;
+  gdouble tensor_mean[3];
+  gdouble tensor_scale[3];
+  gboolean software_fallback;
+  guint overflow_jobs;
+  gint max_fps_n;
+  gint max_fps_d;
+  gboolean in_place;
+  GstRgaColorSpace color_space;
+  /* in microseconds, 0 submits every blit on its own */
+  guint batch_window;
+  /* of the last QoS event */
+  gdouble qos_proportion;
+
+  /* streaming thread only */
+  GstClockTime next_ts;
+
+  GstRgaDevice *device;
+  /* owned by device */
+  GstRgaScheduler *scheduler;
+  GstRgaBatcher *batcher;
+
+  /* DRM modifiers of the negotiated caps */
+  guint64 in_modifier;
+  guint64 out_modifier;
+  /* RGA images of the negotiated caps, streaming thread only */
+  GstRgaImageTemplate src_template;
+  GstRgaImageTemplate dst_template;
+  /* same size channel swap, see the in-place property */
+  gboolean in_place_formats;
+  /* IM_COLOR_SPACE_MODE of the blits */
+  int color_space_mode;
+
+  /* gathers input planes living in different dmabufs */
+  GstBufferPool *staging_pool;
+  /* packed RGB written by RGA for a planar RGB output */
+  GstBufferPool *planar_pool;
+  GstVideoInfo planar_info;
+  /* frames, latencies and CPU mapping fallbacks, has its own lock */
+  GstRgaStats stats;
+
+  /* async mode, protected by lock */
+  GMutex lock;
+  GCond cond;
+  GQueue jobs;
+  GThread *push_thread;
+  gboolean flushing;
+  gboolean stopping;
+  GstFlowReturn push_ret;
 };
 
 struct _GstRgaVideoConvertClass {